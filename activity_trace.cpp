@@ -0,0 +1,179 @@
+// $Id$
+
+/*activity_trace.cpp
+ *
+ *per-router activity counts written out at fixed intervals
+ *
+ */
+
+#include "booksim.hpp"
+#include <cstring>
+#include <limits>
+
+#include "activity_trace.hpp"
+#include "network.hpp"
+#include "iq_router.hpp"
+#include "power_module.hpp"
+#include "asyncConfig.hpp"
+
+static char const _magic[8] = {'B', 'K', 'S', 'M', 'A', 'C', 'T', '1'};
+static unsigned int const _version = 1;
+
+static void _PutU32(ostream &os, unsigned int v)
+{
+  unsigned char p[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+  os.write((char const *)p, 4);
+}
+
+static void _PutU64(ostream &os, unsigned long long int v)
+{
+  unsigned char p[8];
+  for (int i = 0; i < 8; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+  os.write((char const *)p, 8);
+}
+
+static void _PutF64(ostream &os, double v)
+{
+  unsigned long long int u;
+  memcpy(&u, &v, sizeof(u));
+  _PutU64(os, u);
+}
+
+ActivityTrace::ActivityTrace(string const &filename, long long int interval,
+                             vector<Network *> const &net, Configuration const &config)
+    : _net(net), _interval(interval), _ticks(0), _time(0)
+{
+  if ((interval <= 0) || (interval > (long long int)numeric_limits<unsigned int>::max()))
+  {
+    cerr << "activity_interval must lie between 1 and 2^32-1 ticks" << endl;
+    exit(-1);
+  }
+  _out.open(filename.c_str(), ios::binary);
+  if (!_out)
+  {
+    cerr << "Unable to open activity trace " << filename << endl;
+    exit(-1);
+  }
+
+  // Power_Module sets the Orion supply voltage from the tech file, while the
+  // Orion report at the end of the run expects the configured one
+  double const orion_vdd = PARM_Vdd;
+  vector<routerPower> power;
+  for (size_t s = 0; s < _net.size(); ++s)
+  {
+    Power_Module pm(_net[s], config);
+    vector<Router *> const &routers = _net[s]->GetRouters();
+    for (size_t r = 0; r < routers.size(); ++r)
+    {
+      // other router types keep no monitors and show up without activity
+      IQRouter *router = dynamic_cast<IQRouter *>(routers[r]);
+      routerPower p;
+      memset(&p, 0, sizeof(p));
+      if (router)
+      {
+        p = pm.calcRouterPower(router->GetBufferMonitor(), router->GetSwitchMonitor());
+      }
+      _routers.push_back(router);
+      power.push_back(p);
+    }
+  }
+  PARM_Vdd = orion_vdd;
+
+  _out.write(_magic, sizeof(_magic));
+  _PutU32(_out, _version);
+  _PutU32(_out, (unsigned int)_routers.size());
+  _PutU32(_out, (unsigned int)num_fields);
+  _PutU64(_out, (unsigned long long int)_interval);
+  for (size_t r = 0; r < power.size(); ++r)
+  {
+    _PutF64(_out, power[r].write);
+    _PutF64(_out, power[r].read);
+    _PutF64(_out, power[r].traversal);
+    _PutF64(_out, power[r].leakage);
+    _PutF64(_out, power[r].clock);
+  }
+
+  _last.assign(_routers.size() * num_fields, 0);
+  _Read(_last);
+}
+
+void ActivityTrace::_Read(vector<long long int> &counts) const
+{
+  counts.assign(_routers.size() * num_fields, 0);
+  for (size_t r = 0; r < _routers.size(); ++r)
+  {
+    IQRouter const *router = _routers[r];
+    if (!router)
+    {
+      continue;
+    }
+    long long int *c = &counts[r * num_fields];
+
+    vector<long long int> const &writes = router->GetBufferMonitor()->GetWrites();
+    vector<long long int> const &reads = router->GetBufferMonitor()->GetReads();
+    for (size_t i = 0; i < writes.size(); ++i)
+    {
+      c[buffer_writes] += writes[i];
+      c[buffer_reads] += reads[i];
+    }
+    vector<long long int> const &events = router->GetSwitchMonitor()->GetActivity();
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      c[traversals] += events[i];
+    }
+
+    // only counted with orion_power
+    c[vc_arbitrations] = router->_orion_activity.vc_arb.records;
+    c[sw_arbitrations] = router->_orion_activity.sw_arb.records;
+
+    long long int const id = router->GetID();
+    if (asyncConfig->doGating)
+    {
+      c[idle_ticks] = asyncConfig->idleTicksTotal[id] + router->GetIdleTicks();
+      c[gated_ticks] = asyncConfig->gatedTicksTotal[id] + router->GetGatedTicks();
+    }
+  }
+}
+
+void ActivityTrace::Sample()
+{
+  if (_ticks == 0)
+  {
+    return;
+  }
+  for (size_t s = 0; s < _net.size(); ++s)
+  {
+    _net[s]->SettleIdle();
+  }
+  _Read(_counts);
+
+  _PutU64(_out, (unsigned long long int)_time);
+  _PutU32(_out, (unsigned int)_ticks);
+  for (long long int f = 0; f < num_fields; ++f)
+  {
+    for (size_t r = 0; r < _routers.size(); ++r)
+    {
+      long long int const now = _counts[r * num_fields + f];
+      long long int const last = _last[r * num_fields + f];
+      // the Orion counters restart whenever they are fed to the models
+      _PutU32(_out, (unsigned int)((now >= last) ? (now - last) : now));
+    }
+  }
+  _out.flush();
+
+  _last.swap(_counts);
+  _ticks = 0;
+}
+
+void ActivityTrace::Rebase()
+{
+  _Read(_last);
+  _ticks = 0;
+}
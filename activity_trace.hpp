@@ -0,0 +1,80 @@
+// $Id$
+
+#ifndef _ACTIVITY_TRACE_HPP_
+#define _ACTIVITY_TRACE_HPP_
+
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "config_utils.hpp"
+
+using namespace std;
+
+class Network;
+class IQRouter;
+
+// Records the activity of every router over time: every interval ticks the
+// counts accumulated since the last snapshot are written out, one column per
+// kind of event. The file (all integers little-endian) starts with
+//
+//   magic[8] "BKSMACT1", u32 version, u32 routers, u32 fields, u64 interval
+//   per router: f64 write, read, traversal, leakage, clock power
+//
+// where the powers come from the Power_Module model (see routerPower), and
+// is followed by one record per interval:
+//
+//   u64 ticks traced up to the end of the interval, u32 ticks in the interval
+//   per field: u32 count for each router
+//
+// utils/activity2power turns a trace into power per interval.
+class ActivityTrace
+{
+public:
+  enum eField
+  {
+    buffer_writes,
+    buffer_reads,
+    traversals,
+    vc_arbitrations,
+    sw_arbitrations,
+    idle_ticks,
+    gated_ticks,
+    num_fields
+  };
+
+private:
+  ofstream _out;
+  vector<Network *> _net;
+  vector<IQRouter *> _routers;
+  long long int _interval;
+  long long int _ticks;
+  long long int _time;
+
+  // counts at the last snapshot, router-major
+  vector<long long int> _last;
+  vector<long long int> _counts;
+
+  void _Read(vector<long long int> &counts) const;
+
+public:
+  ActivityTrace(string const &filename, long long int interval,
+                vector<Network *> const &net, Configuration const &config);
+
+  inline void Tick()
+  {
+    ++_time;
+    if (++_ticks >= _interval)
+    {
+      Sample();
+    }
+  }
+
+  // writes the counts of the interval so far
+  void Sample();
+  // starts the next interval from the current counts without writing them,
+  // e.g. after the network state was restored from a checkpoint
+  void Rebase();
+};
+
+#endif
@@ -41,6 +41,9 @@
 #include "selalloc.hpp"
 #include "separable_input_first.hpp"
 #include "separable_output_first.hpp"
+#include "bitset_islip.hpp"
+#include "bitset_wavefront.hpp"
+#include "bitset_separable.hpp"
 //
 /////////////////////////////////////////////////////////////////////////
 
@@ -534,6 +537,42 @@ Allocator *Allocator::NewAllocator(Module *parent, const string &name,
     a = new SeparableOutputFirstAllocator(parent, name, inputs, outputs,
                                           arb_type);
   }
+  else if (alloc_name == "islip_bitset")
+  {
+    long long int iters = param_str.empty() ? (config ? config->GetLongInt("alloc_iters") : 1) : atoll(param_str.c_str());
+    a = new iSLIP_Bitset(parent, name, inputs, outputs, iters);
+  }
+  else if (alloc_name == "wavefront_bitset")
+  {
+    a = new Wavefront_Bitset(parent, name, inputs, outputs);
+  }
+  else if (alloc_name == "rr_wavefront_bitset")
+  {
+    a = new Wavefront_Bitset(parent, name, inputs, outputs, true);
+  }
+  else if ((alloc_name == "separable_input_first_bitset") ||
+           (alloc_name == "separable_output_first_bitset"))
+  {
+    // the bitset variants implement round-robin arbiters only; other
+    // arbiter types use the regular separable allocators
+    string arb_type = param_str.empty() ? (config ? config->GetStr("arb_type") : "round_robin") : param_str;
+    bool const input_first = (alloc_name == "separable_input_first_bitset");
+    if (arb_type != "round_robin")
+    {
+      if (input_first)
+        a = new SeparableInputFirstAllocator(parent, name, inputs, outputs, arb_type);
+      else
+        a = new SeparableOutputFirstAllocator(parent, name, inputs, outputs, arb_type);
+    }
+    else if (input_first)
+    {
+      a = new BitsetSeparableInputFirstAllocator(parent, name, inputs, outputs);
+    }
+    else
+    {
+      a = new BitsetSeparableOutputFirstAllocator(parent, name, inputs, outputs);
+    }
+  }
 
   //==================================================
   // Insert new allocators here, add another else if
@@ -36,6 +36,8 @@
 #include "module.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class Allocator : public Module
 {
 protected:
@@ -70,6 +72,13 @@ public:
 
   virtual void Allocate() = 0;
 
+  // whether Allocate() changes internal state even when there are no requests
+  virtual bool AdvancesWhenIdle() const { return false; }
+
+  // state carried from one allocation to the next, such as priority
+  // pointers; requests and grants are cleared before every allocation
+  virtual void Serialize(Checkpoint &cp) {}
+
   long long int OutputAssigned(long long int in) const;
   long long int InputAssigned(long long int out) const;
 
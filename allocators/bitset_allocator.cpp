@@ -0,0 +1,183 @@
+// $Id$
+
+// ----------------------------------------------------------------------
+//
+//  BitsetAllocator: Allocator Base Class with Bit-Mask Request Matrix
+//
+// ----------------------------------------------------------------------
+
+#include "booksim.hpp"
+#include <iostream>
+#include <cassert>
+
+#include "bitset_allocator.hpp"
+
+BitsetAllocator::BitsetAllocator(Module *parent, const string &name,
+                                 long long int inputs, long long int outputs)
+    : Allocator(parent, name, inputs, outputs),
+      _in_words(_Words(outputs)), _out_words(_Words(inputs))
+{
+  _in_req.resize(_inputs * _in_words, 0);
+  _out_req.resize(_outputs * _out_words, 0);
+  _req.resize(_inputs * _outputs);
+  _in_occ.resize(_out_words, 0);
+  _out_occ.resize(_in_words, 0);
+}
+
+void BitsetAllocator::Clear()
+{
+  // only the rows and columns that hold requests need to be wiped
+  for (long long int w = 0; w < _out_words; ++w)
+  {
+    for (mask_t bits = _in_occ[w]; bits; bits &= bits - 1)
+    {
+      long long int const in = (w << 6) + __builtin_ctzll(bits);
+      mask_t *const row = _InRow(in);
+      for (long long int v = 0; v < _in_words; ++v)
+      {
+        row[v] = 0;
+      }
+    }
+    _in_occ[w] = 0;
+  }
+  for (long long int w = 0; w < _in_words; ++w)
+  {
+    for (mask_t bits = _out_occ[w]; bits; bits &= bits - 1)
+    {
+      long long int const out = (w << 6) + __builtin_ctzll(bits);
+      mask_t *const col = _OutCol(out);
+      for (long long int v = 0; v < _out_words; ++v)
+      {
+        col[v] = 0;
+      }
+    }
+    _out_occ[w] = 0;
+  }
+
+  Allocator::Clear();
+}
+
+long long int BitsetAllocator::ReadRequest(long long int in, long long int out) const
+{
+  sRequest r;
+
+  if (!ReadRequest(r, in, out))
+  {
+    r.label = -1;
+  }
+
+  return r.label;
+}
+
+bool BitsetAllocator::ReadRequest(sRequest &req, long long int in, long long int out) const
+{
+  assert((in >= 0) && (in < _inputs));
+  assert((out >= 0) && (out < _outputs));
+
+  if (!_Test(_InRow(in), out))
+  {
+    return false;
+  }
+  req = _Request(in, out);
+  return true;
+}
+
+void BitsetAllocator::AddRequest(long long int in, long long int out, long long int label,
+                                 long long int in_pri, long long int out_pri)
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert(!_Test(_InRow(in), out));
+
+  _Set(_InRow(in), out);
+  _Set(_OutCol(out), in);
+  _Set(&_in_occ[0], in);
+  _Set(&_out_occ[0], out);
+
+  sRequest &req = _req[in * _outputs + out];
+  req.port = out;
+  req.label = label;
+  req.in_pri = in_pri;
+  req.out_pri = out_pri;
+}
+
+void BitsetAllocator::RemoveRequest(long long int in, long long int out, long long int label)
+{
+  assert((in >= 0) && (in < _inputs));
+  assert((out >= 0) && (out < _outputs));
+
+  assert(_Test(_InRow(in), out));
+  assert(_Request(in, out).label == label);
+
+  _Reset(_InRow(in), out);
+  _Reset(_OutCol(out), in);
+
+  if (!_Count(_InRow(in), _in_words))
+  {
+    _Reset(&_in_occ[0], in);
+  }
+  if (!_Count(_OutCol(out), _out_words))
+  {
+    _Reset(&_out_occ[0], out);
+  }
+}
+
+bool BitsetAllocator::InputHasRequests(long long int in) const
+{
+  return _Test(&_in_occ[0], in);
+}
+
+bool BitsetAllocator::OutputHasRequests(long long int out) const
+{
+  return _Test(&_out_occ[0], out);
+}
+
+long long int BitsetAllocator::NumInputRequests(long long int in) const
+{
+  return _Count(_InRow(in), _in_words);
+}
+
+long long int BitsetAllocator::NumOutputRequests(long long int out) const
+{
+  return _Count(_OutCol(out), _out_words);
+}
+
+void BitsetAllocator::PrintRequests(ostream *os) const
+{
+  if (!os)
+    os = &cout;
+
+  *os << "Input requests = [ ";
+  for (long long int input = 0; input < _inputs; ++input)
+  {
+    if (InputHasRequests(input))
+    {
+      *os << input << " -> [ ";
+      for (long long int output = 0; output < _outputs; ++output)
+      {
+        if (_Test(_InRow(input), output))
+        {
+          *os << output << "@" << _Request(input, output).in_pri << " ";
+        }
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "], output requests = [ ";
+  for (long long int output = 0; output < _outputs; ++output)
+  {
+    if (OutputHasRequests(output))
+    {
+      *os << output << " -> ";
+      *os << "[ ";
+      for (long long int input = 0; input < _inputs; ++input)
+      {
+        if (_Test(_OutCol(output), input))
+        {
+          *os << input << "@" << _Request(input, output).out_pri << " ";
+        }
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
@@ -0,0 +1,129 @@
+// $Id$
+
+// ----------------------------------------------------------------------
+//
+//  BitsetAllocator: Allocator Base Class with Bit-Mask Request Matrix
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITSET_ALLOCATOR_HPP_
+#define _BITSET_ALLOCATOR_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+// Keeps the request matrix as one bit mask per input row and per output
+// column, so that a round-robin search over the requests of a port is a
+// count-trailing-zeros on a rotated mask instead of a walk over a map. The
+// request attributes live in a flat inputs x outputs table next to the masks.
+// Rows wider than 64 ports span several words; routers up to 8x8 with 8 VCs
+// fit the VC allocator in a single word.
+class BitsetAllocator : public Allocator
+{
+protected:
+  typedef unsigned long long int mask_t;
+
+  // words per input row (one bit per output) and per output column
+  long long int _in_words;
+  long long int _out_words;
+
+  vector<mask_t> _in_req;
+  vector<mask_t> _out_req;
+  vector<sRequest> _req;
+
+  // inputs and outputs with at least one request
+  vector<mask_t> _in_occ;
+  vector<mask_t> _out_occ;
+
+  static inline long long int _Words(long long int bits)
+  {
+    return (bits + 63) >> 6;
+  }
+
+  static inline bool _Test(mask_t const *mask, long long int bit)
+  {
+    return (mask[bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  static inline void _Set(mask_t *mask, long long int bit)
+  {
+    mask[bit >> 6] |= 1ULL << (bit & 63);
+  }
+
+  static inline void _Reset(mask_t *mask, long long int bit)
+  {
+    mask[bit >> 6] &= ~(1ULL << (bit & 63));
+  }
+
+  static inline long long int _Count(mask_t const *mask, long long int words)
+  {
+    long long int count = 0;
+    for (long long int w = 0; w < words; ++w)
+    {
+      count += __builtin_popcountll(mask[w]);
+    }
+    return count;
+  }
+
+  // first set bit at or after start, wrapping around; -1 if the mask is empty
+  static inline long long int _FirstFrom(mask_t const *mask, long long int words, long long int start)
+  {
+    long long int const start_word = start >> 6;
+    mask_t const high = ~0ULL << (start & 63);
+    mask_t bits = mask[start_word] & high;
+    if (bits)
+    {
+      return (start_word << 6) + __builtin_ctzll(bits);
+    }
+    for (long long int w = start_word + 1; w < words; ++w)
+    {
+      if (mask[w])
+      {
+        return (w << 6) + __builtin_ctzll(mask[w]);
+      }
+    }
+    for (long long int w = 0; w < start_word; ++w)
+    {
+      if (mask[w])
+      {
+        return (w << 6) + __builtin_ctzll(mask[w]);
+      }
+    }
+    bits = mask[start_word] & ~high;
+    return bits ? ((start_word << 6) + __builtin_ctzll(bits)) : -1;
+  }
+
+  inline mask_t *_InRow(long long int in) { return &_in_req[in * _in_words]; }
+  inline mask_t const *_InRow(long long int in) const { return &_in_req[in * _in_words]; }
+  inline mask_t *_OutCol(long long int out) { return &_out_req[out * _out_words]; }
+  inline mask_t const *_OutCol(long long int out) const { return &_out_req[out * _out_words]; }
+
+  inline sRequest const &_Request(long long int in, long long int out) const
+  {
+    return _req[in * _outputs + out];
+  }
+
+public:
+  BitsetAllocator(Module *parent, const string &name,
+                  long long int inputs, long long int outputs);
+
+  virtual void Clear();
+
+  long long int ReadRequest(long long int in, long long int out) const;
+  bool ReadRequest(sRequest &req, long long int in, long long int out) const;
+
+  virtual void AddRequest(long long int in, long long int out, long long int label = 1,
+                          long long int in_pri = 0, long long int out_pri = 0);
+  virtual void RemoveRequest(long long int in, long long int out, long long int label = 1);
+
+  bool OutputHasRequests(long long int out) const;
+  bool InputHasRequests(long long int in) const;
+
+  long long int NumOutputRequests(long long int out) const;
+  long long int NumInputRequests(long long int in) const;
+
+  void PrintRequests(ostream *os = NULL) const;
+};
+
+#endif
@@ -0,0 +1,96 @@
+// $Id$
+
+#include "booksim.hpp"
+#include <iostream>
+
+#include "bitset_islip.hpp"
+#include "checkpoint.hpp"
+
+iSLIP_Bitset::iSLIP_Bitset(Module *parent, const string &name,
+                           long long int inputs, long long int outputs, long long int iters)
+    : BitsetAllocator(parent, name, inputs, outputs), _iSLIP_iter(iters)
+{
+  _gptrs.resize(_outputs, 0);
+  _aptrs.resize(_inputs, 0);
+  _grants.resize(_inputs * _in_words, 0);
+  _granted_in.resize(_out_words, 0);
+  _matched_in.resize(_out_words, 0);
+  _matched_out.resize(_in_words, 0);
+  _cand.resize(_out_words, 0);
+}
+
+void iSLIP_Bitset::Allocate()
+{
+  _matched_in.assign(_out_words, 0);
+  _matched_out.assign(_in_words, 0);
+
+  for (long long int iter = 0; iter < _iSLIP_iter; ++iter)
+  {
+    // Grant phase: each unmatched output grants the first unmatched input
+    // at or after its pointer
+
+    bool granted = false;
+
+    for (long long int ow = 0; ow < _in_words; ++ow)
+    {
+      for (mask_t obits = _out_occ[ow] & ~_matched_out[ow]; obits; obits &= obits - 1)
+      {
+        long long int const output = (ow << 6) + __builtin_ctzll(obits);
+        mask_t const *const col = _OutCol(output);
+        for (long long int w = 0; w < _out_words; ++w)
+        {
+          _cand[w] = col[w] & ~_matched_in[w];
+        }
+        long long int const input = _FirstFrom(&_cand[0], _out_words, _gptrs[output]);
+        if (input >= 0)
+        {
+          _Set(&_grants[input * _in_words], output);
+          _Set(&_granted_in[0], input);
+          granted = true;
+        }
+      }
+    }
+
+    // nothing changes in later iterations once no output can grant
+    if (!granted)
+    {
+      break;
+    }
+
+    // Accept phase: each input accepts the first grant at or after its
+    // pointer
+
+    for (long long int iw = 0; iw < _out_words; ++iw)
+    {
+      for (mask_t ibits = _granted_in[iw]; ibits; ibits &= ibits - 1)
+      {
+        long long int const input = (iw << 6) + __builtin_ctzll(ibits);
+        mask_t *const grants = &_grants[input * _in_words];
+        long long int const output = _FirstFrom(grants, _in_words, _aptrs[input]);
+        for (long long int w = 0; w < _in_words; ++w)
+        {
+          grants[w] = 0;
+        }
+
+        _inmatch[input] = output;
+        _outmatch[output] = input;
+        _Set(&_matched_in[0], input);
+        _Set(&_matched_out[0], output);
+
+        // Only update pointers if accepted during the 1st iteration
+        if (iter == 0)
+        {
+          _gptrs[output] = (input + 1) % _inputs;
+          _aptrs[input] = (output + 1) % _outputs;
+        }
+      }
+      _granted_in[iw] = 0;
+    }
+  }
+}
+
+void iSLIP_Bitset::Serialize(Checkpoint &cp)
+{
+  cp.Io(_gptrs);
+  cp.Io(_aptrs);
+}
@@ -0,0 +1,35 @@
+// $Id$
+
+#ifndef _BITSET_ISLIP_HPP_
+#define _BITSET_ISLIP_HPP_
+
+#include <vector>
+
+#include "bitset_allocator.hpp"
+
+// iSLIP on the bit-mask request matrix; grants and pointer updates are
+// identical to iSLIP_Sparse
+class iSLIP_Bitset : public BitsetAllocator
+{
+  long long int _iSLIP_iter;
+
+  vector<long long int> _gptrs;
+  vector<long long int> _aptrs;
+
+  // per input, the outputs that granted to it in the current iteration
+  vector<mask_t> _grants;
+  vector<mask_t> _granted_in;
+  vector<mask_t> _matched_in;
+  vector<mask_t> _matched_out;
+  vector<mask_t> _cand;
+
+public:
+  iSLIP_Bitset(Module *parent, const string &name,
+               long long int inputs, long long int outputs, long long int iters);
+
+  void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
+};
+
+#endif
@@ -0,0 +1,211 @@
+// $Id$
+
+// ----------------------------------------------------------------------
+//
+//  BitsetSeparableAllocator: Separable Allocators on Bit-Mask Requests
+//
+// ----------------------------------------------------------------------
+
+#include "bitset_separable.hpp"
+
+#include "booksim.hpp"
+#include "checkpoint.hpp"
+
+#include <cassert>
+
+BitsetSeparableAllocator::BitsetSeparableAllocator(Module *parent, const string &name,
+                                                   long long int inputs, long long int outputs,
+                                                   bool input_first)
+    : BitsetAllocator(parent, name, inputs, outputs)
+{
+  _input_ptr.resize(_inputs, 0);
+  _output_ptr.resize(_outputs, 0);
+  if (input_first)
+  {
+    _fwd.resize(_outputs * _out_words, 0);
+    _fwd_occ.resize(_in_words, 0);
+  }
+  else
+  {
+    _fwd.resize(_inputs * _in_words, 0);
+    _fwd_occ.resize(_out_words, 0);
+  }
+}
+
+long long int BitsetSeparableAllocator::_Arbitrate(mask_t const *mask, long long int words,
+                                                   long long int pointer, long long int size,
+                                                   bool by_input, long long int port) const
+{
+  bool found = false;
+  bool uniform = true;
+  long long int top_pri = 0;
+
+  for (long long int w = 0; w < words; ++w)
+  {
+    for (mask_t bits = mask[w]; bits; bits &= bits - 1)
+    {
+      long long int const cand = (w << 6) + __builtin_ctzll(bits);
+      long long int const pri = by_input ? _Request(port, cand).in_pri : _Request(cand, port).out_pri;
+      if (!found)
+      {
+        found = true;
+        top_pri = pri;
+      }
+      else if (pri != top_pri)
+      {
+        uniform = false;
+        top_pri = max(top_pri, pri);
+      }
+    }
+  }
+
+  if (!found)
+  {
+    return -1;
+  }
+
+  if (uniform)
+  {
+    return _FirstFrom(mask, words, pointer);
+  }
+
+  long long int best = -1;
+  long long int best_dist = size;
+  for (long long int w = 0; w < words; ++w)
+  {
+    for (mask_t bits = mask[w]; bits; bits &= bits - 1)
+    {
+      long long int const cand = (w << 6) + __builtin_ctzll(bits);
+      long long int const pri = by_input ? _Request(port, cand).in_pri : _Request(cand, port).out_pri;
+      long long int const dist = (cand - pointer + size) % size;
+      if ((pri == top_pri) && (dist < best_dist))
+      {
+        best = cand;
+        best_dist = dist;
+      }
+    }
+  }
+  return best;
+}
+
+void BitsetSeparableAllocator::Serialize(Checkpoint &cp)
+{
+  cp.Io(_input_ptr);
+  cp.Io(_output_ptr);
+}
+
+// ----------------------------------------------------------------------
+//
+//  BitsetSeparableInputFirstAllocator: Separable Input-First Allocator
+//
+// ----------------------------------------------------------------------
+
+BitsetSeparableInputFirstAllocator::
+    BitsetSeparableInputFirstAllocator(Module *parent, const string &name, long long int inputs,
+                                       long long int outputs)
+    : BitsetSeparableAllocator(parent, name, inputs, outputs, true)
+{
+}
+
+void BitsetSeparableInputFirstAllocator::Allocate()
+{
+
+  // Execute the input arbiters and propagate the grants to the output
+  // arbiters.
+
+  for (long long int iw = 0; iw < _out_words; ++iw)
+  {
+    for (mask_t ibits = _in_occ[iw]; ibits; ibits &= ibits - 1)
+    {
+      long long int const input = (iw << 6) + __builtin_ctzll(ibits);
+      long long int const output = _Arbitrate(_InRow(input), _in_words, _input_ptr[input],
+                                              _outputs, true, input);
+      assert(output > -1);
+      _Set(&_fwd[output * _out_words], input);
+      _Set(&_fwd_occ[0], output);
+    }
+  }
+
+  // Execute the output arbiters.
+
+  for (long long int ow = 0; ow < _in_words; ++ow)
+  {
+    for (mask_t obits = _fwd_occ[ow]; obits; obits &= obits - 1)
+    {
+      long long int const output = (ow << 6) + __builtin_ctzll(obits);
+      mask_t *const fwd = &_fwd[output * _out_words];
+      long long int const input = _Arbitrate(fwd, _out_words, _output_ptr[output],
+                                             _inputs, false, output);
+      assert((input > -1) && (_inmatch[input] == -1) && (_outmatch[output] == -1));
+
+      _inmatch[input] = output;
+      _outmatch[output] = input;
+      _input_ptr[input] = (output + 1) % _outputs;
+      _output_ptr[output] = (input + 1) % _inputs;
+
+      for (long long int w = 0; w < _out_words; ++w)
+      {
+        fwd[w] = 0;
+      }
+    }
+    _fwd_occ[ow] = 0;
+  }
+}
+
+// ----------------------------------------------------------------------
+//
+//  BitsetSeparableOutputFirstAllocator: Separable Output-First Allocator
+//
+// ----------------------------------------------------------------------
+
+BitsetSeparableOutputFirstAllocator::
+    BitsetSeparableOutputFirstAllocator(Module *parent, const string &name, long long int inputs,
+                                        long long int outputs)
+    : BitsetSeparableAllocator(parent, name, inputs, outputs, false)
+{
+}
+
+void BitsetSeparableOutputFirstAllocator::Allocate()
+{
+
+  // Execute the output arbiters and propagate the grants to the input
+  // arbiters.
+
+  for (long long int ow = 0; ow < _in_words; ++ow)
+  {
+    for (mask_t obits = _out_occ[ow]; obits; obits &= obits - 1)
+    {
+      long long int const output = (ow << 6) + __builtin_ctzll(obits);
+      long long int const input = _Arbitrate(_OutCol(output), _out_words, _output_ptr[output],
+                                             _inputs, false, output);
+      assert(input > -1);
+      _Set(&_fwd[input * _in_words], output);
+      _Set(&_fwd_occ[0], input);
+    }
+  }
+
+  // Execute the input arbiters.
+
+  for (long long int iw = 0; iw < _out_words; ++iw)
+  {
+    for (mask_t ibits = _fwd_occ[iw]; ibits; ibits &= ibits - 1)
+    {
+      long long int const input = (iw << 6) + __builtin_ctzll(ibits);
+      mask_t *const fwd = &_fwd[input * _in_words];
+      long long int const output = _Arbitrate(fwd, _in_words, _input_ptr[input],
+                                              _outputs, true, input);
+      assert((output > -1) && (_inmatch[input] == -1) && (_outmatch[output] == -1));
+
+      _inmatch[input] = output;
+      _outmatch[output] = input;
+      _input_ptr[input] = (output + 1) % _outputs;
+      _output_ptr[output] = (input + 1) % _inputs;
+
+      for (long long int w = 0; w < _in_words; ++w)
+      {
+        fwd[w] = 0;
+      }
+    }
+    _fwd_occ[iw] = 0;
+  }
+}
@@ -0,0 +1,65 @@
+// $Id$
+
+// ----------------------------------------------------------------------
+//
+//  BitsetSeparableAllocator: Separable Allocators on Bit-Mask Requests
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITSET_SEPARABLE_HPP_
+#define _BITSET_SEPARABLE_HPP_
+
+#include <vector>
+
+#include "bitset_allocator.hpp"
+
+// Separable allocators with round-robin arbiters folded into the allocator:
+// each arbiter is reduced to its priority pointer, and arbitration is a
+// search of the request mask rather than a pass over an Arbiter object.
+// Grants and pointer updates are identical to the separable allocators with
+// arb_type = round_robin.
+class BitsetSeparableAllocator : public BitsetAllocator
+{
+
+protected:
+  vector<long long int> _input_ptr;
+  vector<long long int> _output_ptr;
+
+  // requests forwarded from the first to the second arbitration stage,
+  // one mask per port of the second stage
+  vector<mask_t> _fwd;
+  vector<mask_t> _fwd_occ;
+
+  // round-robin arbitration among the set bits of mask: highest priority
+  // first, ties broken by distance from the pointer
+  long long int _Arbitrate(mask_t const *mask, long long int words, long long int pointer,
+                           long long int size, bool by_input, long long int port) const;
+
+public:
+  BitsetSeparableAllocator(Module *parent, const string &name, long long int inputs,
+                           long long int outputs, bool input_first);
+
+  virtual void Serialize(Checkpoint &cp);
+};
+
+class BitsetSeparableInputFirstAllocator : public BitsetSeparableAllocator
+{
+
+public:
+  BitsetSeparableInputFirstAllocator(Module *parent, const string &name, long long int inputs,
+                                     long long int outputs);
+
+  virtual void Allocate();
+};
+
+class BitsetSeparableOutputFirstAllocator : public BitsetSeparableAllocator
+{
+
+public:
+  BitsetSeparableOutputFirstAllocator(Module *parent, const string &name, long long int inputs,
+                                      long long int outputs);
+
+  virtual void Allocate();
+};
+
+#endif
@@ -0,0 +1,164 @@
+// $Id$
+
+#include "booksim.hpp"
+
+#include <algorithm>
+
+#include "bitset_wavefront.hpp"
+#include "checkpoint.hpp"
+
+Wavefront_Bitset::Wavefront_Bitset(Module *parent, const string &name,
+                                   long long int inputs, long long int outputs, bool skip_diags)
+    : BitsetAllocator(parent, name, inputs, outputs),
+      _last_in(-1), _last_out(-1), _skip_diags(skip_diags), _num_classes(0),
+      _square(max(inputs, outputs)), _pri(0), _num_requests(0)
+{
+  _matched_in.resize(_out_words, 0);
+  _matched_out.resize(_in_words, 0);
+}
+
+void Wavefront_Bitset::_ResetClasses()
+{
+  for (long long int c = 0; c < _num_classes; ++c)
+  {
+    _class_diags[c].assign(_class_diags[c].size(), 0);
+  }
+  _num_classes = 0;
+  _num_requests = 0;
+  _last_in = -1;
+  _last_out = -1;
+}
+
+void Wavefront_Bitset::Clear()
+{
+  _ResetClasses();
+  BitsetAllocator::Clear();
+}
+
+void Wavefront_Bitset::AddRequest(long long int in, long long int out, long long int label,
+                                  long long int in_pri, long long int out_pri)
+{
+  BitsetAllocator::AddRequest(in, out, label, in_pri, out_pri);
+  _num_requests++;
+  _last_in = in;
+  _last_out = out;
+
+  pair<long long int, long long int> const pri(out_pri, in_pri);
+  long long int c = 0;
+  while ((c < _num_classes) && (_class_pri[c] != pri))
+  {
+    ++c;
+  }
+  if (c == _num_classes)
+  {
+    if (c == (long long int)_class_pri.size())
+    {
+      _class_pri.push_back(pri);
+      _class_diags.push_back(vector<mask_t>(_square * _in_words, 0));
+    }
+    else
+    {
+      _class_pri[c] = pri;
+    }
+    ++_num_classes;
+  }
+  _Set(&_class_diags[c][((in + out) % _square) * _in_words], out);
+}
+
+void Wavefront_Bitset::RemoveRequest(long long int in, long long int out, long long int label)
+{
+  sRequest const &req = _Request(in, out);
+  pair<long long int, long long int> const pri(req.out_pri, req.in_pri);
+  for (long long int c = 0; c < _num_classes; ++c)
+  {
+    if (_class_pri[c] == pri)
+    {
+      _Reset(&_class_diags[c][((in + out) % _square) * _in_words], out);
+      break;
+    }
+  }
+  BitsetAllocator::RemoveRequest(in, out, label);
+}
+
+void Wavefront_Bitset::Allocate()
+{
+
+  long long int first_diag = -1;
+
+  if (_num_requests == 0)
+
+    // bypass allocator completely if there were no requests
+    return;
+
+  if (_num_requests == 1)
+  {
+
+    // if we only had a single request, we can immediately grant it
+    _inmatch[_last_in] = _last_out;
+    _outmatch[_last_out] = _last_in;
+    first_diag = _last_in + _last_out;
+  }
+  else
+  {
+
+    // otherwise sweep the diagonals of each priority class, highest first
+
+    _class_order.resize(_num_classes);
+    for (long long int c = 0; c < _num_classes; ++c)
+    {
+      _class_order[c] = c;
+    }
+    sort(_class_order.begin(), _class_order.end(),
+         [this](long long int a, long long int b)
+         { return _class_pri[a] > _class_pri[b]; });
+
+    _matched_in.assign(_out_words, 0);
+    _matched_out.assign(_in_words, 0);
+
+    for (long long int c = 0; c < _num_classes; ++c)
+    {
+      vector<mask_t> const &diags = _class_diags[_class_order[c]];
+
+      for (long long int p = 0; p < _square; ++p)
+      {
+        long long int const diag = (_pri + p) % _square;
+        mask_t const *const cells = &diags[diag * _in_words];
+
+        // the cells of a diagonal share no row or column, so they can be
+        // granted independently, in order of increasing output
+        for (long long int w = 0; w < _in_words; ++w)
+        {
+          for (mask_t bits = cells[w] & ~_matched_out[w]; bits; bits &= bits - 1)
+          {
+            long long int const output = (w << 6) + __builtin_ctzll(bits);
+            long long int const input = (diag + _square - output) % _square;
+            if (!_Test(&_matched_in[0], input))
+            {
+              // Grant!
+              _inmatch[input] = output;
+              _outmatch[output] = input;
+              _Set(&_matched_in[0], input);
+              _Set(&_matched_out[0], output);
+              if (first_diag < 0)
+              {
+                first_diag = input + output;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  _ResetClasses();
+
+  assert(first_diag >= 0);
+
+  // Round-robin the priority diagonal
+  _pri = ((_skip_diags ? first_diag : _pri) + 1) % _square;
+}
+
+void Wavefront_Bitset::Serialize(Checkpoint &cp)
+{
+  cp.Io(_pri);
+}
@@ -0,0 +1,53 @@
+// $Id$
+
+#ifndef _BITSET_WAVEFRONT_HPP_
+#define _BITSET_WAVEFRONT_HPP_
+
+#include <vector>
+
+#include "bitset_allocator.hpp"
+
+// Wavefront allocator on the bit-mask request matrix; grants and the
+// priority diagonal are identical to Wavefront. Requests are additionally
+// binned by diagonal, one mask of outputs per diagonal and priority class,
+// so that sweeping a diagonal only visits the cells that hold requests.
+class Wavefront_Bitset : public BitsetAllocator
+{
+
+private:
+  long long int _last_in;
+  long long int _last_out;
+  bool _skip_diags;
+
+  // (out_pri, in_pri) of each priority class seen since the last
+  // allocation, and its diagonal masks; storage is kept across cycles
+  long long int _num_classes;
+  vector<pair<long long int, long long int>> _class_pri;
+  vector<vector<mask_t>> _class_diags;
+  vector<long long int> _class_order;
+
+  vector<mask_t> _matched_in;
+  vector<mask_t> _matched_out;
+
+  void _ResetClasses();
+
+protected:
+  long long int _square;
+  long long int _pri;
+  long long int _num_requests;
+
+public:
+  Wavefront_Bitset(Module *parent, const string &name,
+                   long long int inputs, long long int outputs, bool skip_diags = false);
+
+  virtual void Clear();
+
+  virtual void AddRequest(long long int in, long long int out, long long int label = 1,
+                          long long int in_pri = 0, long long int out_pri = 0);
+  virtual void RemoveRequest(long long int in, long long int out, long long int label = 1);
+  virtual void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
+};
+
+#endif
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "islip.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_ISLIP
@@ -204,3 +205,9 @@ void iSLIP_Sparse::Allocate()
   cout << endl;
 #endif
 }
+
+void iSLIP_Sparse::Serialize(Checkpoint &cp)
+{
+  cp.Io(_gptrs);
+  cp.Io(_aptrs);
+}
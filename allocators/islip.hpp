@@ -44,6 +44,8 @@ public:
                long long int inputs, long long int outputs, long long int iters);
 
   void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "loa.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 LOA::LOA(Module *parent, const string &name,
@@ -113,3 +114,9 @@ void LOA::Allocate()
     }
   }
 }
+
+void LOA::Serialize(Checkpoint &cp)
+{
+  cp.Io(_rptr);
+  cp.Io(_gptr);
+}
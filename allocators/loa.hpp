@@ -45,6 +45,8 @@ public:
       long long int inputs, long long int outputs);
 
   void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
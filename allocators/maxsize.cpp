@@ -33,6 +33,7 @@
 #include <iostream>
 
 #include "maxsize.hpp"
+#include "checkpoint.hpp"
 
 // shortest augmenting path:
 //
@@ -219,3 +220,8 @@ found_augmenting:
 
   return true;
 }
+
+void MaxSizeMatch::Serialize(Checkpoint &cp)
+{
+  cp.Io(_prio);
+}
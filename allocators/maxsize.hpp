@@ -47,6 +47,10 @@ public:
   ~MaxSizeMatch();
 
   void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
+
+  bool AdvancesWhenIdle() const { return true; }
 };
 
 #endif
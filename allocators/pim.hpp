@@ -43,6 +43,8 @@ public:
   ~PIM();
 
   void Allocate();
+
+  bool AdvancesWhenIdle() const { return true; }
 };
 
 #endif
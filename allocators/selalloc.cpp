@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "selalloc.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_SELALLOC
@@ -284,3 +285,10 @@ void SelAlloc::PrintRequests(ostream *os) const
   }
   *os << "]." << endl;
 }
+
+void SelAlloc::Serialize(Checkpoint &cp)
+{
+  cp.Io(_aptrs);
+  cp.Io(_gptrs);
+  cp.Io(_outmask);
+}
@@ -47,6 +47,8 @@ public:
 
   void Allocate();
 
+  virtual void Serialize(Checkpoint &cp);
+
   void MaskOutput(long long int out, long long int mask = 1);
 
   virtual void PrintRequests(ostream *os = NULL) const;
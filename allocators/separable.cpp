@@ -90,3 +90,15 @@ void SeparableAllocator::Clear()
   }
   SparseAllocator::Clear();
 }
+
+void SeparableAllocator::Serialize(Checkpoint &cp)
+{
+  for (size_t i = 0; i < _input_arb.size(); ++i)
+  {
+    _input_arb[i]->Serialize(cp);
+  }
+  for (size_t i = 0; i < _output_arb.size(); ++i)
+  {
+    _output_arb[i]->Serialize(cp);
+  }
+}
@@ -54,6 +54,8 @@ public:
   virtual ~SeparableAllocator();
 
   virtual void Clear();
+
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
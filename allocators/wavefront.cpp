@@ -33,6 +33,7 @@
 #include "booksim.hpp"
 
 #include "wavefront.hpp"
+#include "checkpoint.hpp"
 
 Wavefront::Wavefront(Module *parent, const string &name,
                      long long int inputs, long long int outputs, bool skip_diags) : DenseAllocator(parent, name, inputs, outputs),
@@ -113,3 +114,8 @@ void Wavefront::Allocate()
   // Round-robin the priority diagonal
   _pri = ((_skip_diags ? first_diag : _pri) + 1) % _square;
 }
+
+void Wavefront::Serialize(Checkpoint &cp)
+{
+  cp.Io(_pri);
+}
@@ -53,6 +53,8 @@ public:
   virtual void AddRequest(long long int in, long long int out, long long int label = 1,
                           long long int in_pri = 0, long long int out_pri = 0);
   virtual void Allocate();
+
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
@@ -38,6 +38,8 @@
 
 #include "module.hpp"
 
+class Checkpoint;
+
 class Arbiter : public Module
 {
 
@@ -76,6 +78,9 @@ public:
 
   virtual void Clear();
 
+  // priority state carried from one arbitration to the next
+  virtual void Serialize(Checkpoint &cp) {}
+
   inline long long int LastWinner() const
   {
     return _selected;
@@ -60,6 +60,8 @@ public:
 
   virtual void Clear();
 
+  virtual void Serialize(Checkpoint &cp);
+
   static inline bool Supersedes(long long int input1, long long int pri1, long long int input2, long long int pri2, long long int offset, long long int size)
   {
     // in a round-robin scheme with the given number of positions and current
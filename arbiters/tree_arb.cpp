@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "tree_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 #include <sstream>
 
@@ -131,3 +132,12 @@ void TreeArbiter::Clear()
   _global_arbiter->Clear();
   Arbiter::Clear();
 }
+
+void TreeArbiter::Serialize(Checkpoint &cp)
+{
+  for (size_t i = 0; i < _group_arbiters.size(); ++i)
+  {
+    _group_arbiters[i]->Serialize(cp);
+  }
+  _global_arbiter->Serialize(cp);
+}
@@ -65,6 +65,8 @@ public:
   virtual void AddRequest(long long int input, long long int id, long long int pri);
 
   virtual void Clear();
+
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
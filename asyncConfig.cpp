@@ -11,11 +11,15 @@
 #include <map>
 #include <list>
 #include <fstream>
-#include <chrono>
-#include <random>
+#include <ctime>
+#include <cassert>
+#include <limits>
+#include <algorithm>
 
 #include "asyncConfig.hpp"
 #include "random_utils.hpp"
+#include "delay_sampler.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -35,15 +39,21 @@ void AsyncConfig::init(unsigned long long int numberOfNodes, const Configuration
 
     for (unsigned long long int i = 0; i < numberOfNodes; i++)
     {
-        idleTicksCounter.push_back(0);
         viableIdleTicksSum.push_back(0);
         viableIdleTimesSum.push_back(0);
         routerSleepThreshold.push_back(sleepThresholdStep);
         
 
-        gatedTicksCounter.push_back(0);
         viableGatedTicksSum.push_back(0);
         gatedTimesSum.push_back(0);
+        idleTicksTotal.push_back(0);
+        gatedTicksTotal.push_back(0);
+
+        queueTicks.push_back(0);
+        routeTicks.push_back(0);
+        vcaTicks.push_back(0);
+        swaTicks.push_back(0);
+        crossbarTicks.push_back(0);
     }
 };
 
@@ -316,9 +326,7 @@ void AsyncConfig::readCreditDelayStdDevs(const Configuration &config)
     //setting the random stuff
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        creditDelaySeed.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        creditDelayRandomGenerator.push_back(default_random_engine(creditDelaySeed[i]));
-        creditDelayRandomDistribution.push_back(normal_distribution<double>(creditDelays[i], creditDelayStdDevs[i]));
+        creditDelaySampler.push_back(DelaySampler::New(delaySampler, creditDelays[i], creditDelayStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 0)));
     }
 };
 
@@ -356,9 +364,7 @@ void AsyncConfig::readRoutingDelayStdDevs(const Configuration &config)
     //setting the random stuff
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        routingDelaySeed.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        routingDelayRandomGenerator.push_back(default_random_engine(routingDelaySeed[i]));
-        routingDelayRandomDistribution.push_back(normal_distribution<double>(routingDelays[i], routingDelayStdDevs[i]));
+        routingDelaySampler.push_back(DelaySampler::New(delaySampler, routingDelays[i], routingDelayStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 1)));
     }
 };
 
@@ -396,9 +402,7 @@ void AsyncConfig::readVCAllocDelayStdDevs(const Configuration &config)
     //setting the random stuff
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        VCAllocDelaySeed.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        VCAllocDelayRandomGenerator.push_back(default_random_engine(VCAllocDelaySeed[i]));
-        VCAllocDelayRandomDistribution.push_back(normal_distribution<double>(vcAllocDelays[i], vCAllocDelayStdDevs[i]));
+        VCAllocDelaySampler.push_back(DelaySampler::New(delaySampler, vcAllocDelays[i], vCAllocDelayStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 2)));
     }
 };
 
@@ -436,9 +440,7 @@ void AsyncConfig::readSwAllocDelayStdDevs(const Configuration &config)
     //setting the random stuff
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        SwAllocDelaySeed.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        SwAllocDelayRandomGenerator.push_back(default_random_engine(SwAllocDelaySeed[i]));
-        SwAllocDelayRandomDistribution.push_back(normal_distribution<double>(swAllocDelays[i], swAllocDelayStdDevs[i]));
+        SwAllocDelaySampler.push_back(DelaySampler::New(delaySampler, swAllocDelays[i], swAllocDelayStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 3)));
     }
 };
 
@@ -476,9 +478,7 @@ void AsyncConfig::readSTFinalDelayStdDevs(const Configuration &config)
     //setting the random stuff
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        sTFinalDelaySeed.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        sTFinalDelayRandomGenerator.push_back(default_random_engine(sTFinalDelaySeed[i]));
-        sTFinalDelayRandomDistribution.push_back(normal_distribution<double>(stFinalDelays[i], sTFinalDelayStdDevs[i]));
+        sTFinalDelaySampler.push_back(DelaySampler::New(delaySampler, stFinalDelays[i], sTFinalDelayStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 4)));
     }
 };
 
@@ -548,9 +548,8 @@ void AsyncConfig::readSwAllocThresholdPenalityStdDevs(const Configuration &confi
 
     for (unsigned long long int i = 0; i < params.size(); i++)
     {
-        seedMetaStable.push_back(std::chrono::system_clock::now().time_since_epoch().count());
-        generatorMetaStable.push_back(default_random_engine(seedMetaStable[i]));
-        distributionMetaStable.push_back(normal_distribution<double>(0, swAllocThresholdStdDevs[i]));
+        thresholdPenaltySampler.push_back(DelaySampler::New(delaySampler, 0, swAllocThresholdStdDevs[i], Xoshiro256::StreamSeed(delaySeed, i, 5)));
+        metaStableRng.push_back(Xoshiro256(Xoshiro256::StreamSeed(delaySeed, i, 6)));
     }
 };
 
@@ -622,6 +621,18 @@ void AsyncConfig::readswAllocMetaStableMaxPenalities(const Configuration &config
 
 AsyncConfig::AsyncConfig(const Configuration &config)
 {
+    // the delay streams are derived from the simulation seed, so that runs
+    // repeat exactly and do not depend on which thread steps a router
+    if (config.GetStr("seed") == "time")
+    {
+        delaySeed = time(NULL);
+    }
+    else
+    {
+        delaySeed = config.GetLongInt("seed");
+    }
+    delaySampler = config.GetStr("delay_sampler");
+
     readCreaditDelays(config);
     readRoutingDelays(config);
     readVCAllocDelays(config);
@@ -642,22 +653,71 @@ AsyncConfig::AsyncConfig(const Configuration &config)
     readSwAllocMetaStableThresholds(config);
     readswAllocMetaStableMaxPenalities(config);
 
-    queueTicks=0;
-	routeTicks=0;
-	vcaTicks=0;
-	swaTicks=0;
-	crossbarTicks=0;
+    classifyRouters();
+}
+
+// A router whose delays cannot vary is served from fixed per-stage values
+// without touching its samplers; an async router with all standard
+// deviations at zero draws its mean every time, clamped to one cycle.
+// Routers whose switch allocation delay does not depend on the previous
+// allocation skip that bookkeeping.
+void AsyncConfig::classifyRouters()
+{
+    for (unsigned long long int i = 0; i < creditDelays.size(); i++)
+    {
+        bool const thresholdPenalty = isAsync[i] && swAllocThresholdStdDevs[i] != 0;
+        bool const metaStablePenalty = isMetaStable[i] && swAllocMetaStableMaxPenality[i] != 0;
+        bool const stochastic = isAsync[i] &&
+                                (creditDelayStdDevs[i] != 0 || routingDelayStdDevs[i] != 0 ||
+                                 vCAllocDelayStdDevs[i] != 0 || swAllocDelayStdDevs[i] != 0 ||
+                                 sTFinalDelayStdDevs[i] != 0);
+        if (thresholdPenalty || metaStablePenalty)
+        {
+            delayClass.push_back(METASTABLE_DELAY);
+        }
+        else if (stochastic)
+        {
+            delayClass.push_back(STOCHASTIC_DELAY);
+        }
+        else
+        {
+            delayClass.push_back(CONSTANT_DELAY);
+        }
+
+        long long int const minDelay = isAsync[i] ? 1 : numeric_limits<long long int>::min();
+        fixedCreditDelays.push_back(max(creditDelays[i], minDelay));
+        fixedRoutingDelays.push_back(max(routingDelays[i], minDelay));
+        fixedVcAllocDelays.push_back(max(vcAllocDelays[i], minDelay));
+        fixedSwAllocDelays.push_back(max(swAllocDelays[i], minDelay));
+        fixedStFinalDelays.push_back(max(stFinalDelays[i], minDelay));
+    }
 }
 AsyncConfig::AsyncConfig()
 {
 }
 
-long long int AsyncConfig::getCreditDelay(long long int routerID)
+AsyncConfig::~AsyncConfig()
+{
+    for (unsigned long long int i = 0; i < creditDelaySampler.size(); i++)
+        delete creditDelaySampler[i];
+    for (unsigned long long int i = 0; i < routingDelaySampler.size(); i++)
+        delete routingDelaySampler[i];
+    for (unsigned long long int i = 0; i < VCAllocDelaySampler.size(); i++)
+        delete VCAllocDelaySampler[i];
+    for (unsigned long long int i = 0; i < SwAllocDelaySampler.size(); i++)
+        delete SwAllocDelaySampler[i];
+    for (unsigned long long int i = 0; i < sTFinalDelaySampler.size(); i++)
+        delete sTFinalDelaySampler[i];
+    for (unsigned long long int i = 0; i < thresholdPenaltySampler.size(); i++)
+        delete thresholdPenaltySampler[i];
+}
+
+long long int AsyncConfig::sampleCreditDelay(long long int routerID)
 {
 
     if (isAsync[routerID])
     {
-        long long int temp = creditDelayRandomDistribution[routerID](creditDelayRandomGenerator[routerID]);
+        long long int temp = creditDelaySampler[routerID]->Sample();
 
         if (temp >= 1)
         {
@@ -676,11 +736,11 @@ long long int AsyncConfig::getCreditDelay(long long int routerID)
     }
 };
 
-long long int AsyncConfig::getRoutingDelay(long long int routerID)
+long long int AsyncConfig::sampleRoutingDelay(long long int routerID)
 {
     if (isAsync[routerID])
     {
-        long long int temp = routingDelayRandomDistribution[routerID](routingDelayRandomGenerator[routerID]);
+        long long int temp = routingDelaySampler[routerID]->Sample();
 
         if (temp >= 1)
         {
@@ -698,11 +758,11 @@ long long int AsyncConfig::getRoutingDelay(long long int routerID)
         return routingDelays[routerID];
     }
 };
-long long int AsyncConfig::getVcAllocDelay(long long int routerID)
+long long int AsyncConfig::sampleVcAllocDelay(long long int routerID)
 {
     if (isAsync[routerID])
     {
-        long long int temp = VCAllocDelayRandomDistribution[routerID](VCAllocDelayRandomGenerator[routerID]);
+        long long int temp = VCAllocDelaySampler[routerID]->Sample();
 
         if (temp >= 1)
         {
@@ -721,14 +781,14 @@ long long int AsyncConfig::getVcAllocDelay(long long int routerID)
     }
 };
 
-long long int AsyncConfig::getSwAllocDelay(long long int routerID, long long int output)
+long long int AsyncConfig::sampleSwAllocDelay(long long int routerID, long long int output)
 {
     long long int delay = 0;
     // swAllocDelays[routerID];
 
     if (isAsync[routerID])
     {
-        long long int temp = SwAllocDelayRandomDistribution[routerID](SwAllocDelayRandomGenerator[routerID]);
+        long long int temp = SwAllocDelaySampler[routerID]->Sample();
 
         if (temp >= 1)
         {
@@ -746,12 +806,18 @@ long long int AsyncConfig::getSwAllocDelay(long long int routerID, long long int
         delay = swAllocDelays[routerID];
     }
 
+    // only metastable routers depend on the time since the last allocation
+    if (delayClass[routerID] != METASTABLE_DELAY)
+    {
+        return delay;
+    }
+
     if (isAsync[routerID])
     {
         if ((GetSimTime() - previousSwitchAllocation[routerID][output]) < swAllocThresholds[routerID])
         {
             //cout<<"Hit++++++++++++++++++++"<<endl;
-            long long int additionalDelay = distributionMetaStable[routerID](generatorMetaStable[routerID]);
+            long long int additionalDelay = thresholdPenaltySampler[routerID]->Sample();
             if (additionalDelay < 0)
             {
                 additionalDelay = -additionalDelay;
@@ -765,7 +831,7 @@ long long int AsyncConfig::getSwAllocDelay(long long int routerID, long long int
         if ((GetSimTime() - previousSwitchAllocation[routerID][output]) < swAllocMetaStableThresholds[routerID])
         {
             long long int additionalDelay;
-            double x = rand() % 1000 + 1;
+            double x = metaStableRng[routerID].Next() % 1000 + 1;
             x = log(1000 / x) / metaStabiliyNormaliser;
             additionalDelay = x * swAllocMetaStableMaxPenality[routerID];
             delay += additionalDelay;
@@ -776,11 +842,11 @@ long long int AsyncConfig::getSwAllocDelay(long long int routerID, long long int
     return delay;
 };
 
-long long int AsyncConfig::getStFinalDelay(long long int routerID)
+long long int AsyncConfig::sampleStFinalDelay(long long int routerID)
 {
     if (isAsync[routerID])
     {
-        long long int temp = sTFinalDelayRandomDistribution[routerID](sTFinalDelayRandomGenerator[routerID]);
+        long long int temp = sTFinalDelaySampler[routerID]->Sample();
 
         if (temp >= 1)
         {
@@ -805,3 +871,36 @@ long long int AsyncConfig::getSwAllocDelay(long long int routerID)
 
     return delay;
 };
+
+void AsyncConfig::Serialize(Checkpoint &cp)
+{
+    vector<DelaySampler *> *const samplers[] = {&creditDelaySampler, &routingDelaySampler,
+                                                &VCAllocDelaySampler, &SwAllocDelaySampler,
+                                                &sTFinalDelaySampler, &thresholdPenaltySampler};
+    for (unsigned long long int s = 0; s < sizeof(samplers) / sizeof(samplers[0]); s++)
+    {
+        cp.Check(samplers[s]->size(), "delay samplers");
+        for (unsigned long long int i = 0; i < samplers[s]->size(); i++)
+        {
+            (*samplers[s])[i]->Serialize(cp);
+        }
+    }
+    cp.Io(metaStableRng);
+    cp.Io(previousSwitchAllocation);
+
+    cp.Io(routerSleepThreshold);
+    cp.Io(viableIdleTicksSum);
+    cp.Io(viableIdleTimesSum);
+    cp.Io(viableGatedTicksSum);
+    cp.Io(gatedTimesSum);
+    cp.Io(idleTicksTotal);
+    cp.Io(gatedTicksTotal);
+
+    cp.Io(netraceInterCycle);
+
+    cp.Io(queueTicks);
+    cp.Io(routeTicks);
+    cp.Io(vcaTicks);
+    cp.Io(swaTicks);
+    cp.Io(crossbarTicks);
+}
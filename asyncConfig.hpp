@@ -14,42 +14,32 @@
 #include <map>
 #include <list>
 #include <fstream>
-#include <chrono>
-#include <random>
 
 #include "config_utils.hpp"
 #include "booksim_config.hpp"
 #include "globals.hpp"
+#include "delay_sampler.hpp"
 
 using namespace std;
 
+class Checkpoint;
+
 class AsyncConfig
 {
 
 private:
-	vector<unsigned> creditDelaySeed;
-	vector<std::default_random_engine> creditDelayRandomGenerator;
-	vector<std::normal_distribution<double>> creditDelayRandomDistribution;
-
-	vector<unsigned> routingDelaySeed;
-	vector<std::default_random_engine> routingDelayRandomGenerator;
-	vector<std::normal_distribution<double>> routingDelayRandomDistribution;
-
-	vector<unsigned> VCAllocDelaySeed;
-	vector<std::default_random_engine> VCAllocDelayRandomGenerator;
-	vector<std::normal_distribution<double>> VCAllocDelayRandomDistribution;
+	// per router delay streams, seeded from the simulation seed
+	unsigned long long int delaySeed;
+	string delaySampler;
 
-	vector<unsigned> SwAllocDelaySeed;
-	vector<std::default_random_engine> SwAllocDelayRandomGenerator;
-	vector<std::normal_distribution<double>> SwAllocDelayRandomDistribution;
+	vector<DelaySampler *> creditDelaySampler;
+	vector<DelaySampler *> routingDelaySampler;
+	vector<DelaySampler *> VCAllocDelaySampler;
+	vector<DelaySampler *> SwAllocDelaySampler;
+	vector<DelaySampler *> sTFinalDelaySampler;
 
-	vector<unsigned> sTFinalDelaySeed;
-	vector<std::default_random_engine> sTFinalDelayRandomGenerator;
-	vector<std::normal_distribution<double>> sTFinalDelayRandomDistribution;
-
-	vector<unsigned> seedMetaStable;
-	vector<std::default_random_engine> generatorMetaStable;
-	vector<std::normal_distribution<double>> distributionMetaStable;
+	vector<DelaySampler *> thresholdPenaltySampler;
+	vector<Xoshiro256> metaStableRng;
 
 	vector<vector<long long int>> previousSwitchAllocation;
 
@@ -76,6 +66,22 @@ private:
 	vector<long long int> swAllocMetaStableThresholds;
 	vector<long long int> swAllocMetaStableMaxPenality;
 
+	// how each router's delays are drawn; constant-delay routers are served
+	// from the fixed* values below without sampling
+	enum
+	{
+		CONSTANT_DELAY,
+		STOCHASTIC_DELAY,
+		METASTABLE_DELAY
+	};
+	vector<long long int> delayClass;
+
+	vector<long long int> fixedCreditDelays;
+	vector<long long int> fixedRoutingDelays;
+	vector<long long int> fixedVcAllocDelays;
+	vector<long long int> fixedSwAllocDelays;
+	vector<long long int> fixedStFinalDelays;
+
 public:
 	//for router gating
 	long long int doGating;
@@ -86,23 +92,27 @@ public:
 
 	vector<long long int> routerSleepThreshold;
 
-	vector<long long int> idleTicksCounter;
 	vector<long long int> viableIdleTicksSum;
 	vector<long long int> viableIdleTimesSum;
 
-	vector<long long int> gatedTicksCounter;
 	vector<long long int> viableGatedTicksSum;
 	vector<long long int> gatedTimesSum;
 
+	//ticks of all finished idle and gated windows; the window in progress
+	//is kept by the router
+	vector<long long int> idleTicksTotal;
+	vector<long long int> gatedTicksTotal;
+
 	//for netrace
 	long long int traceStretch;
 	long long int netraceInterCycle;
 
-	long long int queueTicks;
-	long long int routeTicks;
-	long long int vcaTicks;
-	long long int swaTicks;
-	long long int crossbarTicks;
+	//per router, so that routers stepped from different threads do not share them
+	vector<long long int> queueTicks;
+	vector<long long int> routeTicks;
+	vector<long long int> vcaTicks;
+	vector<long long int> swaTicks;
+	vector<long long int> crossbarTicks;
 
 private:
 	void init(unsigned long long int numberOfNodes, const Configuration &config);
@@ -127,18 +137,55 @@ private:
 	void readSwAllocMetaStableThresholds(const Configuration &config);
 	void readswAllocMetaStableMaxPenalities(const Configuration &config);
 
+	void classifyRouters();
+
+	long long int sampleCreditDelay(long long int routerID);
+	long long int sampleRoutingDelay(long long int routerID);
+	long long int sampleVcAllocDelay(long long int routerID);
+	long long int sampleSwAllocDelay(long long int routerID, long long int output);
+	long long int sampleStFinalDelay(long long int routerID);
+
 public:
 	AsyncConfig(const Configuration &config);
 	AsyncConfig();
-
-	long long int getCreditDelay(long long int routerID);
-	long long int getRoutingDelay(long long int routerID);
-	long long int getVcAllocDelay(long long int routerID);
-	long long int getSwAllocDelay(long long int routerID, long long int output);
-	long long int getStFinalDelay(long long int routerID);
+	~AsyncConfig();
+
+	inline long long int getCreditDelay(long long int routerID)
+	{
+		if (delayClass[routerID] == CONSTANT_DELAY)
+			return fixedCreditDelays[routerID];
+		return sampleCreditDelay(routerID);
+	}
+	inline long long int getRoutingDelay(long long int routerID)
+	{
+		if (delayClass[routerID] == CONSTANT_DELAY)
+			return fixedRoutingDelays[routerID];
+		return sampleRoutingDelay(routerID);
+	}
+	inline long long int getVcAllocDelay(long long int routerID)
+	{
+		if (delayClass[routerID] == CONSTANT_DELAY)
+			return fixedVcAllocDelays[routerID];
+		return sampleVcAllocDelay(routerID);
+	}
+	inline long long int getSwAllocDelay(long long int routerID, long long int output)
+	{
+		if (delayClass[routerID] == CONSTANT_DELAY)
+			return fixedSwAllocDelays[routerID];
+		return sampleSwAllocDelay(routerID, output);
+	}
+	inline long long int getStFinalDelay(long long int routerID)
+	{
+		if (delayClass[routerID] == CONSTANT_DELAY)
+			return fixedStFinalDelays[routerID];
+		return sampleStFinalDelay(routerID);
+	}
 	long long int getSwAllocDelay(long long int routerID);
+
+	// delay streams and the per router gating and pipeline counters
+	void Serialize(Checkpoint &cp);
 };
 
-extern AsyncConfig *asyncConfig;
+extern thread_local AsyncConfig *asyncConfig;
 
 #endif
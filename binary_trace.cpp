@@ -0,0 +1,381 @@
+// $Id$
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+
+#include "binary_trace.hpp"
+
+using namespace std;
+
+static char const _magic[8] = {'B', 'K', 'S', 'M', 'T', 'R', 'C', '1'};
+static unsigned int const _version = 1;
+static size_t const _header_size = 8 + 4 + 4 + 8 + 8 + 8;
+static size_t const _block_header_size = 4 + 4 + 4;
+
+// number of decoded blocks the prefetch thread may run ahead
+static size_t const _prefetch_depth = 4;
+
+static void _PutU32(unsigned char *p, unsigned int v)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+}
+
+static void _PutU64(unsigned char *p, unsigned long long int v)
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+}
+
+static unsigned int _GetU32(unsigned char const *p)
+{
+  unsigned int v = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    v |= (unsigned int)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static unsigned long long int _GetU64(unsigned char const *p)
+{
+  unsigned long long int v = 0;
+  for (int i = 0; i < 8; ++i)
+  {
+    v |= (unsigned long long int)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static void _PutVarint(vector<unsigned char> &buf, long long int v)
+{
+  unsigned long long int z = ((unsigned long long int)v << 1) ^ (unsigned long long int)(v >> 63);
+  while (z >= 0x80)
+  {
+    buf.push_back((unsigned char)(z | 0x80));
+    z >>= 7;
+  }
+  buf.push_back((unsigned char)z);
+}
+
+static bool _GetVarint(unsigned char const *&p, unsigned char const *end, long long int &v)
+{
+  unsigned long long int z = 0;
+  int shift = 0;
+  while (p < end)
+  {
+    unsigned char const b = *p++;
+    z |= (unsigned long long int)(b & 0x7f) << shift;
+    if (!(b & 0x80))
+    {
+      v = (long long int)(z >> 1) ^ -(long long int)(z & 1);
+      return true;
+    }
+    shift += 7;
+    if (shift >= 64)
+    {
+      break;
+    }
+  }
+  return false;
+}
+
+BinaryTraceWriter::BinaryTraceWriter(string const &filename, unsigned int block_records)
+    : _block_records(block_records), _records(0)
+{
+  _file.open(filename.c_str(), ios::binary | ios::trunc);
+  if (!_file.is_open())
+  {
+    cerr << "Unable to open trace file for writing: " << filename << endl;
+    exit(-1);
+  }
+  _block.reserve(_block_records);
+  // placeholder, rewritten once the index location is known
+  _WriteHeader(0);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter()
+{
+  Close();
+}
+
+void BinaryTraceWriter::Write(TraceRecord const &r)
+{
+  _block.push_back(r);
+  ++_records;
+  if (_block.size() == _block_records)
+  {
+    _FlushBlock();
+  }
+}
+
+void BinaryTraceWriter::_FlushBlock()
+{
+  if (_block.empty())
+  {
+    return;
+  }
+  vector<unsigned char> raw;
+  raw.reserve(_block.size() * 8);
+  long long int source = 0;
+  for (size_t i = 0; i < _block.size(); ++i)
+  {
+    TraceRecord const &r = _block[i];
+    _PutVarint(raw, r.delay);
+    _PutVarint(raw, r.source - source);
+    _PutVarint(raw, r.dest - r.source);
+    _PutVarint(raw, r.type);
+    source = r.source;
+  }
+
+  uLongf packed_size = compressBound(raw.size());
+  vector<unsigned char> packed(_block_header_size + packed_size);
+  if (compress2(&packed[_block_header_size], &packed_size, &raw[0], raw.size(), Z_BEST_SPEED) != Z_OK)
+  {
+    cerr << "Failed to compress trace block " << _index.size() << endl;
+    exit(-1);
+  }
+  _PutU32(&packed[0], (unsigned int)packed_size);
+  _PutU32(&packed[4], (unsigned int)raw.size());
+  _PutU32(&packed[8], (unsigned int)_block.size());
+
+  _index.push_back((unsigned long long int)_file.tellp());
+  _file.write((char const *)&packed[0], _block_header_size + packed_size);
+  _block.clear();
+}
+
+void BinaryTraceWriter::_WriteHeader(unsigned long long int index_offset)
+{
+  unsigned char header[_header_size];
+  memcpy(header, _magic, 8);
+  _PutU32(header + 8, _version);
+  _PutU32(header + 12, _block_records);
+  _PutU64(header + 16, _records);
+  _PutU64(header + 24, _index.size());
+  _PutU64(header + 32, index_offset);
+  _file.write((char const *)header, _header_size);
+}
+
+void BinaryTraceWriter::Close()
+{
+  if (!_file.is_open())
+  {
+    return;
+  }
+  _FlushBlock();
+
+  unsigned long long int const index_offset = (unsigned long long int)_file.tellp();
+  for (size_t b = 0; b < _index.size(); ++b)
+  {
+    unsigned char entry[8];
+    _PutU64(entry, _index[b]);
+    _file.write((char const *)entry, 8);
+  }
+
+  _file.seekp(0);
+  _WriteHeader(index_offset);
+  _file.close();
+}
+
+bool BinaryTraceReader::IsBinaryTrace(string const &filename)
+{
+  ifstream file(filename.c_str(), ios::binary);
+  char magic[8];
+  return file.read(magic, 8) && !memcmp(magic, _magic, 8);
+}
+
+BinaryTraceReader::BinaryTraceReader(string const &filename)
+    : _filename(filename), _pos(0), _exhausted(false),
+      _producer_done(true), _stop(false), _corrupt_block(-1)
+{
+  ifstream file(filename.c_str(), ios::binary);
+  unsigned char header[_header_size];
+  if (!file.read((char *)header, _header_size) || memcmp(header, _magic, 8))
+  {
+    cerr << "Not a binary trace file: " << filename << endl;
+    exit(-1);
+  }
+  if (_GetU32(header + 8) != _version)
+  {
+    cerr << "Unsupported binary trace version " << _GetU32(header + 8)
+         << " in " << filename << endl;
+    exit(-1);
+  }
+  _block_records = _GetU32(header + 12);
+  _records = _GetU64(header + 16);
+  unsigned long long int const blocks = _GetU64(header + 24);
+  unsigned long long int const index_offset = _GetU64(header + 32);
+
+  vector<unsigned char> index(blocks * 8);
+  file.seekg(index_offset);
+  if (blocks && !file.read((char *)&index[0], index.size()))
+  {
+    cerr << "Truncated block index in binary trace: " << filename << endl;
+    exit(-1);
+  }
+  _index.resize(blocks);
+  for (size_t b = 0; b < blocks; ++b)
+  {
+    _index[b] = _GetU64(&index[8 * b]);
+  }
+}
+
+BinaryTraceReader::~BinaryTraceReader()
+{
+  _StopPrefetch();
+}
+
+void BinaryTraceReader::_Produce(size_t first_block)
+{
+  ifstream file(_filename.c_str(), ios::binary);
+  vector<unsigned char> packed;
+  vector<unsigned char> raw;
+  for (size_t b = first_block; b < _index.size(); ++b)
+  {
+    unsigned char header[_block_header_size];
+    file.seekg(_index[b]);
+    if (!file.read((char *)header, _block_header_size))
+    {
+      _Corrupt(b);
+      return;
+    }
+    uLongf const packed_size = _GetU32(header);
+    uLongf raw_size = _GetU32(header + 4);
+    unsigned int const count = _GetU32(header + 8);
+    packed.resize(packed_size);
+    raw.resize(raw_size);
+    if (!file.read((char *)&packed[0], packed_size) ||
+        (uncompress(&raw[0], &raw_size, &packed[0], packed_size) != Z_OK))
+    {
+      _Corrupt(b);
+      return;
+    }
+
+    vector<TraceRecord> block(count);
+    unsigned char const *p = &raw[0];
+    unsigned char const *const end = p + raw_size;
+    long long int source = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      TraceRecord &r = block[i];
+      long long int dsource, ddest;
+      if (!_GetVarint(p, end, r.delay) || !_GetVarint(p, end, dsource) ||
+          !_GetVarint(p, end, ddest) || !_GetVarint(p, end, r.type))
+      {
+        _Corrupt(b);
+        return;
+      }
+      r.source = source + dsource;
+      r.dest = r.source + ddest;
+      source = r.source;
+    }
+
+    unique_lock<mutex> guard(_lock);
+    _cond.wait(guard, [this] { return _stop || (_ready.size() < _prefetch_depth); });
+    if (_stop)
+    {
+      return;
+    }
+    _ready.push_back(vector<TraceRecord>());
+    _ready.back().swap(block);
+    _cond.notify_all();
+  }
+  lock_guard<mutex> guard(_lock);
+  _producer_done = true;
+  _cond.notify_all();
+}
+
+void BinaryTraceReader::_Corrupt(size_t block)
+{
+  lock_guard<mutex> guard(_lock);
+  _corrupt_block = block;
+  _producer_done = true;
+  _cond.notify_all();
+}
+
+void BinaryTraceReader::_StartPrefetch(size_t first_block)
+{
+  _ready.clear();
+  _stop = false;
+  _producer_done = false;
+  _corrupt_block = -1;
+  _prefetch = thread(&BinaryTraceReader::_Produce, this, first_block);
+}
+
+void BinaryTraceReader::_StopPrefetch()
+{
+  if (_prefetch.joinable())
+  {
+    {
+      lock_guard<mutex> guard(_lock);
+      _stop = true;
+      _cond.notify_all();
+    }
+    _prefetch.join();
+  }
+  _ready.clear();
+  _producer_done = true;
+}
+
+bool BinaryTraceReader::_NextBlock()
+{
+  unique_lock<mutex> guard(_lock);
+  _cond.wait(guard, [this] { return !_ready.empty() || _producer_done; });
+  if (_ready.empty())
+  {
+    if (_corrupt_block >= 0)
+    {
+      cerr << "Corrupt block " << _corrupt_block << " in binary trace: " << _filename << endl;
+      exit(-1);
+    }
+    return false;
+  }
+  _current.swap(_ready.front());
+  _ready.pop_front();
+  _pos = 0;
+  _cond.notify_all();
+  return true;
+}
+
+void BinaryTraceReader::Seek(unsigned long long int n)
+{
+  _StopPrefetch();
+  _current.clear();
+  _pos = 0;
+  _exhausted = (n >= _records);
+  if (_exhausted)
+  {
+    return;
+  }
+  _StartPrefetch((size_t)(n / _block_records));
+  if (!_NextBlock())
+  {
+    _exhausted = true;
+    return;
+  }
+  _pos = (size_t)(n % _block_records);
+}
+
+bool BinaryTraceReader::Next(TraceRecord &r)
+{
+  if (_exhausted)
+  {
+    return false;
+  }
+  if (_pos == _current.size())
+  {
+    if (!_NextBlock())
+    {
+      _exhausted = true;
+      return false;
+    }
+  }
+  r = _current[_pos++];
+  return true;
+}
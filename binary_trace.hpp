@@ -0,0 +1,103 @@
+// $Id$
+
+#ifndef _BINARY_TRACE_HPP_
+#define _BINARY_TRACE_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// One "delay source dest type" tuple of a trace workload.
+struct TraceRecord
+{
+  long long int delay;
+  long long int source;
+  long long int dest;
+  long long int type;
+};
+
+// Binary trace layout (all integers little-endian):
+//
+//   header   magic[8] "BKSMTRC1", u32 version, u32 records per block,
+//            u64 record count, u64 block count, u64 index offset
+//   blocks   u32 compressed size, u32 raw size, u32 record count, followed
+//            by the zlib-compressed record stream
+//   index    u64 file offset of every block
+//
+// Inside a block each record is four zigzag varints: the delay, the source
+// minus the previous record's source, the destination minus the source and
+// the type. Since every block holds the same number of records, record n
+// lives in block n / records-per-block, which makes skipping O(1).
+class BinaryTraceWriter
+{
+  ofstream _file;
+  unsigned int _block_records;
+  unsigned long long int _records;
+  vector<unsigned long long int> _index;
+
+  vector<TraceRecord> _block;
+
+  void _FlushBlock();
+  void _WriteHeader(unsigned long long int index_offset);
+
+public:
+  BinaryTraceWriter(string const &filename, unsigned int block_records = 16384);
+  ~BinaryTraceWriter();
+
+  void Write(TraceRecord const &r);
+  void Close();
+};
+
+// Reads a binary trace. Blocks are read and decompressed ahead of the
+// consumer by a background thread, so the simulator only pays for copying
+// decoded records out of the current block.
+class BinaryTraceReader
+{
+  string _filename;
+  unsigned int _block_records;
+  unsigned long long int _records;
+  vector<unsigned long long int> _index;
+
+  // decoded block being consumed
+  vector<TraceRecord> _current;
+  size_t _pos;
+  bool _exhausted;
+
+  // prefetch thread state, guarded by _lock. A corrupt block ends the
+  // prefetch; the consumer reports it once the blocks before it are used up
+  thread _prefetch;
+  mutex _lock;
+  condition_variable _cond;
+  deque<vector<TraceRecord>> _ready;
+  bool _producer_done;
+  bool _stop;
+  long long int _corrupt_block;
+
+  void _Produce(size_t first_block);
+  void _Corrupt(size_t block);
+  void _StartPrefetch(size_t first_block);
+  void _StopPrefetch();
+  bool _NextBlock();
+
+public:
+  BinaryTraceReader(string const &filename);
+  ~BinaryTraceReader();
+
+  // position the reader on record n; positions past the end leave the
+  // reader at the end of the trace
+  void Seek(unsigned long long int n);
+  bool Next(TraceRecord &r);
+
+  inline unsigned long long int Records() const { return _records; }
+
+  // true if the file starts with the binary trace magic
+  static bool IsBinaryTrace(string const &filename);
+};
+
+#endif
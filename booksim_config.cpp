@@ -30,6 +30,7 @@ BookSimConfig::BookSimConfig()
   _longInt_map["n"] = 2; //network dimension
   _longInt_map["c"] = 1; //concentration
   AddStrField("routing_function", "none");
+  _longInt_map["routing_table"] = 0; // precompute the routes of deterministic routing functions
 
   //simulator tries to correclty adjust latency for node/router placement
   _longInt_map["use_noc_latency"] = 1;
@@ -138,6 +139,9 @@ BookSimConfig::BookSimConfig()
 
   AddStrField("swAllocMetaStableMaxPenalities", "swAllocMetaStableMaxPenalities({1,1,1,1})");
 
+  // generator for the stage delays of async routers: std_normal | box_muller
+  AddStrField("delay_sampler", "std_normal");
+
   //==================================gating=====================================
 
   _longInt_map["doGating"] = 0;
@@ -157,6 +161,16 @@ BookSimConfig::BookSimConfig()
 
   _longInt_map["vct"] = 0;
 
+  // network kernel:
+  //   tick  - step every channel and router on every cycle
+  //   event    - only step the routers and channels that have work due
+  //   parallel - step every cycle, with the network partitioned across
+  //              sim_threads threads (0 = one per hardware thread)
+  //   pdes     - event-driven and partitioned; threads only synchronize on
+  //              cycles where some module is due
+  AddStrField("sim_kernel", "tick");
+  _longInt_map["sim_threads"] = 0;
+
   //==== Allocators ========================================
 
   AddStrField("vc_allocator", "islip");
@@ -212,6 +226,11 @@ BookSimConfig::BookSimConfig()
   _float_map["burst_beta"] = 0.5;  // burst length
   _float_map["burst_r1"] = -1.0;   // burst rate
 
+  // draw the time of every source's next packet up front instead of testing
+  // the injection process every cycle; same traffic statistics, different
+  // random stream
+  _longInt_map["skip_ahead_injection"] = 0;
+
   AddStrField("priority", "none"); // message priorities
 
   _longInt_map["batch_size"] = 1000;
@@ -226,6 +245,7 @@ BookSimConfig::BookSimConfig()
   // types:
   //   latency    - average + latency distribution for a particular injection rate
   //   throughput - sustained throughput for a particular injection rate
+  //   saturation - latency curve and saturation point, searched from injection_rate up
 
   AddStrField("sim_type", "latency");
   AddStrField("workload", "synthetic({0.1,1,bernoulli,uniform})");
@@ -235,11 +255,31 @@ BookSimConfig::BookSimConfig()
   _longInt_map["sample_period"] = 100; // how long between measurements
   _longInt_map["max_samples"] = 10;    // maximum number of sample periods in a simulation
 
+  // steady-state simulations only: write the simulation state to
+  // checkpoint_out once warm-up ends, or start from the state in
+  // checkpoint_in instead of warming up
+  AddStrField("checkpoint_out", "");
+  AddStrField("checkpoint_in", "");
+
   // whether or not to measure statistics for a given traffic class
   _longInt_map["measure_stats"] = 1;
   AddStrField("measure_stats", ""); // workaround to allow for vector specification
   //whether to enable per pair statistics, caution N^2 memory usage
   _longInt_map["pair_stats"] = 0;
+  // latency histogram precision in sub-bucket bits; percentiles are within
+  // 2^(1-bits) of the exact value. Pair histograms default to a coarser one.
+  _longInt_map["hist_precision"] = 7;
+  _longInt_map["pair_hist_precision"] = 4;
+  // print the 50th/99th/99.9th percentiles with the latency stats, in the
+  // overall CSV and, with pair_stats, in stats_out
+  _longInt_map["print_percentiles"] = 0;
+  // binary dump of the latency histograms after every simulation
+  AddStrField("hist_dump", "");
+
+  // binary trace of per-router activity every activity_interval cycles,
+  // see activity_trace.hpp
+  AddStrField("activity_trace", "");
+  _longInt_map["activity_interval"] = 1000;
 
   // if avg. latency exceeds the threshold, assume unstable
   _float_map["latency_thres"] = 500.0;
@@ -257,10 +297,36 @@ BookSimConfig::BookSimConfig()
   _float_map["acc_stopping_thres"] = 0.05;
   AddStrField("acc_stopping_thres", ""); // workaround to allow for vector specification
 
+  // "change" stops after three sample periods within the thresholds above;
+  // "batch_means" measures in batches of batch_period cycles (0 = sample_period)
+  // and stops once the confidence intervals of latency and throughput are
+  // within batch_precision / acc_batch_precision of their means, or aborts
+  // once the sources keep falling behind their injection processes
+  AddStrField("stopping_rule", "change");
+  _longInt_map["batch_period"] = 0;
+  _longInt_map["min_batches"] = 10;
+  _longInt_map["max_batches"] = 1000;
+  _float_map["batch_confidence"] = 0.95;
+  _float_map["batch_precision"] = 0.02;
+  AddStrField("batch_precision", ""); // workaround to allow for vector specification
+  _float_map["acc_batch_precision"] = 0.02;
+  AddStrField("acc_batch_precision", ""); // workaround to allow for vector specification
+
+  // saturation search (sim_type = saturation): probes whose latency exceeds
+  // sat_latency_factor times the latency at injection_rate count as
+  // saturated; the search stops once the saturation rate is known to within
+  // sat_precision (relative) or after sat_max_probes probes
+  _float_map["sat_latency_factor"] = 3.0;
+  _float_map["sat_precision"] = 0.02;
+  _longInt_map["sat_max_probes"] = 16;
+
   _longInt_map["sim_count"] = 1;       // number of simulations to perform
   _longInt_map["include_queuing"] = 1; // non-zero includes source queuing latency
   _longInt_map["seed"] = 0;            //random seed for simulation, e.g. traffic
   AddStrField("seed", "");             // workaround to allow special "time" value
+  // give every source, router and injection process its own counter-based
+  // random stream, so results do not depend on the order of evaluation
+  _longInt_map["random_streams"] = 0;
   _longInt_map["print_activity"] = 0;
   _longInt_map["print_csv_results"] = 0;
   _longInt_map["deadlock_warn_timeout"] = 256;
@@ -272,6 +338,15 @@ BookSimConfig::BookSimConfig()
   AddStrField("watch_out", "");
   AddStrField("stats_out", "");
 
+  // sweep: run one simulation per line of sweep_file, each line holding
+  // parameter overrides in config file syntax; the runs are spread across
+  // sweep_threads threads (0 = one per hardware thread) and their overall
+  // stats collected in sweep_csv. Overrides must leave the topology and
+  // routing alone.
+  AddStrField("sweep_file", "");
+  _longInt_map["sweep_threads"] = 0;
+  AddStrField("sweep_csv", "sweep.csv");
+
   // batch only -- packet sequence numbers
   AddStrField("sent_packets_out", "");
 
@@ -279,6 +354,8 @@ BookSimConfig::BookSimConfig()
   _longInt_map["sim_power"] = 1;
   AddStrField("power_output_file", "pwr_tmp");
   AddStrField("tech_file", "power/techfile.txt");
+  // file keeping optimized channel wires across runs with the same technology
+  AddStrField("wire_cache", "");
   _longInt_map["channel_width"] = 64;
   _longInt_map["channel_sweep"] = 0;
 
@@ -289,6 +366,8 @@ BookSimConfig::BookSimConfig()
   // Orion Power Support
   AddStrField("orion_out", "");
   AddStrField("orion_file", "");
+  // set to 0 to skip router activity recording and the Orion power report
+  _longInt_map["orion_power"] = 1;
 
   ////power added to support Orion
   ////power added to support Orion in Flexus
@@ -5,6 +5,7 @@
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "buffer.hpp"
+#include "checkpoint.hpp"
 
 Buffer::Buffer(const Configuration &config, long long int outputs,
                Module *parent, const string &name) : Module(parent, name), _occupancy(0)
@@ -53,6 +54,18 @@ void Buffer::AddFlit(long long int vc, Flit *f)
 #endif
 }
 
+void Buffer::Serialize(Checkpoint &cp)
+{
+  cp.Io(_occupancy);
+#ifdef TRACK_BUFFERS
+  cp.Io(_class_occupancy);
+#endif
+  for (vector<VC *>::iterator iter = _vc.begin(); iter != _vc.end(); ++iter)
+  {
+    (*iter)->Serialize(cp);
+  }
+}
+
 void Buffer::Display(ostream &os) const
 {
   for (vector<VC *>::const_iterator i = _vc.begin(); i != _vc.end(); ++i)
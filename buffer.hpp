@@ -11,6 +11,8 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class Buffer : public Module
 {
 
@@ -130,6 +132,8 @@ public:
   }
 #endif
 
+  void Serialize(Checkpoint &cp);
+
   void Display(ostream &os = cout) const;
 };
 
@@ -14,6 +14,7 @@
 
 #include "booksim.hpp"
 #include "buffer_state.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 #include "globals.hpp"
 
@@ -717,6 +718,49 @@ void BufferState::TakeBuffer(long long int vc, long long int tag)
   _buffer_policy->TakeBuffer(vc);
 }
 
+void BufferState::SharedBufferPolicy::Serialize(Checkpoint &cp)
+{
+  cp.Io(_private_buf_occupancy);
+  cp.Io(_shared_buf_occupancy);
+  cp.Io(_reserved_slots);
+}
+
+void BufferState::LimitedSharedBufferPolicy::Serialize(Checkpoint &cp)
+{
+  SharedBufferPolicy::Serialize(cp);
+  cp.Io(_active_vcs);
+}
+
+void BufferState::FeedbackSharedBufferPolicy::Serialize(Checkpoint &cp)
+{
+  SharedBufferPolicy::Serialize(cp);
+  cp.Io(_occupancy_limit);
+  cp.Io(_round_trip_time);
+  cp.Io(_flit_sent_time);
+  cp.Io(_min_latency);
+}
+
+void BufferState::SimpleFeedbackSharedBufferPolicy::Serialize(Checkpoint &cp)
+{
+  FeedbackSharedBufferPolicy::Serialize(cp);
+  cp.Io(_pending_credits);
+}
+
+void BufferState::Serialize(Checkpoint &cp)
+{
+  cp.Io(_occupancy);
+  cp.Io(_vc_occupancy);
+  cp.Io(_in_use_by);
+  cp.Io(_tail_sent);
+  cp.Io(_last_id);
+  cp.Io(_last_pid);
+#ifdef TRACK_BUFFERS
+  cp.Io(_outstanding_classes);
+  cp.Io(_class_occupancy);
+#endif
+  _buffer_policy->Serialize(cp);
+}
+
 void BufferState::Display(ostream &os) const
 {
   os << FullName() << " :" << endl;
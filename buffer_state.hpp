@@ -11,6 +11,8 @@
 #include "credit.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class BufferState : public Module
 {
 
@@ -29,6 +31,7 @@ class BufferState : public Module
     virtual bool IsFullFor(long long int vc = 0) const = 0;
     virtual long long int AvailableFor(long long int vc = 0) const = 0;
     virtual long long int LimitFor(long long int vc = 0) const = 0;
+    virtual void Serialize(Checkpoint &cp) {}
 
     static BufferPolicy *New(Configuration const &config,
                              BufferState *parent, const string &name);
@@ -68,6 +71,7 @@ class BufferState : public Module
     virtual bool IsFullFor(long long int vc = 0) const;
     virtual long long int AvailableFor(long long int vc = 0) const;
     virtual long long int LimitFor(long long int vc = 0) const;
+    virtual void Serialize(Checkpoint &cp);
   };
 
   class LimitedSharedBufferPolicy : public SharedBufferPolicy
@@ -86,6 +90,7 @@ class BufferState : public Module
     virtual bool IsFullFor(long long int vc = 0) const;
     virtual long long int AvailableFor(long long int vc = 0) const;
     virtual long long int LimitFor(long long int vc = 0) const;
+    virtual void Serialize(Checkpoint &cp);
   };
 
   class DynamicLimitedSharedBufferPolicy : public LimitedSharedBufferPolicy
@@ -132,6 +137,7 @@ class BufferState : public Module
     virtual bool IsFullFor(long long int vc = 0) const;
     virtual long long int AvailableFor(long long int vc = 0) const;
     virtual long long int LimitFor(long long int vc = 0) const;
+    virtual void Serialize(Checkpoint &cp);
   };
 
   class SimpleFeedbackSharedBufferPolicy : public FeedbackSharedBufferPolicy
@@ -144,6 +150,7 @@ class BufferState : public Module
                                      BufferState *parent, const string &name);
     virtual void SendingFlit(Flit const *const f);
     virtual void FreeSlotFor(long long int vc = 0);
+    virtual void Serialize(Checkpoint &cp);
   };
 
   bool _wait_for_tail_credit;
@@ -233,6 +240,8 @@ public:
   }
 #endif
 
+  void Serialize(Checkpoint &cp);
+
   void Display(ostream &os = cout) const;
 };
 
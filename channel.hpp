@@ -13,11 +13,14 @@
 #define _CHANNEL_HPP
 
 #include <queue>
+#include <limits>
+#include <algorithm>
 #include <cassert>
 
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -42,6 +45,12 @@ public:
   virtual void Evaluate() {}
   virtual void WriteOutputs();
 
+  virtual long long int NextEventTime() const;
+  virtual bool HasOutput() const { return _output; }
+
+  // data in flight, including what was presented to the reader this cycle
+  virtual void Serialize(Checkpoint &cp);
+
 protected:
   long long int _delay;
   T *_input;
@@ -107,4 +116,26 @@ void Channel<T>::WriteOutputs()
   _wait_queue.pop();
 }
 
+template <typename T>
+long long int Channel<T>::NextEventTime() const
+{
+  if (_input || _output)
+  {
+    return GetSimTime() + 1;
+  }
+  if (_wait_queue.empty())
+  {
+    return numeric_limits<long long int>::max();
+  }
+  return max(_wait_queue.front().first, GetSimTime() + 1);
+}
+
+template <typename T>
+void Channel<T>::Serialize(Checkpoint &cp)
+{
+  cp.Io(_input);
+  cp.Io(_output);
+  cp.Io(_wait_queue);
+}
+
 #endif
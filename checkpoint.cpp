@@ -0,0 +1,182 @@
+// $Id$
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+#include "checkpoint.hpp"
+#include "flit.hpp"
+#include "credit.hpp"
+
+static char const _magic[8] = {'B', 'K', 'S', 'M', 'C', 'K', 'P', '1'};
+static unsigned int const _version = 1;
+
+Checkpoint::Checkpoint(string const &filename, eMode mode)
+    : _mode(mode), _filename(filename)
+{
+  _file.open(filename.c_str(), ios::binary | (Saving() ? (ios::out | ios::trunc) : ios::in));
+  if (!_file.is_open())
+  {
+    _Fail("unable to open file");
+  }
+  char magic[8];
+  unsigned int version = _version;
+  memcpy(magic, _magic, 8);
+  Raw(magic, 8);
+  Raw(&version, sizeof(version));
+  if (memcmp(magic, _magic, 8))
+  {
+    _Fail("not a checkpoint file");
+  }
+  if (version != _version)
+  {
+    ostringstream err;
+    err << "unsupported checkpoint version " << version;
+    _Fail(err.str());
+  }
+}
+
+Checkpoint::~Checkpoint()
+{
+  _file.close();
+  if (Saving() && _file.fail())
+  {
+    _Fail("write failed");
+  }
+}
+
+void Checkpoint::_Fail(string const &msg) const
+{
+  cerr << "Checkpoint " << _filename << ": " << msg << endl;
+  exit(-1);
+}
+
+void Checkpoint::Raw(void *data, size_t size)
+{
+  if (Saving())
+  {
+    _file.write((char const *)data, size);
+  }
+  else if (!_file.read((char *)data, size))
+  {
+    _Fail("truncated file");
+  }
+}
+
+void Checkpoint::Io(string &s)
+{
+  size_t size = s.size();
+  Io(size);
+  s.resize(size);
+  if (size)
+  {
+    Raw(&s[0], size);
+  }
+}
+
+void Checkpoint::Io(vector<bool> &v)
+{
+  size_t size = v.size();
+  Io(size);
+  v.resize(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    bool b = v[i];
+    Io(b);
+    v[i] = b;
+  }
+}
+
+bool Checkpoint::_Reference(void *&ptr)
+{
+  long long int index;
+  if (Saving())
+  {
+    if (!ptr)
+    {
+      index = -1;
+    }
+    else
+    {
+      map<void const *, long long int>::const_iterator iter = _index.find(ptr);
+      if (iter == _index.end())
+      {
+        index = _objects.size();
+        _Register(ptr);
+        Io(index);
+        return true;
+      }
+      index = iter->second;
+    }
+    Io(index);
+    return false;
+  }
+
+  Io(index);
+  if (index < 0)
+  {
+    ptr = NULL;
+    return false;
+  }
+  if (index < (long long int)_objects.size())
+  {
+    ptr = _objects[index];
+    return false;
+  }
+  if (index != (long long int)_objects.size())
+  {
+    _Fail("corrupt object reference");
+  }
+  return true;
+}
+
+void Checkpoint::_Register(void *ptr)
+{
+  _index[ptr] = _objects.size();
+  _objects.push_back(ptr);
+}
+
+void Checkpoint::Io(Flit *&f)
+{
+  void *ptr = f;
+  if (!_Reference(ptr))
+  {
+    f = (Flit *)ptr;
+    return;
+  }
+  if (Restoring())
+  {
+    f = Flit::New();
+    _Register(f);
+  }
+  f->Serialize(*this);
+}
+
+void Checkpoint::Io(Credit *&c)
+{
+  void *ptr = c;
+  if (!_Reference(ptr))
+  {
+    c = (Credit *)ptr;
+    return;
+  }
+  if (Restoring())
+  {
+    c = Credit::New();
+    _Register(c);
+  }
+  c->Serialize(*this);
+}
+
+void Checkpoint::Check(long long int value, string const &what)
+{
+  long long int saved = value;
+  Io(saved);
+  if (saved != value)
+  {
+    ostringstream err;
+    err << "saved with " << what << " = " << saved << ", but the simulation has " << value;
+    _Fail(err.str());
+  }
+}
@@ -0,0 +1,176 @@
+// $Id$
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <queue>
+#include <set>
+#include <map>
+#include <fstream>
+#include <type_traits>
+
+using namespace std;
+
+class Flit;
+class Credit;
+
+// Binary snapshot of the simulator state. Every stateful component has a
+// Serialize(Checkpoint &) method that lists its members once; the same calls
+// write the checkpoint or read it back, depending on how it was opened.
+//
+// Flits and credits are referenced from many places at once (buffers,
+// channels, the traffic manager's registries). Each one is stored in full
+// where it is first met and by index afterwards, so that after a restore the
+// pointers alias the same objects they did when the checkpoint was taken.
+class Checkpoint
+{
+public:
+  enum eMode
+  {
+    save,
+    restore
+  };
+
+private:
+  eMode _mode;
+  string _filename;
+  fstream _file;
+
+  map<void const *, long long int> _index;
+  vector<void *> _objects;
+
+  void _Fail(string const &msg) const;
+
+  // returns true if the object behind ptr has to be serialized in full
+  bool _Reference(void *&ptr);
+  void _Register(void *ptr);
+
+public:
+  Checkpoint(string const &filename, eMode mode);
+  ~Checkpoint();
+
+  inline bool Saving() const { return _mode == save; }
+  inline bool Restoring() const { return _mode == restore; }
+
+  void Raw(void *data, size_t size);
+
+  template <typename T>
+  typename enable_if<is_arithmetic<T>::value || is_enum<T>::value>::type Io(T &v)
+  {
+    Raw(&v, sizeof(T));
+  }
+
+  template <typename T>
+  typename enable_if<is_class<T>::value>::type Io(T &v)
+  {
+    v.Serialize(*this);
+  }
+
+  void Io(string &s);
+  void Io(vector<bool> &v);
+  void Io(Flit *&f);
+  void Io(Credit *&c);
+
+  template <typename A, typename B>
+  void Io(pair<A, B> &p)
+  {
+    Io(p.first);
+    Io(p.second);
+  }
+
+  template <typename T>
+  void Io(vector<T> &v)
+  {
+    size_t size = v.size();
+    Io(size);
+    v.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      Io(v[i]);
+    }
+  }
+
+  template <typename T>
+  void Io(deque<T> &d)
+  {
+    size_t size = d.size();
+    Io(size);
+    d.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      Io(d[i]);
+    }
+  }
+
+  template <typename T>
+  void Io(list<T> &l)
+  {
+    size_t size = l.size();
+    Io(size);
+    l.resize(size);
+    for (typename list<T>::iterator iter = l.begin(); iter != l.end(); ++iter)
+    {
+      Io(*iter);
+    }
+  }
+
+  template <typename T>
+  void Io(queue<T> &q)
+  {
+    deque<T> items;
+    if (Saving())
+    {
+      for (queue<T> copy = q; !copy.empty(); copy.pop())
+      {
+        items.push_back(copy.front());
+      }
+    }
+    Io(items);
+    if (Restoring())
+    {
+      q = queue<T>(items);
+    }
+  }
+
+  template <typename T>
+  void Io(set<T> &s)
+  {
+    vector<T> items(s.begin(), s.end());
+    Io(items);
+    if (Restoring())
+    {
+      s = set<T>(items.begin(), items.end());
+    }
+  }
+
+  template <typename K, typename V>
+  void Io(map<K, V> &m)
+  {
+    vector<pair<K, V>> items(m.begin(), m.end());
+    Io(items);
+    if (Restoring())
+    {
+      m = map<K, V>(items.begin(), items.end());
+    }
+  }
+
+  // fixed-size arrays owned by a component
+  template <typename T>
+  void IoArray(T *data, size_t size)
+  {
+    for (size_t i = 0; i < size; ++i)
+    {
+      Io(data[i]);
+    }
+  }
+
+  // structural parameters must match between the saving and the restoring
+  // run; the state of a differently built network cannot be restored
+  void Check(long long int value, string const &what);
+};
+
+#endif
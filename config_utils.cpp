@@ -141,6 +141,7 @@ vector<double> Configuration::GetFloatArray(string const &field) const
 
 void Configuration::ParseFile(string const &filename)
 {
+  theConfig = this;
   if ((_config_file = fopen(filename.c_str(), "r")) == 0)
   {
     cerr << "Could not open configuration file " << filename << endl;
@@ -155,6 +156,8 @@ void Configuration::ParseFile(string const &filename)
 
 void Configuration::ParseString(string const &str)
 {
+  // copies of a configuration are parsed into by sweeps
+  theConfig = this;
   _config_string = str + ';';
   yyparse();
   _config_string = "";
@@ -7,9 +7,9 @@
 
 #include "booksim.hpp"
 #include "credit.hpp"
+#include "checkpoint.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+thread_local CreditPool *Credit::_pool = 0;
 
 Credit::Credit()
 {
@@ -24,38 +24,72 @@ void Credit::Reset()
   id = -1;
 }
 
+void Credit::Serialize(Checkpoint &cp)
+{
+  cp.Io(vc);
+  cp.Io(head);
+  cp.Io(tail);
+  cp.Io(id);
+}
+
+CreditPool *Credit::GetPool()
+{
+  if (!_pool)
+  {
+    _pool = new CreditPool;
+  }
+  return _pool;
+}
+
+void Credit::SetPool(CreditPool *pool)
+{
+  _pool = pool;
+}
+
 Credit *Credit::New()
 {
+  CreditPool *const pool = GetPool();
+  lock_guard<mutex> guard(pool->lock);
   Credit *c;
-  if (_free.empty())
+  if (pool->free.empty())
   {
     c = new Credit();
-    _all.push(c);
+    pool->all.push(c);
   }
   else
   {
-    c = _free.top();
+    c = pool->free.top();
     c->Reset();
-    _free.pop();
+    pool->free.pop();
   }
   return c;
 }
 
 void Credit::Free()
 {
-  _free.push(this);
+  CreditPool *const pool = GetPool();
+  lock_guard<mutex> guard(pool->lock);
+  pool->free.push(this);
 }
 
 void Credit::FreeAll()
 {
-  while (!_all.empty())
+  if (!_pool)
+  {
+    return;
+  }
+  while (!_pool->all.empty())
   {
-    delete _all.top();
-    _all.pop();
+    delete _pool->all.top();
+    _pool->all.pop();
   }
+  delete _pool;
+  _pool = 0;
 }
 
 long long int Credit::OutStanding()
 {
-  return _all.size() - _free.size();
+  CreditPool *const pool = GetPool();
+  lock_guard<mutex> guard(pool->lock);
+  return pool->all.size() - pool->free.size();
 }
@@ -5,6 +5,20 @@
 
 #include <set>
 #include <stack>
+#include <mutex>
+
+class Credit;
+class Checkpoint;
+
+// credits are pooled per simulation; routers allocate and free them
+// concurrently under the parallel kernels, so the network's worker threads
+// share the pool of the thread running the simulation
+struct CreditPool
+{
+  stack<Credit *> all;
+  stack<Credit *> free;
+  mutex lock;
+};
 
 class Credit
 {
@@ -18,14 +32,18 @@ public:
 
   void Reset();
 
+  void Serialize(Checkpoint &cp);
+
   static Credit *New();
   void Free();
   static void FreeAll();
   static long long int OutStanding();
 
+  static CreditPool *GetPool();
+  static void SetPool(CreditPool *pool);
+
 private:
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  static thread_local CreditPool *_pool;
 
   Credit();
   ~Credit() {}
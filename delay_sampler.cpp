@@ -0,0 +1,132 @@
+// $Id$
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+#include "delay_sampler.hpp"
+#include "checkpoint.hpp"
+
+using namespace std;
+
+static long long int const _batch_size = 64;
+
+// splitmix64, used to spread a seed over the generator state
+static unsigned long long int _SplitMix(unsigned long long int &x)
+{
+  unsigned long long int z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void Xoshiro256::Seed(unsigned long long int seed)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    _s[i] = _SplitMix(seed);
+  }
+}
+
+void Xoshiro256::Serialize(Checkpoint &cp)
+{
+  cp.IoArray(_s, 4);
+}
+
+unsigned long long int Xoshiro256::StreamSeed(unsigned long long int seed, long long int router, long long int stream)
+{
+  unsigned long long int x = seed;
+  unsigned long long int const a = _SplitMix(x);
+  x = a ^ (unsigned long long int)router;
+  unsigned long long int const b = _SplitMix(x);
+  x = b ^ (unsigned long long int)stream;
+  return _SplitMix(x);
+}
+
+DelaySampler::DelaySampler(double mean, double std_dev)
+    : _mean(mean), _std_dev(std_dev), _batch(_batch_size), _next(_batch_size)
+{
+}
+
+void DelaySampler::Serialize(Checkpoint &cp)
+{
+  cp.Io(_batch);
+  cp.Io(_next);
+}
+
+DelaySampler *DelaySampler::New(const string &type, double mean, double std_dev, unsigned long long int seed)
+{
+  DelaySampler *s = NULL;
+  if (type == "box_muller")
+  {
+    s = new BoxMullerDelaySampler(mean, std_dev, seed);
+  }
+  else if (type == "std_normal")
+  {
+    s = new StdNormalDelaySampler(mean, std_dev, seed);
+  }
+  else
+  {
+    cerr << "Unknown delay sampler: " << type << endl;
+    exit(-1);
+  }
+  return s;
+}
+
+BoxMullerDelaySampler::BoxMullerDelaySampler(double mean, double std_dev, unsigned long long int seed)
+    : DelaySampler(mean, std_dev), _rng(seed)
+{
+}
+
+void BoxMullerDelaySampler::_Fill()
+{
+  double u[_batch_size];
+  for (long long int i = 0; i < _batch_size; ++i)
+  {
+    u[i] = _rng.NextDouble();
+  }
+  // each pair of uniforms gives two independent normal samples
+  for (long long int i = 0; i < _batch_size; i += 2)
+  {
+    double const r = sqrt(-2.0 * log(u[i]));
+    double const theta = 2.0 * M_PI * u[i + 1];
+    _batch[i] = _mean + _std_dev * r * cos(theta);
+    _batch[i + 1] = _mean + _std_dev * r * sin(theta);
+  }
+}
+
+StdNormalDelaySampler::StdNormalDelaySampler(double mean, double std_dev, unsigned long long int seed)
+    : DelaySampler(mean, std_dev), _rng(seed), _dist(mean, std_dev)
+{
+}
+
+void StdNormalDelaySampler::_Fill()
+{
+  for (long long int i = 0; i < _batch_size; ++i)
+  {
+    _batch[i] = _dist(_rng);
+  }
+}
+
+void BoxMullerDelaySampler::Serialize(Checkpoint &cp)
+{
+  DelaySampler::Serialize(cp);
+  cp.Io(_rng);
+}
+
+void StdNormalDelaySampler::Serialize(Checkpoint &cp)
+{
+  DelaySampler::Serialize(cp);
+  // the standard library only exposes its engine and distribution state
+  // through streams
+  ostringstream out;
+  out << _rng << ' ' << _dist;
+  string state = out.str();
+  cp.Io(state);
+  if (cp.Restoring())
+  {
+    istringstream in(state);
+    in >> _rng >> _dist;
+  }
+}
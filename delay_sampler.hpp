@@ -0,0 +1,118 @@
+// $Id$
+
+#ifndef _DELAY_SAMPLER_HPP_
+#define _DELAY_SAMPLER_HPP_
+
+#include <string>
+#include <vector>
+#include <random>
+
+#include "config_utils.hpp"
+
+using namespace std;
+
+class Checkpoint;
+
+// xoshiro256** generator: 32 bytes of state and a handful of shifts per
+// draw, so every router and pipeline stage can own an independent stream
+class Xoshiro256
+{
+  unsigned long long int _s[4];
+
+  static inline unsigned long long int _Rotl(unsigned long long int x, int k)
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+
+public:
+  Xoshiro256(unsigned long long int seed = 0) { Seed(seed); }
+
+  void Seed(unsigned long long int seed);
+
+  inline unsigned long long int Next()
+  {
+    unsigned long long int const result = _Rotl(_s[1] * 5, 7) * 9;
+    unsigned long long int const t = _s[1] << 17;
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+    _s[2] ^= t;
+    _s[3] = _Rotl(_s[3], 45);
+    return result;
+  }
+
+  // uniform in (0,1]
+  inline double NextDouble()
+  {
+    return ((Next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+  }
+
+  void Serialize(Checkpoint &cp);
+
+  // seed for one stream of one router, derived from the simulation seed
+  static unsigned long long int StreamSeed(unsigned long long int seed, long long int router, long long int stream);
+};
+
+// Draws normally distributed stage delays for one router and stage. Samples
+// are produced a batch at a time into a small buffer, so the per-request cost
+// is a load and an index bump.
+class DelaySampler
+{
+protected:
+  double _mean;
+  double _std_dev;
+  vector<double> _batch;
+  size_t _next;
+
+  virtual void _Fill() = 0;
+
+public:
+  DelaySampler(double mean, double std_dev);
+  virtual ~DelaySampler() {}
+
+  inline double Sample()
+  {
+    if (_next == _batch.size())
+    {
+      _Fill();
+      _next = 0;
+    }
+    return _batch[_next++];
+  }
+
+  // generator state and the undrawn part of the current batch
+  virtual void Serialize(Checkpoint &cp);
+
+  static DelaySampler *New(const string &type, double mean, double std_dev, unsigned long long int seed);
+};
+
+// Box-Muller transform over a xoshiro256** stream; cheaper per sample, but
+// its draws differ from std_normal
+class BoxMullerDelaySampler : public DelaySampler
+{
+  Xoshiro256 _rng;
+
+  virtual void _Fill();
+
+public:
+  BoxMullerDelaySampler(double mean, double std_dev, unsigned long long int seed);
+
+  virtual void Serialize(Checkpoint &cp);
+};
+
+// the standard library's normal distribution, the default
+class StdNormalDelaySampler : public DelaySampler
+{
+  mt19937_64 _rng;
+  normal_distribution<double> _dist;
+
+  virtual void _Fill();
+
+public:
+  StdNormalDelaySampler(double mean, double std_dev, unsigned long long int seed);
+
+  virtual void Serialize(Checkpoint &cp);
+};
+
+#endif
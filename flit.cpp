@@ -11,11 +11,17 @@
 
 #include "booksim.hpp"
 #include "flit.hpp"
+#include "checkpoint.hpp"
 // Orion Power Support
 #include "globals.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+thread_local vector<Flit *> Flit::_blocks;
+thread_local stack<Flit *> Flit::_free;
+thread_local vector<Flit::sCold *> Flit::_cold_blocks;
+thread_local stack<Flit::sCold *> Flit::_cold_free;
+
+// route set of flits without a cold record
+static OutputSet const _no_route_set;
 
 ostream &operator<<(ostream &os, const Flit &f)
 {
@@ -30,7 +36,7 @@ ostream &operator<<(ostream &os, const Flit &f)
   return os;
 }
 
-Flit::Flit()
+Flit::Flit() : _cold(NULL)
 {
   Reset();
 }
@@ -55,27 +61,97 @@ void Flit::Reset()
   pri = 0;
   intm = -1;
   ph = -1;
-  data = 0;
+  if (_cold)
+  {
+    _cold_free.push(_cold);
+    _cold = NULL;
+  }
   //  ib_time = 2;	//Sneha
   //  rc_time = 2;	//Sneha
   //  vc_time = 2;	//Sneha
   //  sw_time = 2;	//Sneha
 }
 
-Flit *Flit::New()
+Flit::sCold &Flit::_Cold()
 {
-  Flit *f;
-  if (_free.empty())
+  if (!_cold)
   {
-    f = new Flit;
-    _all.push(f);
+    if (_cold_free.empty())
+    {
+      sCold *const block = new sCold[_block_size];
+      _cold_blocks.push_back(block);
+      for (long long int i = _block_size - 1; i >= 0; --i)
+      {
+        _cold_free.push(&block[i]);
+      }
+    }
+    _cold = _cold_free.top();
+    _cold_free.pop();
+    _cold->la_route_set.Clear();
   }
-  else
+  return *_cold;
+}
+
+OutputSet &Flit::LaRouteSet()
+{
+  return _Cold().la_route_set;
+}
+
+OutputSet const &Flit::LaRouteSet() const
+{
+  return _cold ? _cold->la_route_set : _no_route_set;
+}
+
+void Flit::ClearLaRouteSet()
+{
+  if (_cold)
   {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
+    _cold->la_route_set.Clear();
+  }
+}
+
+void Flit::Serialize(Checkpoint &cp)
+{
+  cp.Io(vc);
+  cp.Io(cl);
+  cp.Io(src);
+  cp.Io(dest);
+  cp.Io(id);
+  cp.Io(pid);
+  cp.Io(pri);
+  cp.Io(head);
+  cp.Io(tail);
+  cp.Io(record);
+  cp.Io(watch);
+  cp.Io(hops);
+  cp.Io(ctime);
+  cp.Io(itime);
+  cp.Io(atime);
+  cp.Io(intm);
+  cp.Io(ph);
+  bool cold = (_cold != NULL);
+  cp.Io(cold);
+  if (cold)
+  {
+    cp.Io(_Cold().la_route_set);
+  }
+}
+
+Flit *Flit::New()
+{
+  if (_free.empty())
+  {
+    Flit *const block = new Flit[_block_size];
+    _blocks.push_back(block);
+    // hand out the block front to back
+    for (long long int i = _block_size - 1; i >= 0; --i)
+    {
+      _free.push(&block[i]);
+    }
   }
+  Flit *const f = _free.top();
+  f->Reset();
+  _free.pop();
   // Orion Power Support
   g_number_of_injected_flits++;
 
@@ -84,14 +160,36 @@ Flit *Flit::New()
 
 void Flit::Free()
 {
+  if (_cold)
+  {
+    _cold_free.push(_cold);
+    _cold = NULL;
+  }
   _free.push(this);
 }
 
 void Flit::FreeAll()
 {
-  while (!_all.empty())
+  for (vector<Flit *>::const_iterator iter = _blocks.begin();
+       iter != _blocks.end();
+       ++iter)
+  {
+    delete[] *iter;
+  }
+  _blocks.clear();
+  while (!_free.empty())
+  {
+    _free.pop();
+  }
+  for (vector<sCold *>::const_iterator iter = _cold_blocks.begin();
+       iter != _cold_blocks.end();
+       ++iter)
+  {
+    delete[] *iter;
+  }
+  _cold_blocks.clear();
+  while (!_cold_free.empty())
   {
-    delete _all.top();
-    _all.pop();
+    _cold_free.pop();
   }
 }
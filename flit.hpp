@@ -5,38 +5,40 @@
 
 #include <iostream>
 #include <stack>
+#include <vector>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+class Checkpoint;
+
 class Flit
 {
 
 public:
+  // the fields that every pipeline stage reads come first and share a cache
+  // line with the flags
   long long int vc;
-
   long long int cl;
 
-  bool head;
-  bool tail;
-
-  long long int ctime;
-  long long int itime;
-  long long int atime;
+  long long int src;
+  long long int dest;
 
   long long int id;
   long long int pid;
 
-  bool record;
-
-  long long int src;
-  long long int dest;
-
   long long int pri;
 
-  long long int hops;
+  bool head;
+  bool tail;
+  bool record;
   bool watch;
-  long long int starttime;
+
+  long long int hops;
+
+  long long int ctime;
+  long long int itime;
+  long long int atime;
 
   //  long long int ib_time;		//Sneha
   //  long long int rc_time;		//Sneha
@@ -49,14 +51,16 @@ public:
   // phase in multi-phase algorithms
   mutable long long int ph;
 
-  // Fields for arbitrary data
-  void *data;
-
-  // Lookahead route info
-  OutputSet la_route_set;
+  // Lookahead route info, only carried by head flits under lookahead routing.
+  // The non-const accessor gives the flit a cold record if it has none.
+  OutputSet &LaRouteSet();
+  OutputSet const &LaRouteSet() const;
+  void ClearLaRouteSet();
 
   void Reset();
 
+  void Serialize(Checkpoint &cp);
+
   static Flit *New();
   void Free();
   static void FreeAll();
@@ -65,8 +69,24 @@ private:
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  // the data few flits need lives in a side pool, so that a flit in flight
+  // only holds the fields above
+  struct sCold
+  {
+    OutputSet la_route_set;
+  };
+  sCold *_cold;
+
+  sCold &_Cold();
+
+  // flits are only handled by the thread running the traffic manager, so
+  // each simulation in a sweep keeps its own pools. The pools grow by whole
+  // blocks, which keeps the flits in flight close together in memory.
+  static long long int const _block_size = 256;
+  static thread_local vector<Flit *> _blocks;
+  static thread_local stack<Flit *> _free;
+  static thread_local vector<sCold *> _cold_blocks;
+  static thread_local stack<sCold *> _cold_free;
 };
 
 ostream &operator<<(ostream &os, const Flit &f);
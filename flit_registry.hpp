@@ -0,0 +1,221 @@
+// $Id$
+
+#ifndef _FLIT_REGISTRY_HPP_
+#define _FLIT_REGISTRY_HPP_
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+#include "flit.hpp"
+#include "checkpoint.hpp"
+
+using namespace std;
+
+// Flits indexed by an id (flit or packet id). The flits live in a pool of
+// entries with a free list, chained in insertion order, and an open-addressed
+// table keyed by id finds the entry of an id. Insert, find and erase take
+// constant time, and memory and iteration grow with the number of flits held,
+// however far apart their ids are. Iteration visits the flits in insertion
+// order, which for the in-flight flits is id order.
+class FlitRegistry
+{
+  struct sEntry
+  {
+    long long int id;
+    Flit *f;
+    long long int prev;
+    long long int next;
+  };
+
+  vector<sEntry> _entries;
+  vector<long long int> _free;
+  // entry holding each id, or -1; the size is a power of two
+  vector<long long int> _table;
+  long long int _head;
+  long long int _tail;
+  size_t _count;
+
+  inline size_t _Home(long long int id) const
+  {
+    return (size_t)id & (_table.size() - 1);
+  }
+
+  // slot holding id, or the empty slot where it would go
+  size_t _Slot(long long int id) const
+  {
+    size_t pos = _Home(id);
+    while ((_table[pos] >= 0) && (_entries[_table[pos]].id != id))
+    {
+      pos = (pos + 1) & (_table.size() - 1);
+    }
+    return pos;
+  }
+
+  void _Grow()
+  {
+    _table.assign(_table.empty() ? 16 : (2 * _table.size()), -1);
+    for (long long int e = _head; e >= 0; e = _entries[e].next)
+    {
+      _table[_Slot(_entries[e].id)] = e;
+    }
+  }
+
+public:
+  FlitRegistry() : _head(-1), _tail(-1), _count(0) {}
+
+  class const_iterator
+  {
+    vector<sEntry> const *_entries;
+    long long int _e;
+
+  public:
+    const_iterator(vector<sEntry> const *entries, long long int e)
+        : _entries(entries), _e(e) {}
+
+    inline long long int Id() const { return (*_entries)[_e].id; }
+    inline Flit *operator*() const { return (*_entries)[_e].f; }
+    inline const_iterator &operator++()
+    {
+      _e = (*_entries)[_e].next;
+      return *this;
+    }
+    inline bool operator!=(const_iterator const &other) const { return _e != other._e; }
+  };
+
+  inline const_iterator begin() const { return const_iterator(&_entries, _head); }
+  inline const_iterator end() const { return const_iterator(&_entries, -1); }
+
+  inline size_t size() const { return _count; }
+  inline bool empty() const { return _count == 0; }
+
+  void Insert(long long int id, Flit *f)
+  {
+    assert(f);
+    // at most half full keeps the probe sequences short
+    if (2 * (_count + 1) > _table.size())
+    {
+      _Grow();
+    }
+    size_t const pos = _Slot(id);
+    assert(_table[pos] < 0);
+
+    long long int e;
+    if (_free.empty())
+    {
+      e = _entries.size();
+      _entries.push_back(sEntry());
+    }
+    else
+    {
+      e = _free.back();
+      _free.pop_back();
+    }
+    sEntry &entry = _entries[e];
+    entry.id = id;
+    entry.f = f;
+    entry.prev = _tail;
+    entry.next = -1;
+    if (_tail >= 0)
+    {
+      _entries[_tail].next = e;
+    }
+    else
+    {
+      _head = e;
+    }
+    _tail = e;
+    _table[pos] = e;
+    ++_count;
+  }
+
+  inline Flit *Find(long long int id) const
+  {
+    if (_count == 0)
+    {
+      return NULL;
+    }
+    long long int const e = _table[_Slot(id)];
+    return (e < 0) ? NULL : _entries[e].f;
+  }
+
+  void Erase(long long int id)
+  {
+    assert(_count > 0);
+    size_t pos = _Slot(id);
+    long long int const e = _table[pos];
+    assert(e >= 0);
+
+    sEntry &entry = _entries[e];
+    if (entry.prev >= 0)
+    {
+      _entries[entry.prev].next = entry.next;
+    }
+    else
+    {
+      _head = entry.next;
+    }
+    if (entry.next >= 0)
+    {
+      _entries[entry.next].prev = entry.prev;
+    }
+    else
+    {
+      _tail = entry.prev;
+    }
+    entry.f = NULL;
+    _free.push_back(e);
+    --_count;
+
+    // close the gap, so that no probe sequence runs into an empty slot
+    // before reaching its id
+    size_t const mask = _table.size() - 1;
+    for (size_t next = (pos + 1) & mask; _table[next] >= 0; next = (next + 1) & mask)
+    {
+      size_t const home = _Home(_entries[_table[next]].id);
+      if (((next - home) & mask) >= ((next - pos) & mask))
+      {
+        _table[pos] = _table[next];
+        pos = next;
+      }
+    }
+    _table[pos] = -1;
+  }
+
+  // stores the ids and flits in iteration order and inserts them again on
+  // restore
+  void Serialize(Checkpoint &cp)
+  {
+    size_t count = _count;
+    cp.Io(count);
+    if (cp.Restoring())
+    {
+      _entries.clear();
+      _free.clear();
+      _table.clear();
+      _head = -1;
+      _tail = -1;
+      _count = 0;
+    }
+    long long int e = _head;
+    for (size_t i = 0; i < count; ++i)
+    {
+      long long int id = 0;
+      Flit *f = NULL;
+      if (cp.Saving())
+      {
+        id = _entries[e].id;
+        f = _entries[e].f;
+        e = _entries[e].next;
+      }
+      cp.Io(id);
+      cp.Io(f);
+      if (cp.Restoring())
+      {
+        Insert(id, f);
+      }
+    }
+  }
+};
+
+#endif
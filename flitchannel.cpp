@@ -75,3 +75,10 @@ void FlitChannel::WriteOutputs()
                << "." << endl;
   }
 }
+
+void FlitChannel::Serialize(Checkpoint &cp)
+{
+  Channel<Flit>::Serialize(cp);
+  cp.Io(_active);
+  cp.Io(_idle);
+}
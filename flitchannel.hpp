@@ -59,6 +59,8 @@ public:
   virtual void ReadInputs();
   virtual void WriteOutputs();
 
+  virtual void Serialize(Checkpoint &cp);
+
 private:
   ////////////////////////////////////////
   //
@@ -8,6 +8,11 @@
 
 /*all declared in main.cpp*/
 
+/* The topology and routing globals below are shared by every simulation in
+ * the process. State that belongs to one simulation is thread-local, so that
+ * a sweep can run several simulations side by side, one per thread.
+ */
+
 long long int GetSimTime();
 
 class Stats;
@@ -23,12 +28,29 @@ extern long long int gNodes;
 
 extern bool gTrace;
 
-extern std::ostream *gWatchOut;
+extern thread_local std::ostream *gWatchOut;
 
 // Orion Power Support
 extern int g_number_of_cache;
-extern int g_number_of_injected_flits;
-extern int g_number_of_retired_flits;
-extern int g_total_cs_register_writes;
+extern thread_local int g_number_of_injected_flits;
+extern thread_local int g_number_of_retired_flits;
+extern thread_local int g_total_cs_register_writes;
+
+class AsyncConfig;
+class TrafficManager;
+struct CreditPool;
+
+// the thread-local state of a simulation, handed to the network's worker
+// threads so that they act on the simulation that started them
+struct SimContext
+{
+  AsyncConfig *async_config;
+  TrafficManager *traffic_manager;
+  std::ostream *watch_out;
+  CreditPool *credit_pool;
+
+  static SimContext Current();
+  void Install() const;
+};
 
 #endif
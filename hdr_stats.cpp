@@ -0,0 +1,224 @@
+// $Id$
+
+/*hdr_stats.cpp
+ *
+ *log-linear latency histograms kept in flat arrays, one row per series
+ *
+ */
+
+#include "booksim.hpp"
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "hdr_stats.hpp"
+#include "checkpoint.hpp"
+
+static char const _magic[8] = {'B', 'K', 'S', 'M', 'H', 'D', 'R', '1'};
+static unsigned int const _version = 1;
+
+static void _PutU32(ostream &os, unsigned int v)
+{
+  unsigned char p[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+  os.write((char const *)p, 4);
+}
+
+static void _PutU64(ostream &os, unsigned long long int v)
+{
+  unsigned char p[8];
+  for (int i = 0; i < 8; ++i)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+  os.write((char const *)p, 8);
+}
+
+HdrStats::HdrStats(long long int series, long long int sub_bits)
+    : _series(series), _sub_bits(sub_bits)
+{
+  assert(series > 0);
+  if ((sub_bits < 1) || (sub_bits > 16))
+  {
+    cerr << "Histogram precision must be between 1 and 16 sub-bucket bits" << endl;
+    exit(-1);
+  }
+  _half = 1LL << (_sub_bits - 1);
+  _buckets = _half << 1;
+
+  _count.resize(_series);
+  _sum.resize(_series);
+  _min.resize(_series);
+  _max.resize(_series);
+  Clear();
+}
+
+void HdrStats::Clear()
+{
+  _count.assign(_series, 0);
+  _sum.assign(_series, 0.0);
+  _min.assign(_series, 0);
+  _max.assign(_series, 0);
+  _hist.assign(_series * _buckets, 0);
+}
+
+void HdrStats::_Grow(long long int buckets)
+{
+  // widen by whole octaves, so a slowly rising maximum does not re-layout
+  // the rows on every new bucket
+  buckets = ((buckets + _half - 1) / _half) * _half;
+  assert(buckets > _buckets);
+
+  vector<long long int> hist(_series * buckets, 0);
+  for (long long int s = 0; s < _series; ++s)
+  {
+    copy(_hist.begin() + s * _buckets, _hist.begin() + (s + 1) * _buckets,
+         hist.begin() + s * buckets);
+  }
+  _hist.swap(hist);
+  _buckets = buckets;
+}
+
+long long int HdrStats::_BucketMax(long long int b) const
+{
+  if (b < (_half << 1))
+  {
+    return b;
+  }
+  long long int const shift = b / _half - 1;
+  long long int const sub = b - shift * _half;
+  return ((sub + 1) << shift) - 1;
+}
+
+double HdrStats::Average(long long int s) const
+{
+  return _sum[s] / (double)_count[s];
+}
+
+double HdrStats::Min(long long int s) const
+{
+  return _count[s] ? (double)_min[s] : numeric_limits<double>::quiet_NaN();
+}
+
+double HdrStats::Max(long long int s) const
+{
+  return _count[s] ? (double)_max[s] : numeric_limits<double>::quiet_NaN();
+}
+
+double HdrStats::Percentile(long long int s, double q) const
+{
+  assert((q >= 0.0) && (q <= 1.0));
+  if (!_count[s])
+  {
+    return numeric_limits<double>::quiet_NaN();
+  }
+
+  long long int target = (long long int)(q * (double)_count[s] + 0.5);
+  if (target < 1)
+  {
+    target = 1;
+  }
+
+  long long int const *row = &_hist[s * _buckets];
+  long long int seen = 0;
+  for (long long int b = 0; b < _buckets; ++b)
+  {
+    seen += row[b];
+    if (seen >= target)
+    {
+      return (double)min(_BucketMax(b), _max[s]);
+    }
+  }
+  return (double)_max[s];
+}
+
+void HdrStats::Merge(HdrStats const &other)
+{
+  assert(other._series == _series);
+  assert(other._sub_bits == _sub_bits);
+
+  if (other._buckets > _buckets)
+  {
+    _Grow(other._buckets);
+  }
+  for (long long int s = 0; s < _series; ++s)
+  {
+    if (!other._count[s])
+    {
+      continue;
+    }
+    long long int *row = &_hist[s * _buckets];
+    long long int const *other_row = &other._hist[s * other._buckets];
+    for (long long int b = 0; b < other._buckets; ++b)
+    {
+      row[b] += other_row[b];
+    }
+    if (!_count[s] || (other._min[s] < _min[s]))
+    {
+      _min[s] = other._min[s];
+    }
+    if (!_count[s] || (other._max[s] > _max[s]))
+    {
+      _max[s] = other._max[s];
+    }
+    _count[s] += other._count[s];
+    _sum[s] += other._sum[s];
+  }
+}
+
+void HdrStats::Serialize(Checkpoint &cp)
+{
+  cp.Check(_series, "histogram series");
+  cp.Check(_sub_bits, "histogram precision");
+  cp.Io(_buckets);
+  cp.Io(_count);
+  cp.Io(_sum);
+  cp.Io(_min);
+  cp.Io(_max);
+  cp.Io(_hist);
+}
+
+void HdrStats::DumpHeader(ostream &os)
+{
+  os.write(_magic, sizeof(_magic));
+  _PutU32(os, _version);
+}
+
+void HdrStats::Dump(ostream &os, string const &name) const
+{
+  _PutU32(os, (unsigned int)name.size());
+  os.write(name.data(), name.size());
+  _PutU64(os, (unsigned long long int)_series);
+  _PutU32(os, (unsigned int)_sub_bits);
+  _PutU32(os, (unsigned int)_buckets);
+
+  for (long long int s = 0; s < _series; ++s)
+  {
+    unsigned long long int sum;
+    memcpy(&sum, &_sum[s], sizeof(sum));
+    _PutU64(os, (unsigned long long int)_count[s]);
+    _PutU64(os, sum);
+    _PutU64(os, (unsigned long long int)_min[s]);
+    _PutU64(os, (unsigned long long int)_max[s]);
+
+    long long int const *row = &_hist[s * _buckets];
+    unsigned int used = 0;
+    for (long long int b = 0; b < _buckets; ++b)
+    {
+      used += (row[b] != 0);
+    }
+    _PutU32(os, used);
+    for (long long int b = 0; b < _buckets; ++b)
+    {
+      if (row[b])
+      {
+        _PutU32(os, (unsigned int)b);
+        _PutU64(os, (unsigned long long int)row[b]);
+      }
+    }
+  }
+}
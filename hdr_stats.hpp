@@ -0,0 +1,113 @@
+// $Id$
+
+#ifndef _HDR_STATS_HPP_
+#define _HDR_STATS_HPP_
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cassert>
+
+using namespace std;
+
+class Checkpoint;
+
+// Streaming statistics for many independent series of non-negative integer
+// samples, e.g. the latency of every (class, source, destination) pair. All
+// series share flat arrays: one slot per series for count, sum, min and max,
+// and one row of histogram buckets per series in a single contiguous vector.
+//
+// The histogram is log-linear: values below 2^sub_bits get a bucket each,
+// and every octave above that is split into 2^(sub_bits-1) equal buckets, so
+// a percentile is off by at most 2^(1-sub_bits) of its value. Rows only grow
+// to the highest octave seen so far.
+//
+// Engines of the same shape can be merged, so parallel runs each fill a
+// private engine and combine them afterwards without any locking.
+class HdrStats
+{
+  long long int _series;
+  long long int _sub_bits;
+  long long int _half;
+  long long int _buckets;
+
+  vector<long long int> _count;
+  vector<double> _sum;
+  vector<long long int> _min;
+  vector<long long int> _max;
+  vector<long long int> _hist;
+
+  void _Grow(long long int buckets);
+
+  inline long long int _Index(long long int val) const
+  {
+    if (val < (_half << 1))
+    {
+      return val;
+    }
+    long long int const shift = (63 - __builtin_clzll(val)) - _sub_bits + 1;
+    return shift * _half + (val >> shift);
+  }
+
+  long long int _BucketMax(long long int b) const;
+
+public:
+  HdrStats(long long int series = 1, long long int sub_bits = 7);
+
+  void Clear();
+
+  inline void AddSample(long long int s, long long int val)
+  {
+    assert((s >= 0) && (s < _series));
+    assert(val >= 0);
+    long long int const b = _Index(val);
+    if (b >= _buckets)
+    {
+      _Grow(b + 1);
+    }
+    ++_hist[s * _buckets + b];
+    if (!_count[s]++)
+    {
+      _min[s] = val;
+      _max[s] = val;
+    }
+    else if (val < _min[s])
+    {
+      _min[s] = val;
+    }
+    else if (val > _max[s])
+    {
+      _max[s] = val;
+    }
+    _sum[s] += (double)val;
+  }
+
+  inline long long int Series() const { return _series; }
+  inline long long int NumSamples(long long int s) const { return _count[s]; }
+
+  double Average(long long int s) const;
+  double Min(long long int s) const;
+  double Max(long long int s) const;
+
+  // smallest bucket bound below which a fraction q of the samples lie,
+  // capped at the largest sample; NaN for an empty series
+  double Percentile(long long int s, double q) const;
+
+  void Merge(HdrStats const &other);
+
+  void Serialize(Checkpoint &cp);
+
+  // Binary dump of one engine (all integers little-endian):
+  //
+  //   u32 name length, name, u64 series, u32 sub_bits, u32 buckets
+  //   per series: u64 count, f64 sum, u64 min, u64 max, u32 used buckets,
+  //               followed by a (u32 bucket, u64 count) pair for each
+  //
+  // Empty buckets are left out, which keeps sparse pair tables small.
+  void Dump(ostream &os, string const &name) const;
+
+  // magic[8] "BKSMHDR1" and u32 version, written once ahead of the engines
+  static void DumpHeader(ostream &os);
+};
+
+#endif
@@ -4,8 +4,10 @@
 #include <vector>
 #include <cassert>
 #include <limits>
+#include <cmath>
 #include "random_utils.hpp"
 #include "injection.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -29,6 +31,40 @@ void InjectionProcess::reset()
 {
 }
 
+long long int InjectionProcess::next(long long int source)
+{
+  if (_rate <= 0.0)
+  {
+    return -1;
+  }
+  long long int gap = 1;
+  while (!test(source))
+  {
+    ++gap;
+  }
+  return gap;
+}
+
+// number of Bernoulli trials with success probability p up to and including
+// the first success, drawn by inverting the geometric distribution
+static long long int Geometric(double p)
+{
+  if (p >= 1.0)
+  {
+    return 1;
+  }
+  if (p <= 0.0)
+  {
+    return -1;
+  }
+  double const trials = floor(log(1.0 - RandomFloat()) / log1p(-p));
+  if (trials >= (double)(numeric_limits<long long int>::max() / 2))
+  {
+    return -1;
+  }
+  return 1 + (long long int)trials;
+}
+
 InjectionProcess *InjectionProcess::New(string const &inject, long long int nodes,
                                         double load,
                                         Configuration const *const config)
@@ -153,6 +189,12 @@ bool BernoulliInjectionProcess::test(long long int source)
   return (RandomFloat() < _rate);
 }
 
+long long int BernoulliInjectionProcess::next(long long int source)
+{
+  assert((source >= 0) && (source < _nodes));
+  return Geometric(_rate);
+}
+
 //=============================================================
 
 OnOffInjectionProcess::OnOffInjectionProcess(long long int nodes, double rate,
@@ -189,6 +231,11 @@ void OnOffInjectionProcess::reset()
   _state = _initial;
 }
 
+void OnOffInjectionProcess::Serialize(Checkpoint &cp)
+{
+  cp.Io(_state);
+}
+
 bool OnOffInjectionProcess::test(long long int source)
 {
   assert((source >= 0) && (source < _nodes));
@@ -200,3 +247,44 @@ bool OnOffInjectionProcess::test(long long int source)
   // generate packet
   return _state[source] && (RandomFloat() < _r1);
 }
+
+long long int OnOffInjectionProcess::next(long long int source)
+{
+  assert((source >= 0) && (source < _nodes));
+
+  // while on, every cycle ends the burst with probability beta and otherwise
+  // injects with probability r1; skip to the first cycle that does either
+  double const end = _beta + (1.0 - _beta) * _r1;
+  double const hit = (end > 0.0) ? ((1.0 - _beta) * _r1 / end) : 0.0;
+
+  long long int gap = 0;
+  while (true)
+  {
+    if (!_state[source])
+    {
+      // off dwell; the cycle that turns the source on may inject right away
+      long long int const off = Geometric(_alpha);
+      if (off < 0)
+      {
+        return -1;
+      }
+      gap += off;
+      _state[source] = 1;
+      if (RandomFloat() < _r1)
+      {
+        return gap;
+      }
+    }
+    long long int const on = Geometric(end);
+    if (on < 0)
+    {
+      return -1;
+    }
+    gap += on;
+    if (RandomFloat() < hit)
+    {
+      return gap;
+    }
+    _state[source] = 0;
+  }
+}
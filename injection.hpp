@@ -7,6 +7,8 @@
 
 using namespace std;
 
+class Checkpoint;
+
 class InjectionProcess
 {
 protected:
@@ -17,7 +19,12 @@ protected:
 public:
   virtual ~InjectionProcess() {}
   virtual bool test(long long int source) = 0;
+  // number of cycles up to and including the next one in which source
+  // injects, as if test() were called once per cycle from now on; -1 if it
+  // never injects again
+  virtual long long int next(long long int source);
   virtual void reset();
+  virtual void Serialize(Checkpoint &cp) {}
   static InjectionProcess *New(string const &inject, long long int nodes, double load,
                                Configuration const *const config = NULL);
 };
@@ -27,6 +34,7 @@ class BernoulliInjectionProcess : public InjectionProcess
 public:
   BernoulliInjectionProcess(long long int nodes, double rate);
   virtual bool test(long long int source);
+  virtual long long int next(long long int source);
 };
 
 class OnOffInjectionProcess : public InjectionProcess
@@ -43,6 +51,8 @@ public:
                         double r1, vector<long long int> initial);
   virtual void reset();
   virtual bool test(long long int source);
+  virtual long long int next(long long int source);
+  virtual void Serialize(Checkpoint &cp);
 };
 
 #endif
@@ -17,6 +17,9 @@
 #include <fstream>
 
 #include <sstream>
+#include <vector>
+#include <thread>
+#include <streambuf>
 #include "booksim.hpp"
 #include "routefunc.hpp"
 #include "traffic.hpp"
@@ -33,10 +36,10 @@
 //Global declarations
 //////////////////////
 
-AsyncConfig *asyncConfig = NULL;
+thread_local AsyncConfig *asyncConfig = NULL;
 
 /* the current traffic manager instance */
-TrafficManager *trafficManager = NULL;
+thread_local TrafficManager *trafficManager = NULL;
 
 long long int GetSimTime()
 {
@@ -66,16 +69,48 @@ long long int gNodes;
 //generate nocviewer trace
 bool gTrace;
 
-ostream *gWatchOut;
+thread_local ostream *gWatchOut;
 
 // Orion Power Support
-int g_number_of_injected_flits = 0;
-int g_number_of_retired_flits = 0;
-int g_total_cs_register_writes = 0;
+thread_local int g_number_of_injected_flits = 0;
+thread_local int g_number_of_retired_flits = 0;
+thread_local int g_total_cs_register_writes = 0;
+
+SimContext SimContext::Current()
+{
+  SimContext context;
+  context.async_config = asyncConfig;
+  context.traffic_manager = trafficManager;
+  context.watch_out = gWatchOut;
+  context.credit_pool = Credit::GetPool();
+  return context;
+}
+
+void SimContext::Install() const
+{
+  asyncConfig = async_config;
+  trafficManager = traffic_manager;
+  gWatchOut = watch_out;
+  Credit::SetPool(credit_pool);
+}
 
 /////////////////////////////////////////////////////////////////////////////
 
-bool Simulate(BookSimConfig const &config)
+ostream *OpenWatchOut(BookSimConfig const &config)
+{
+  string watch_out_file = config.GetStr("watch_out");
+  if (watch_out_file == "")
+  {
+    return NULL;
+  }
+  else if (watch_out_file == "-")
+  {
+    return &cout;
+  }
+  return new ofstream(watch_out_file.c_str());
+}
+
+vector<Network *> BuildNetworks(BookSimConfig const &config)
 {
   vector<Network *> net;
 
@@ -92,6 +127,15 @@ bool Simulate(BookSimConfig const &config)
     //    net[i]->DumpChannelMap();		//Sneha
     //    net[i]->DumpNodeMap();		//Sneha
   }
+  return net;
+}
+
+/* runs the traffic on networks built by BuildNetworks and frees them; the
+ * overall stats are also written to csv if given */
+bool RunNetworks(BookSimConfig const &config, vector<Network *> const &net,
+                 ostream *csv = NULL)
+{
+  long long int subnets = net.size();
 
   /*tcc and characterize are legacy not sure how to use them */
 
@@ -105,6 +149,7 @@ bool Simulate(BookSimConfig const &config)
   gettimeofday(&start_time, NULL);
 
   bool result = trafficManager->Run();
+  trafficManager->FlushActivityTrace();
 
   gettimeofday(&end_time, NULL);
   total_time = ((double)(end_time.tv_sec) + (double)(end_time.tv_usec) / 1000000.0) - ((double)(start_time.tv_sec) + (double)(start_time.tv_usec) / 1000000.0);
@@ -112,6 +157,11 @@ bool Simulate(BookSimConfig const &config)
   cout << "\n*****************************************\n";
   cout << "Total run time " << total_time << endl;
 
+  if (csv && result)
+  {
+    trafficManager->DisplayOverallStatsCSV(*csv);
+  }
+
   for (long long int i = 0; i < subnets; ++i)
   {
 
@@ -131,90 +181,322 @@ bool Simulate(BookSimConfig const &config)
   return result;
 }
 
-int main(int argc, char **argv)
+bool Simulate(BookSimConfig const &config)
 {
+  return RunNetworks(config, BuildNetworks(config));
+}
 
-  BookSimConfig config;
+void DisplayGatingResults()
+{
+  long long int totalViableIdleTicksSum = 0;
+  long long int totalViableGatedTicksSum = 0;
 
-  if (!ParseArgs(&config, argc, argv))
+  long long int totalViableIdleTimesSum = 0;
+  long long int totalGatedTimesSum = 0;
+  cout << "\n--------------Gating Results---------------------\n";
+  //per router viable idle tick sum
+  cout << "\nViable idle Ticks Sum, ";
+
+  for (unsigned int i = 0; i < asyncConfig->viableIdleTicksSum.size(); i++)
   {
-    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
-    return 0;
+    cout << asyncConfig->viableIdleTicksSum[i] << ", ";
+    totalViableIdleTicksSum = totalViableIdleTicksSum + asyncConfig->viableIdleTicksSum[i];
   }
-  asyncConfig = new AsyncConfig(config);
-  /*initialize routing, traffic, injection functions  */
-  InitializeRoutingMap(config);
 
-  gPrintActivity = (config.GetLongInt("print_activity") > 0);
-  gTrace = (config.GetLongInt("viewer_trace") > 0);
+  //per router viable idle Times sum
+  cout << "\nViable idle Times Sum, ";
 
-  string watch_out_file = config.GetStr("watch_out");
-  if (watch_out_file == "")
+  for (unsigned int i = 0; i < asyncConfig->viableIdleTimesSum.size(); i++)
   {
-    gWatchOut = NULL;
+    cout << asyncConfig->viableIdleTimesSum[i] << ", ";
+    totalViableIdleTimesSum = totalViableIdleTimesSum + asyncConfig->viableIdleTimesSum[i];
   }
-  else if (watch_out_file == "-")
+
+  //per router gated Ticks Sum
+  cout << "\nViable gated Ticks Sum, ";
+
+  for (unsigned int i = 0; i < asyncConfig->viableGatedTicksSum.size(); i++)
   {
-    gWatchOut = &cout;
+    cout << asyncConfig->viableGatedTicksSum[i] << ", ";
+    totalViableGatedTicksSum = totalViableGatedTicksSum + asyncConfig->viableGatedTicksSum[i];
   }
-  else
+
+  //per router gated Times Sum
+  cout << "\nViable gated Times Sum, ";
+
+  for (unsigned int i = 0; i < asyncConfig->gatedTimesSum.size(); i++)
   {
-    gWatchOut = new ofstream(watch_out_file.c_str());
+    cout << asyncConfig->gatedTimesSum[i] << ", ";
+    totalGatedTimesSum = totalGatedTimesSum + asyncConfig->gatedTimesSum[i];
   }
 
-  /*configure and run the simulator */
-  bool result = Simulate(config);
+  //Overall Result
 
-  if (asyncConfig->doGating)
-  {
-    long long int totalViableIdleTicksSum = 0;
-    long long int totalViableGatedTicksSum = 0;
+  cout << "\nOverall viable idle ticks, " << totalViableIdleTicksSum << endl;
+  cout << "Overall viable idle times, " << totalViableIdleTimesSum << endl;
+  cout << "Overall gated ticks, " << totalViableGatedTicksSum << endl;
+  cout << "Overall gated times, " << totalGatedTimesSum << endl;
+}
 
-    long long int totalViableIdleTimesSum = 0;
-    long long int totalGatedTimesSum = 0;
-    cout << "\n--------------Gating Results---------------------\n";
-    //per router viable idle tick sum
-    cout << "\nViable idle Ticks Sum, ";
+/////////////////////////////////////////////////////////////////////////////
+// Sweeps
 
-    for (unsigned int i = 0; i < asyncConfig->viableIdleTicksSum.size(); i++)
+/* stands in for the buffer of cout while a sweep is running, so that each
+ * run's output is collected separately and printed in order */
+class SweepStreamBuf : public streambuf
+{
+  streambuf *_out;
+
+protected:
+  virtual int overflow(int c)
+  {
+    if (c == EOF)
     {
-      cout << asyncConfig->viableIdleTicksSum[i] << ", ";
-      totalViableIdleTicksSum = totalViableIdleTicksSum + asyncConfig->viableIdleTicksSum[i];
+      return 0;
     }
+    return Target()->sputc(c);
+  }
+  virtual streamsize xsputn(char const *s, streamsize n)
+  {
+    return Target()->sputn(s, n);
+  }
+  virtual int sync()
+  {
+    return Target()->pubsync();
+  }
+  streambuf *Target() const
+  {
+    return log ? log : _out;
+  }
+
+public:
+  static thread_local streambuf *log;
+
+  SweepStreamBuf(streambuf *out) : _out(out) {}
+};
+
+thread_local streambuf *SweepStreamBuf::log = NULL;
+
+struct SweepRun
+{
+  string overrides;
+  BookSimConfig config;
+  AsyncConfig *async_config;
+  vector<Network *> net;
+  ostringstream log;
+  ostringstream csv;
+  bool result;
+};
+
+/* the topology and routing state that the runs of a sweep share */
+struct SweepTopology
+{
+  long long int k, n, c, nodes;
+  long long int num_vcs, num_classes;
+  vector<long long int> begin_vcs, end_vcs;
 
-    //per router viable idle Times sum
-    cout << "\nViable idle Times Sum, ";
+  SweepTopology()
+      : k(gK), n(gN), c(gC), nodes(gNodes),
+        num_vcs(gNumVCs), num_classes(gNumClasses),
+        begin_vcs(gBeginVCs), end_vcs(gEndVCs) {}
 
-    for (unsigned int i = 0; i < asyncConfig->viableIdleTimesSum.size(); i++)
+  bool operator==(SweepTopology const &t) const
+  {
+    return ((k == t.k) && (n == t.n) && (c == t.c) && (nodes == t.nodes) &&
+            (num_vcs == t.num_vcs) && (num_classes == t.num_classes) &&
+            (begin_vcs == t.begin_vcs) && (end_vcs == t.end_vcs));
+  }
+};
+
+void RunSweep(SweepRun *run)
+{
+  SweepStreamBuf::log = run->log.rdbuf();
+  asyncConfig = run->async_config;
+  gWatchOut = OpenWatchOut(run->config);
+  // the Orion parameters are per thread; the routers set them while the
+  // network was built, but on the main thread
+  Flexus_Orion_init(run->config);
+  run->result = RunNetworks(run->config, run->net, &run->csv);
+  if (asyncConfig->doGating)
+  {
+    DisplayGatingResults();
+  }
+  delete asyncConfig;
+  asyncConfig = NULL;
+  SweepStreamBuf::log = NULL;
+}
+
+bool Sweep(BookSimConfig const &config)
+{
+  string const sweep_file = config.GetStr("sweep_file");
+  ifstream in(sweep_file.c_str());
+  if (!in)
+  {
+    cerr << "Could not open sweep file " << sweep_file << endl;
+    exit(-1);
+  }
+  vector<string> overrides;
+  string line;
+  while (getline(in, line))
+  {
+    if (line.find_first_not_of(" \t\r") != string::npos)
     {
-      cout << asyncConfig->viableIdleTimesSum[i] << ", ";
-      totalViableIdleTimesSum = totalViableIdleTimesSum + asyncConfig->viableIdleTimesSum[i];
+      overrides.push_back(line);
     }
+  }
+
+  long long int threads = config.GetLongInt("sweep_threads");
+  if (threads <= 0)
+  {
+    threads = thread::hardware_concurrency();
+  }
+
+  string const csv_file = config.GetStr("sweep_csv");
+  ofstream csv(csv_file.c_str());
+  if (!csv)
+  {
+    cerr << "Could not open sweep output " << csv_file << endl;
+    exit(-1);
+  }
+  csv << "run,overrides,stable,class,";
+  bool header = false;
+  vector<string> rows;
 
-    //per router gated Ticks Sum
-    cout << "\nViable gated Ticks Sum, ";
+  vector<SweepTopology> topology;
 
-    for (unsigned int i = 0; i < asyncConfig->viableGatedTicksSum.size(); i++)
+  streambuf *const out = cout.rdbuf();
+  SweepStreamBuf buf(out);
+  cout.rdbuf(&buf);
+
+  bool result = true;
+  for (size_t start = 0; start < overrides.size(); start += threads)
+  {
+    size_t const end = min(overrides.size(), (size_t)(start + threads));
+    vector<SweepRun> runs(end - start);
+
+    // the networks are built here, one at a time, as their constructors set
+    // the shared topology and routing globals that the running simulations
+    // read
+    for (size_t r = 0; r < runs.size(); ++r)
     {
-      cout << asyncConfig->viableGatedTicksSum[i] << ", ";
-      totalViableGatedTicksSum = totalViableGatedTicksSum + asyncConfig->viableGatedTicksSum[i];
+      SweepRun &run = runs[r];
+      run.overrides = overrides[start + r];
+      run.config = config;
+      run.config.ParseString(run.overrides);
+      run.async_config = new AsyncConfig(run.config);
+      asyncConfig = run.async_config;
+      InitializeRoutingMap(run.config);
+      run.net = BuildNetworks(run.config);
+      if (topology.empty())
+      {
+        topology.push_back(SweepTopology());
+      }
+      else if (!(SweepTopology() == topology[0]))
+      {
+        cerr << "Sweep overrides may not change the topology or routing: "
+             << run.overrides << endl;
+        exit(-1);
+      }
     }
+    asyncConfig = NULL;
 
-    //per router gated Times Sum
-    cout << "\nViable gated Times Sum, ";
+    vector<thread> workers;
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+      workers.push_back(thread(RunSweep, &runs[r]));
+    }
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+      workers[r].join();
+    }
 
-    for (unsigned int i = 0; i < asyncConfig->gatedTimesSum.size(); i++)
+    for (size_t r = 0; r < runs.size(); ++r)
     {
-      cout << asyncConfig->gatedTimesSum[i] << ", ";
-      totalGatedTimesSum = totalGatedTimesSum + asyncConfig->gatedTimesSum[i];
+      SweepRun const &run = runs[r];
+      cout << "BEGIN Sweep run " << start + r << ": " << run.overrides << endl;
+      cout << run.log.str();
+      cout << "END Sweep run " << start + r << endl;
+
+      string quoted = run.overrides;
+      for (size_t pos = quoted.find('"'); pos != string::npos;
+           pos = quoted.find('"', pos + 2))
+      {
+        quoted.insert(pos, 1, '"');
+      }
+      ostringstream prefix;
+      prefix << start + r << ",\"" << quoted << "\"," << run.result << ",";
+      if (!run.result)
+      {
+        rows.push_back(prefix.str());
+        result = false;
+        continue;
+      }
+
+      // DisplayOverallStatsCSV prints "header:class,..." followed by one
+      // "results:class,..." line per measured class
+      istringstream stats(run.csv.str());
+      while (getline(stats, line))
+      {
+        size_t const colon = line.find(':');
+        if (line.compare(0, colon, "header") == 0)
+        {
+          if (!header)
+          {
+            csv << line.substr(line.find(',') + 1) << endl;
+            header = true;
+          }
+        }
+        else if (line.compare(0, colon, "results") == 0)
+        {
+          rows.push_back(prefix.str() + line.substr(colon + 1));
+        }
+      }
     }
+  }
 
-    //Overall Result
+  cout.rdbuf(out);
+  if (!header)
+  {
+    csv << endl;
+  }
+  for (size_t r = 0; r < rows.size(); ++r)
+  {
+    csv << rows[r] << endl;
+  }
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+
+  BookSimConfig config;
+
+  if (!ParseArgs(&config, argc, argv))
+  {
+    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
+    return 0;
+  }
 
-    cout << "\nOverall viable idle ticks, " << totalViableIdleTicksSum << endl;
-    cout << "Overall viable idle times, " << totalViableIdleTimesSum << endl;
-    cout << "Overall gated ticks, " << totalViableGatedTicksSum << endl;
-    cout << "Overall gated times, " << totalGatedTimesSum << endl;
+  gPrintActivity = (config.GetLongInt("print_activity") > 0);
+  gTrace = (config.GetLongInt("viewer_trace") > 0);
+
+  if (config.GetStr("sweep_file") != "")
+  {
+    return Sweep(config) ? -1 : 0;
+  }
+
+  asyncConfig = new AsyncConfig(config);
+  /*initialize routing, traffic, injection functions  */
+  InitializeRoutingMap(config);
+
+  gWatchOut = OpenWatchOut(config);
+
+  /*configure and run the simulator */
+  bool result = Simulate(config);
+
+  if (asyncConfig->doGating)
+  {
+    DisplayGatingResults();
   }
 
   delete asyncConfig;
@@ -26,7 +26,58 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
 #include "netrace.h"
+#include "nt_stream.h"
+
+#pragma pack(push, 1)
+struct nt_packet_pack
+{
+	unsigned long long int cycle;
+	unsigned int id;
+	unsigned int addr;
+	unsigned char type;
+	unsigned char src;
+	unsigned char dst;
+	unsigned char node_types;
+	unsigned char num_deps;
+};
+#pragma pack(pop)
+
+// Single-producer single-consumer ring of decoded packets. The producer
+// thread owns the stream and the tail; the simulator owns the head and the
+// dependency tracking. A NULL entry marks the end of the trace.
+struct nt_prefetch
+{
+	pthread_t thread;
+	nt_stream_t *stream;
+	nt_packet_t *ring[NT_PREFETCH_RING_SIZE];
+	atomic_ullong head;
+	atomic_ullong tail;
+	atomic_int stop;
+	atomic_int done;
+	// why the producer stopped early; published by pushing nt_prefetch_failed
+	const char *error;
+	int eof;
+};
+
+// Ring entry marking a decode failure, which is reported on the simulator
+// thread rather than exiting from the producer
+static nt_packet_t nt_prefetch_failed;
+
+// Reads part of the trace header on the simulator thread, exiting on a short
+// read with the stream's reason when it has one
+static void nt_read_header(nt_stream_t *stream, void *buffer, size_t length, const char *what)
+{
+	if (nt_stream_read(stream, buffer, length) < length)
+	{
+		nt_error(nt_stream_error(stream) ? nt_stream_error(stream) : what);
+	}
+}
 
 const char *nt_packet_types[] = {"InvalidCmd", "ReadReq", "ReadResp",
 								 "ReadRespWithInvalidate", "WriteReq", "WriteResp",
@@ -54,18 +105,9 @@ const char *nt_node_types[] = {"L1 Data Cache", "L1 Instruction Cache",
 void nt_open_trfile(nt_context_t *ctx, const char *trfilename)
 {
 	nt_close_trfile(ctx);
-	int i;
-	int length = 20;
-	for (i = 0; trfilename[i] != 0; i++, length++)
-		;
-	ctx->input_popencmd = (char *)nt_checked_malloc(length * sizeof(char));
-	sprintf(ctx->input_popencmd, "bzip2 -dc %s", trfilename);
-	ctx->input_tracefile = popen(ctx->input_popencmd, "r");
-	if (ctx->input_tracefile == NULL)
-	{
-		nt_error("failed to open pipe to trace file");
-	}
+	ctx->input_stream = nt_stream_open(trfilename);
 	ctx->input_trheader = nt_read_trheader(ctx);
+	nt_start_prefetch(ctx);
 	if (ctx->dependency_array == NULL)
 	{
 		ctx->dependency_array = nt_checked_malloc(sizeof(nt_dep_ref_node_t *) * NT_DEPENDENCY_ARRAY_SIZE);
@@ -97,17 +139,11 @@ nt_header_t *nt_read_trheader(nt_context_t *ctx)
 	};
 #pragma pack(pop)
 
-	int err = 0;
 	char strerr[180];
 
 	// Read Header
 	struct nt_header_pack *in_header = nt_checked_malloc(sizeof(struct nt_header_pack));
-	fseek(ctx->input_tracefile, 0, SEEK_SET);
-	if ((err = fread(in_header, sizeof(struct nt_header_pack), 1, ctx->input_tracefile)) < 0)
-	{
-		sprintf(strerr, "failed to read trace file header: err = %d", err);
-		nt_error(strerr);
-	}
+	nt_read_header(ctx->input_stream, in_header, sizeof(struct nt_header_pack), "failed to read trace file header");
 
 	// Copy data from struct to header
 	nt_header_t *to_return = (nt_header_t *)nt_checked_malloc(sizeof(nt_header_t));
@@ -143,11 +179,7 @@ nt_header_t *nt_read_trheader(nt_context_t *ctx)
 	if (to_return->notes_length > 0 && to_return->notes_length < 8192)
 	{
 		to_return->notes = (char *)nt_checked_malloc(to_return->notes_length * sizeof(char));
-		if ((err = fread(to_return->notes, sizeof(char), to_return->notes_length, ctx->input_tracefile)) < 0)
-		{
-			sprintf(strerr, "failed to read trace file header notes: err = %d\n", err);
-			nt_error(strerr);
-		}
+		nt_read_header(ctx->input_stream, to_return->notes, to_return->notes_length, "failed to read trace file header notes");
 	}
 	else
 	{
@@ -158,11 +190,7 @@ nt_header_t *nt_read_trheader(nt_context_t *ctx)
 		if (to_return->num_regions <= 100)
 		{
 			to_return->regions = (nt_regionhead_t *)nt_checked_malloc(to_return->num_regions * sizeof(nt_regionhead_t));
-			if ((err = fread(to_return->regions, sizeof(nt_regionhead_t), to_return->num_regions, ctx->input_tracefile)) < 0)
-			{
-				sprintf(strerr, "failed to read trace file header regions: error = %d\n", err);
-				nt_error(strerr);
-			}
+			nt_read_header(ctx->input_stream, to_return->regions, to_return->num_regions * sizeof(nt_regionhead_t), "failed to read trace file header regions");
 		}
 		else
 		{
@@ -187,36 +215,17 @@ void nt_disable_dependencies(nt_context_t *ctx)
 
 void nt_seek_region(nt_context_t *ctx, nt_regionhead_t *region)
 {
-	int err = 0;
-	char strerr[180];
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		if (region != NULL)
 		{
 			// Clear all existing dependencies
 			nt_delete_all_dependencies(ctx);
-			// Reopen file to fast-forward to region
-			// fseek doesn't work on compressed file
-			pclose(ctx->input_tracefile);
-			ctx->input_tracefile = popen(ctx->input_popencmd, "r");
-			unsigned long long int seek_offset = nt_get_headersize(ctx) + region->seek_offset;
-			unsigned long long int read_length = 4096;
-			char *buffer = (char *)nt_checked_malloc(read_length);
-			while (seek_offset > read_length)
-			{
-				if ((err = fread(buffer, 1, read_length, ctx->input_tracefile)) < 0)
-				{
-					sprintf(strerr, "failed to seek region: error = %d\n", err);
-					nt_error(strerr);
-				}
-				seek_offset -= read_length;
-			}
-			if ((err = fread(buffer, 1, seek_offset, ctx->input_tracefile)) < 0)
-			{
-				sprintf(strerr, "failed to seek region: error = %d\n", err);
-				nt_error(strerr);
-			}
-			free(buffer);
+			// Packets decoded ahead belong to the old position; the stream
+			// itself jumps straight to the region in indexed traces
+			nt_stop_prefetch(ctx);
+			nt_stream_seek(ctx->input_stream, nt_get_headersize(ctx) + region->seek_offset);
+			nt_start_prefetch(ctx);
 			if (ctx->self_throttling)
 			{
 				// Prime the pump to read in self throttled packets
@@ -234,46 +243,160 @@ void nt_seek_region(nt_context_t *ctx, nt_regionhead_t *region)
 	}
 }
 
-nt_packet_t *nt_read_packet(nt_context_t *ctx)
+// Returns NULL at the end of the trace. A corrupt or unreadable trace also
+// returns NULL, with *error set; nothing here exits, so that the prefetch
+// thread can hand the failure to the simulator thread.
+nt_packet_t *nt_decode_packet(nt_stream_t *stream, const char **error)
 {
-
-#pragma pack(push, 1)
-	struct nt_packet_pack
+	size_t got;
+	nt_packet_t *to_return = nt_packet_malloc();
+	*error = NULL;
+	if ((got = nt_stream_read(stream, to_return, sizeof(struct nt_packet_pack))) < sizeof(struct nt_packet_pack))
 	{
-		unsigned long long int cycle;
-		unsigned int id;
-		unsigned int addr;
-		unsigned char type;
-		unsigned char src;
-		unsigned char dst;
-		unsigned char node_types;
-		unsigned char num_deps;
-	};
-#pragma pack(pop)
+		if (nt_stream_error(stream) != NULL)
+		{
+			*error = nt_stream_error(stream);
+		}
+		else if (got > 0)
+		{
+			// Bad packet - end of file
+			*error = "unexpectedly reached end of trace file - perhaps corrupt";
+		}
+		// End of file
+		free(to_return);
+		return NULL;
+	}
+	if (to_return->num_deps == 0)
+	{
+		to_return->deps = NULL;
+	}
+	else
+	{
+		to_return->deps = nt_dependency_malloc(to_return->num_deps);
+		if (nt_stream_read(stream, to_return->deps, to_return->num_deps * sizeof(nt_dependency_t)) < to_return->num_deps * sizeof(nt_dependency_t))
+		{
+			*error = nt_stream_error(stream) ? nt_stream_error(stream) : "failed to read dependencies";
+			nt_packet_free(to_return);
+			return NULL;
+		}
+	}
+	return to_return;
+}
+
+static void *nt_prefetch_run(void *arg)
+{
+	nt_prefetch_t *prefetch = (nt_prefetch_t *)arg;
+	unsigned long long int tail = atomic_load_explicit(&prefetch->tail, memory_order_relaxed);
+	nt_packet_t *packet;
+	const char *error;
+	do
+	{
+		packet = nt_decode_packet(prefetch->stream, &error);
+		if (error != NULL)
+		{
+			prefetch->error = error;
+			packet = &nt_prefetch_failed;
+		}
+		while (tail - atomic_load_explicit(&prefetch->head, memory_order_acquire) == NT_PREFETCH_RING_SIZE)
+		{
+			// The simulator is far behind; back off instead of spinning
+			if (atomic_load_explicit(&prefetch->stop, memory_order_relaxed))
+			{
+				if (packet != &nt_prefetch_failed)
+				{
+					nt_packet_free(packet);
+				}
+				atomic_store_explicit(&prefetch->done, 1, memory_order_release);
+				return NULL;
+			}
+			usleep(100);
+		}
+		prefetch->ring[tail & (NT_PREFETCH_RING_SIZE - 1)] = packet;
+		atomic_store_explicit(&prefetch->tail, ++tail, memory_order_release);
+	} while (packet != NULL && packet != &nt_prefetch_failed &&
+			 !atomic_load_explicit(&prefetch->stop, memory_order_relaxed));
+	atomic_store_explicit(&prefetch->done, 1, memory_order_release);
+	return NULL;
+}
+
+void nt_start_prefetch(nt_context_t *ctx)
+{
+	nt_prefetch_t *prefetch = (nt_prefetch_t *)nt_checked_malloc(sizeof(nt_prefetch_t));
+	prefetch->stream = ctx->input_stream;
+	atomic_init(&prefetch->head, 0);
+	atomic_init(&prefetch->tail, 0);
+	atomic_init(&prefetch->stop, 0);
+	atomic_init(&prefetch->done, 0);
+	prefetch->error = NULL;
+	prefetch->eof = 0;
+	if (pthread_create(&prefetch->thread, NULL, nt_prefetch_run, prefetch))
+	{
+		nt_error("failed to start trace prefetch thread");
+	}
+	ctx->input_prefetch = prefetch;
+}
+
+void nt_stop_prefetch(nt_context_t *ctx)
+{
+	nt_prefetch_t *prefetch = ctx->input_prefetch;
+	unsigned long long int head, tail;
+	if (prefetch != NULL)
+	{
+		atomic_store_explicit(&prefetch->stop, 1, memory_order_relaxed);
+		pthread_join(prefetch->thread, NULL);
+		head = atomic_load_explicit(&prefetch->head, memory_order_relaxed);
+		tail = atomic_load_explicit(&prefetch->tail, memory_order_relaxed);
+		for (; head != tail; head++)
+		{
+			nt_packet_t *packet = prefetch->ring[head & (NT_PREFETCH_RING_SIZE - 1)];
+			if (packet != &nt_prefetch_failed)
+			{
+				nt_packet_free(packet);
+			}
+		}
+		free(prefetch);
+		ctx->input_prefetch = NULL;
+	}
+}
 
-	int err = 0;
+nt_packet_t *nt_read_packet(nt_context_t *ctx)
+{
 	unsigned int i;
-	char strerr[180];
 	nt_packet_t *to_return = NULL;
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
-		to_return = nt_packet_malloc();
-		if ((err = fread(to_return, 1, sizeof(struct nt_packet_pack), ctx->input_tracefile)) < 0)
+		nt_prefetch_t *prefetch = ctx->input_prefetch;
+		if (prefetch->eof)
 		{
-			sprintf(strerr, "failed to read packet: err = %d", err);
-			nt_error(strerr);
+			return NULL;
 		}
-		if (err > 0 && err < sizeof(struct nt_packet_pack))
+		unsigned long long int head = atomic_load_explicit(&prefetch->head, memory_order_relaxed);
+		while (atomic_load_explicit(&prefetch->tail, memory_order_acquire) == head)
 		{
-			// Bad packet - end of file
-			nt_error("unexpectedly reached end of trace file - perhaps corrupt");
+			// The producer always ends on an end or error entry, so an empty
+			// ring after it has finished means it was stopped under us
+			if (atomic_load_explicit(&prefetch->done, memory_order_acquire) &&
+				atomic_load_explicit(&prefetch->tail, memory_order_acquire) == head)
+			{
+				nt_error("trace prefetch thread stopped before the end of the trace");
+				prefetch->eof = 1;
+				return NULL;
+			}
+			sched_yield();
+		}
+		to_return = prefetch->ring[head & (NT_PREFETCH_RING_SIZE - 1)];
+		atomic_store_explicit(&prefetch->head, head + 1, memory_order_release);
+		if (to_return == &nt_prefetch_failed)
+		{
+			nt_error(prefetch->error);
+			prefetch->eof = 1;
+			return NULL;
 		}
-		else if (err == 0)
+		if (to_return == NULL)
 		{
 			// End of file
-			free(to_return);
-			to_return = NULL;
-			return to_return;
+			prefetch->eof = 1;
+			return NULL;
 		}
 		if (!ctx->dependencies_off)
 		{
@@ -287,18 +410,8 @@ nt_packet_t *nt_read_packet(nt_context_t *ctx)
 		}
 		ctx->num_active_packets++;
 		ctx->latest_active_packet_cycle = to_return->cycle;
-		if (to_return->num_deps == 0)
+		if (to_return->num_deps > 0)
 		{
-			to_return->deps = NULL;
-		}
-		else
-		{
-			to_return->deps = nt_dependency_malloc(to_return->num_deps);
-			if ((err = fread(to_return->deps, sizeof(nt_dependency_t), to_return->num_deps, ctx->input_tracefile)) < 0)
-			{
-				sprintf(strerr, "failed to read dependencies: err = %d", err);
-				nt_error(strerr);
-			}
 			if (!ctx->dependencies_off)
 			{
 				// Track dependencies: add to_return downward dependencies to array
@@ -448,7 +561,7 @@ nt_dep_ref_node_t *nt_get_dependency_node(nt_context_t *ctx, unsigned int packet
 
 int nt_dependencies_cleared(nt_context_t *ctx, nt_packet_t *packet)
 {
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		nt_dep_ref_node_t *node_ptr = nt_get_dependency_node(ctx, packet->id);
 		if (node_ptr == NULL || ctx->dependencies_off)
@@ -470,7 +583,7 @@ int nt_dependencies_cleared(nt_context_t *ctx, nt_packet_t *packet)
 void nt_clear_dependencies_free_packet(nt_context_t *ctx, nt_packet_t *packet)
 {
 	unsigned int i;
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		if (packet != NULL)
 		{
@@ -597,16 +710,12 @@ void nt_empty_cleared_packets_list(nt_context_t *ctx)
 
 void nt_close_trfile(nt_context_t *ctx)
 {
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
-		pclose(ctx->input_tracefile);
-		ctx->input_tracefile = NULL;
+		nt_stop_prefetch(ctx);
+		nt_stream_close(ctx->input_stream);
+		ctx->input_stream = NULL;
 		nt_free_trheader(ctx->input_trheader);
-		if (ctx->input_popencmd != NULL)
-		{
-			free(ctx->input_popencmd);
-		}
-		ctx->input_popencmd = NULL;
 		nt_delete_all_dependencies(ctx);
 		free(ctx->dependency_array);
 		ctx->dependency_array = NULL;
@@ -670,7 +779,7 @@ void nt_print_trheader(nt_context_t *ctx)
 
 nt_header_t *nt_get_trheader(nt_context_t *ctx)
 {
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		return ctx->input_trheader;
 	}
@@ -683,7 +792,7 @@ nt_header_t *nt_get_trheader(nt_context_t *ctx)
 
 float nt_get_trversion(nt_context_t *ctx)
 {
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		return ctx->input_trheader->version;
 	}
@@ -837,7 +946,7 @@ int nt_get_headersize(nt_context_t *ctx)
 	};
 #pragma pack(pop)
 
-	if (ctx->input_tracefile != NULL)
+	if (ctx->input_stream != NULL)
 	{
 		int to_return = 0;
 		to_return += sizeof(struct nt_header_pack);
@@ -48,6 +48,7 @@
 #define NT_NODE_TYPE_L2 2
 #define NT_NODE_TYPE_MC 3
 #define NT_READ_AHEAD 1000000
+#define NT_PREFETCH_RING_SIZE 65536 // must be a power of two
 
 // Type Declaration
 typedef unsigned int nt_dependency_t;
@@ -57,6 +58,8 @@ typedef struct nt_packet nt_packet_t;
 typedef struct nt_dep_ref_node nt_dep_ref_node_t;
 typedef struct nt_packet_list nt_packet_list_t;
 typedef struct nt_context nt_context_t;
+typedef struct nt_stream nt_stream_t;
+typedef struct nt_prefetch nt_prefetch_t;
 
 struct nt_header
 {
@@ -108,9 +111,8 @@ struct nt_packet_list
 
 struct nt_context
 {
-	char *input_popencmd;
-	FILE *input_tracefile;
-	char *input_buffer;
+	nt_stream_t *input_stream;
+	nt_prefetch_t *input_prefetch; // producer thread decoding packets ahead
 	nt_header_t *input_trheader;
 	int dependencies_off;
 	int self_throttling;
@@ -159,6 +161,9 @@ nt_header_t *nt_read_trheader(nt_context_t *);
 void nt_print_header(nt_context_t *, nt_header_t *);
 void nt_free_trheader(nt_header_t *);
 int nt_get_headersize(nt_context_t *);
+nt_packet_t *nt_decode_packet(nt_stream_t *, const char **);
+void nt_start_prefetch(nt_context_t *);
+void nt_stop_prefetch(nt_context_t *);
 nt_packet_t *nt_packet_malloc(void);
 nt_dependency_t *nt_dependency_malloc(unsigned char);
 nt_dep_ref_node_t *nt_get_dependency_node(nt_context_t *, unsigned int);
@@ -0,0 +1,352 @@
+#define _FILE_OFFSET_BITS 64
+
+#include <bzlib.h>
+#include <zlib.h>
+
+#include "netrace.h"
+#include "nt_stream.h"
+
+#define NT_FORMAT_RAW 0
+#define NT_FORMAT_BZIP2 1
+#define NT_FORMAT_BLOCK 2
+
+#pragma pack(push, 1)
+struct nt_block_header_pack
+{
+	char magic[8];
+	unsigned int block_size;
+	unsigned int pad;
+	unsigned long long int raw_size;
+	unsigned long long int num_blocks;
+	unsigned long long int index_offset;
+};
+#pragma pack(pop)
+
+struct nt_stream
+{
+	FILE *file;
+	int format;
+	// bzip2
+	BZFILE *bzfile;
+	int bz_eof;
+	// block compressed
+	unsigned int block_size;
+	unsigned long long int num_blocks;
+	unsigned long long int *block_index;
+	unsigned long long int next_block;
+	unsigned char *packed;
+	unsigned char *block;
+	unsigned int block_length;
+	unsigned int block_pos;
+	// first decode failure, or NULL; reads stop short once it is set
+	const char *error;
+};
+
+static int nt_stream_bz_open(nt_stream_t *stream, void *unused, int num_unused)
+{
+	int err;
+	stream->bzfile = BZ2_bzReadOpen(&err, stream->file, 0, 0, unused, num_unused);
+	if (err != BZ_OK)
+	{
+		stream->error = "failed to open bzip2 stream";
+		return 0;
+	}
+	stream->bz_eof = 0;
+	return 1;
+}
+
+static size_t nt_stream_bz_read(nt_stream_t *stream, unsigned char *buffer, size_t length)
+{
+	size_t total = 0;
+	while (total < length && !stream->bz_eof && stream->error == NULL)
+	{
+		int err;
+		int request = (length - total > (1 << 30)) ? (1 << 30) : (int)(length - total);
+		int got = BZ2_bzRead(&err, stream->bzfile, buffer + total, request);
+		if (err != BZ_OK && err != BZ_STREAM_END)
+		{
+			stream->error = "failed to decompress bzip2 trace";
+			break;
+		}
+		total += got;
+		if (err == BZ_STREAM_END)
+		{
+			// Parallel compressors emit concatenated streams; continue with
+			// the next one from the bytes the library has already read
+			void *unused;
+			int num_unused;
+			char leftover[BZ_MAX_UNUSED];
+			BZ2_bzReadGetUnused(&err, stream->bzfile, &unused, &num_unused);
+			memcpy(leftover, unused, num_unused);
+			BZ2_bzReadClose(&err, stream->bzfile);
+			stream->bzfile = NULL;
+			if (num_unused == 0)
+			{
+				int c = fgetc(stream->file);
+				if (c == EOF)
+				{
+					stream->bz_eof = 1;
+					break;
+				}
+				ungetc(c, stream->file);
+			}
+			if (!nt_stream_bz_open(stream, leftover, num_unused))
+			{
+				break;
+			}
+		}
+	}
+	return total;
+}
+
+static int nt_stream_load_block(nt_stream_t *stream, unsigned long long int block)
+{
+	unsigned int sizes[2];
+	uLongf raw_size;
+	if (fseeko(stream->file, stream->block_index[block], SEEK_SET) ||
+		fread(sizes, sizeof(unsigned int), 2, stream->file) != 2 ||
+		sizes[0] > compressBound(stream->block_size) || sizes[1] > stream->block_size ||
+		fread(stream->packed, 1, sizes[0], stream->file) != sizes[0])
+	{
+		stream->error = "failed to read trace block";
+		return 0;
+	}
+	raw_size = stream->block_size;
+	if (uncompress(stream->block, &raw_size, stream->packed, sizes[0]) != Z_OK || raw_size != sizes[1])
+	{
+		stream->error = "failed to decompress trace block";
+		return 0;
+	}
+	stream->block_length = sizes[1];
+	stream->block_pos = 0;
+	stream->next_block = block + 1;
+	return 1;
+}
+
+nt_stream_t *nt_stream_open(const char *filename)
+{
+	unsigned char magic[8];
+	size_t got;
+	nt_stream_t *stream = (nt_stream_t *)nt_checked_malloc(sizeof(nt_stream_t));
+	memset(stream, 0, sizeof(nt_stream_t));
+	stream->file = fopen(filename, "rb");
+	if (stream->file == NULL)
+	{
+		nt_error("failed to open trace file");
+	}
+	got = fread(magic, 1, sizeof(magic), stream->file);
+	if (got == sizeof(magic) && !memcmp(magic, NT_BLOCK_MAGIC, 8))
+	{
+		struct nt_block_header_pack header;
+		stream->format = NT_FORMAT_BLOCK;
+		if (fseeko(stream->file, 0, SEEK_SET) ||
+			fread(&header, sizeof(header), 1, stream->file) != 1)
+		{
+			nt_error("failed to read block trace header");
+		}
+		stream->block_size = header.block_size;
+		stream->num_blocks = header.num_blocks;
+		stream->block_index = (unsigned long long int *)nt_checked_malloc((header.num_blocks + 1) * sizeof(unsigned long long int));
+		if (fseeko(stream->file, header.index_offset, SEEK_SET) ||
+			fread(stream->block_index, sizeof(unsigned long long int), header.num_blocks, stream->file) != header.num_blocks)
+		{
+			nt_error("failed to read block trace index");
+		}
+		stream->packed = (unsigned char *)nt_checked_malloc(compressBound(stream->block_size));
+		stream->block = (unsigned char *)nt_checked_malloc(stream->block_size);
+		nt_stream_seek(stream, 0);
+	}
+	else if (got >= 3 && magic[0] == 'B' && magic[1] == 'Z' && magic[2] == 'h')
+	{
+		stream->format = NT_FORMAT_BZIP2;
+		fseeko(stream->file, 0, SEEK_SET);
+		if (!nt_stream_bz_open(stream, NULL, 0))
+		{
+			nt_error(stream->error);
+		}
+	}
+	else
+	{
+		stream->format = NT_FORMAT_RAW;
+		fseeko(stream->file, 0, SEEK_SET);
+	}
+	return stream;
+}
+
+size_t nt_stream_read(nt_stream_t *stream, void *buffer, size_t length)
+{
+	size_t total = 0;
+	switch (stream->format)
+	{
+	case NT_FORMAT_BZIP2:
+		return nt_stream_bz_read(stream, (unsigned char *)buffer, length);
+	case NT_FORMAT_BLOCK:
+		while (total < length)
+		{
+			size_t chunk;
+			if (stream->block_pos == stream->block_length)
+			{
+				if (stream->next_block >= stream->num_blocks ||
+					!nt_stream_load_block(stream, stream->next_block))
+				{
+					break;
+				}
+			}
+			chunk = stream->block_length - stream->block_pos;
+			if (chunk > length - total)
+			{
+				chunk = length - total;
+			}
+			memcpy((unsigned char *)buffer + total, stream->block + stream->block_pos, chunk);
+			stream->block_pos += chunk;
+			total += chunk;
+		}
+		return total;
+	default:
+		total = fread(buffer, 1, length, stream->file);
+		if (total < length && ferror(stream->file))
+		{
+			stream->error = "failed to read trace file";
+		}
+		return total;
+	}
+}
+
+void nt_stream_seek(nt_stream_t *stream, unsigned long long int offset)
+{
+	int err;
+	unsigned long long int block;
+	switch (stream->format)
+	{
+	case NT_FORMAT_BZIP2:
+		// bzip2 has no random access: restart and decompress up to offset
+		if (stream->bzfile != NULL)
+		{
+			BZ2_bzReadClose(&err, stream->bzfile);
+		}
+		fseeko(stream->file, 0, SEEK_SET);
+		if (!nt_stream_bz_open(stream, NULL, 0))
+		{
+			nt_error(stream->error);
+		}
+		{
+			unsigned char buffer[65536];
+			while (offset > 0)
+			{
+				size_t length = (offset > sizeof(buffer)) ? sizeof(buffer) : (size_t)offset;
+				if (nt_stream_bz_read(stream, buffer, length) != length)
+				{
+					nt_error(stream->error ? stream->error : "seek past end of trace file");
+				}
+				offset -= length;
+			}
+		}
+		break;
+	case NT_FORMAT_BLOCK:
+		block = offset / stream->block_size;
+		stream->block_length = stream->block_pos = 0;
+		stream->next_block = block;
+		if (block < stream->num_blocks)
+		{
+			if (!nt_stream_load_block(stream, block))
+			{
+				nt_error(stream->error);
+			}
+			stream->block_pos = (unsigned int)(offset % stream->block_size);
+			if (stream->block_pos > stream->block_length)
+			{
+				nt_error("seek past end of trace file");
+			}
+		}
+		break;
+	default:
+		if (fseeko(stream->file, offset, SEEK_SET))
+		{
+			nt_error("seek past end of trace file");
+		}
+		break;
+	}
+}
+
+const char *nt_stream_error(nt_stream_t *stream)
+{
+	return stream->error;
+}
+
+void nt_stream_close(nt_stream_t *stream)
+{
+	int err;
+	if (stream != NULL)
+	{
+		if (stream->bzfile != NULL)
+		{
+			BZ2_bzReadClose(&err, stream->bzfile);
+		}
+		fclose(stream->file);
+		free(stream->block_index);
+		free(stream->packed);
+		free(stream->block);
+		free(stream);
+	}
+}
+
+void nt_stream_convert(const char *in_filename, const char *out_filename, unsigned int block_size)
+{
+	struct nt_block_header_pack header;
+	unsigned long long int capacity = 1024;
+	unsigned long long int *index = (unsigned long long int *)nt_checked_malloc(capacity * sizeof(unsigned long long int));
+	unsigned char *raw = (unsigned char *)nt_checked_malloc(block_size);
+	uLongf bound = compressBound(block_size);
+	unsigned char *packed = (unsigned char *)nt_checked_malloc(bound);
+	nt_stream_t *in = nt_stream_open(in_filename);
+	FILE *out = fopen(out_filename, "wb");
+	size_t got;
+	if (out == NULL)
+	{
+		nt_error("failed to open output trace file");
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, NT_BLOCK_MAGIC, 8);
+	header.block_size = block_size;
+	fwrite(&header, sizeof(header), 1, out);
+	while ((got = nt_stream_read(in, raw, block_size)) > 0)
+	{
+		unsigned int sizes[2];
+		uLongf packed_size = bound;
+		if (compress2(packed, &packed_size, raw, got, Z_BEST_SPEED) != Z_OK)
+		{
+			nt_error("failed to compress trace block");
+		}
+		if (header.num_blocks == capacity)
+		{
+			capacity *= 2;
+			index = (unsigned long long int *)realloc(index, capacity * sizeof(unsigned long long int));
+			if (index == NULL)
+			{
+				nt_error("failed to grow block index");
+			}
+		}
+		index[header.num_blocks++] = (unsigned long long int)ftello(out);
+		sizes[0] = (unsigned int)packed_size;
+		sizes[1] = (unsigned int)got;
+		fwrite(sizes, sizeof(unsigned int), 2, out);
+		fwrite(packed, 1, packed_size, out);
+		header.raw_size += got;
+	}
+	if (in->error != NULL)
+	{
+		nt_error(in->error);
+	}
+	header.index_offset = (unsigned long long int)ftello(out);
+	fwrite(index, sizeof(unsigned long long int), header.num_blocks, out);
+	fseeko(out, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, out);
+	if (fclose(out))
+	{
+		nt_error("failed to write output trace file");
+	}
+	nt_stream_close(in);
+	free(index);
+	free(raw);
+	free(packed);
+}
@@ -0,0 +1,29 @@
+#ifndef NT_STREAM_H_
+#define NT_STREAM_H_
+
+#include <stdio.h>
+
+// Decompressed byte stream over a trace file. Three on-disk formats are
+// accepted and told apart by their leading bytes:
+//   - bzip2 compressed traces, as distributed, decoded in-process
+//   - uncompressed traces
+//   - block compressed traces written by nt_stream_convert: fixed-size
+//     chunks of the uncompressed trace, each compressed with zlib, followed
+//     by an index of chunk offsets so that any offset can be reached by
+//     decompressing a single chunk
+#define NT_BLOCK_MAGIC "NTBLKZ01"
+#define NT_BLOCK_SIZE (1 << 20)
+
+typedef struct nt_stream nt_stream_t;
+
+nt_stream_t *nt_stream_open(const char *);
+size_t nt_stream_read(nt_stream_t *, void *, size_t);
+// Why the last read came up short of the end of the trace, or NULL
+const char *nt_stream_error(nt_stream_t *);
+void nt_stream_seek(nt_stream_t *, unsigned long long int);
+void nt_stream_close(nt_stream_t *);
+
+// Rewrite any readable trace as a block compressed trace
+void nt_stream_convert(const char *, const char *, unsigned int);
+
+#endif /*NT_STREAM_H_*/
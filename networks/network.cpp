@@ -34,12 +34,17 @@
 
 #include <cassert>
 #include <sstream>
+#include <limits>
+#include <algorithm>
+#include <map>
 
 //Orion Power Support
 #include <fstream>
 
 #include "booksim.hpp"
 #include "network.hpp"
+#include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -57,10 +62,50 @@ Network::Network(const Configuration &config, const string &name) : TimedModule(
   _nodes = -1;
   _channels = -1;
   _classes = config.GetLongInt("classes");
+
+  _event_driven = false;
+  _threads = 1;
+  string const kernel = config.GetStr("sim_kernel");
+  if (kernel == "event")
+  {
+    _event_driven = true;
+  }
+  else if ((kernel == "parallel") || (kernel == "pdes"))
+  {
+    _event_driven = (kernel == "pdes");
+    _threads = config.GetLongInt("sim_threads");
+    if (_threads <= 0)
+    {
+      _threads = thread::hardware_concurrency();
+    }
+    if (!config.GetLongInt("random_streams") &&
+        ((config.GetStr("vc_allocator") == "pim") || (config.GetStr("sw_allocator") == "pim")))
+    {
+      Error("The pim allocator draws from the shared random number generator and needs random_streams=1 with sim_kernel=" + kernel + ".");
+    }
+  }
+  else if (kernel != "tick")
+  {
+    Error("Unknown sim_kernel: " + kernel);
+  }
+  _cycle = -1;
+  _stepping = false;
+  _job = 0;
+  _job_done = 0;
+  _job_phase = 0;
 }
 
 Network::~Network()
 {
+  if (!_workers.empty())
+  {
+    _job_phase = -1;
+    _job.fetch_add(1, memory_order_release);
+    for (size_t w = 0; w < _workers.size(); ++w)
+    {
+      _workers[w].join();
+    }
+  }
   for (long long int r = 0; r < _size; ++r)
   {
     if (_routers[r])
@@ -216,33 +261,382 @@ void Network::_Alloc()
   }
 }
 
-void Network::ReadInputs()
+void Network::_BuildGraph()
+{
+  map<TimedModule const *, long long int> index;
+  for (size_t m = 0; m < _timed_modules.size(); ++m)
+  {
+    index[_timed_modules[m]] = m;
+  }
+
+  _module_next.assign(_timed_modules.size(), numeric_limits<long long int>::max());
+  _module_last.assign(_timed_modules.size(), -1);
+  _module_reader.assign(_timed_modules.size(), -1);
+  _module_writes.assign(_timed_modules.size(), vector<long long int>());
+
+  for (long long int r = 0; r < _size; ++r)
+  {
+    long long int const m = index[_routers[r]];
+    vector<FlitChannel *> const &inputs = _routers[r]->GetInputChannels();
+    vector<CreditChannel *> const &input_credits = _routers[r]->GetInputCredits();
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+      _module_reader[index[inputs[i]]] = m;
+      _module_writes[m].push_back(index[input_credits[i]]);
+    }
+    vector<FlitChannel *> const &outputs = _routers[r]->GetOutputChannels();
+    vector<CreditChannel *> const &output_credits = _routers[r]->GetOutputCredits();
+    for (size_t o = 0; o < outputs.size(); ++o)
+    {
+      _module_writes[m].push_back(index[outputs[o]]);
+      _module_reader[index[output_credits[o]]] = m;
+    }
+  }
+
+  _inject_module.resize(_nodes);
+  _eject_cred_module.resize(_nodes);
+  for (long long int n = 0; n < _nodes; ++n)
+  {
+    _inject_module[n] = index[_inject[n]];
+    _eject_cred_module[n] = index[_eject_cred[n]];
+  }
+}
+
+void Network::_BuildPartitions()
+{
+  _BuildGraph();
+  _threads = max(1LL, min(_threads, _size));
+
+  // routers are split into contiguous blocks; each channel goes with the
+  // router that reads it, or with the one that writes it if it leaves the
+  // network
+  _module_partition.assign(_timed_modules.size(), 0);
+  for (size_t m = 0; m < _timed_modules.size(); ++m)
+  {
+    Router const *const router = dynamic_cast<Router const *>(_timed_modules[m]);
+    if (router)
+    {
+      long long int const p = router->GetID() * _threads / _size;
+      _module_partition[m] = p;
+      for (vector<long long int>::const_iterator write = _module_writes[m].begin();
+           write != _module_writes[m].end();
+           ++write)
+      {
+        _module_partition[*write] = p;
+      }
+    }
+  }
+  for (size_t m = 0; m < _timed_modules.size(); ++m)
+  {
+    if (_module_reader[m] >= 0)
+    {
+      _module_partition[m] = _module_partition[_module_reader[m]];
+    }
+  }
+
+  _partitions.assign(_threads, vector<TimedModule *>());
+  for (size_t m = 0; m < _timed_modules.size(); ++m)
+  {
+    _partitions[_module_partition[m]].push_back(_timed_modules[m]);
+  }
+
+  if (_event_driven)
+  {
+    _events.resize(_threads);
+    _active_modules.resize(_threads);
+    _remote_wakes.resize(_threads);
+    // a channel written from another partition may be sent to while it is
+    // being stepped, so it is only rescheduled after the phase
+    _module_shared.assign(_timed_modules.size(), false);
+    for (size_t m = 0; m < _timed_modules.size(); ++m)
+    {
+      for (vector<long long int>::const_iterator write = _module_writes[m].begin();
+           write != _module_writes[m].end();
+           ++write)
+      {
+        if (_module_partition[*write] != _module_partition[m])
+        {
+          _module_shared[*write] = true;
+        }
+      }
+    }
+    // every module is stepped on the first cycle
+    for (size_t m = 0; m < _timed_modules.size(); ++m)
+    {
+      _ScheduleAt(m, _cycle);
+    }
+  }
+
+  for (long long int p = 1; p < _threads; ++p)
+  {
+    _workers.push_back(thread(&Network::_Worker, this, p, SimContext::Current()));
+  }
+}
+
+void Network::_RunPartition(long long int p, int phase)
 {
-  for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-       iter != _timed_modules.end();
+  if (!_event_driven)
+  {
+    vector<TimedModule *> const &modules = _partitions[p];
+    if (phase == 0)
+    {
+      for (vector<TimedModule *>::const_iterator iter = modules.begin();
+           iter != modules.end();
+           ++iter)
+      {
+        (*iter)->ReadInputs();
+      }
+    }
+    else
+    {
+      // Evaluate only touches state local to each module, so a partition
+      // can move on to its outputs without waiting for the others
+      for (vector<TimedModule *>::const_iterator iter = modules.begin();
+           iter != modules.end();
+           ++iter)
+      {
+        (*iter)->Evaluate();
+      }
+      for (vector<TimedModule *>::const_iterator iter = modules.begin();
+           iter != modules.end();
+           ++iter)
+      {
+        (*iter)->WriteOutputs();
+      }
+    }
+    return;
+  }
+
+  vector<long long int> &active = _active_modules[p];
+  if (phase == 0)
+  {
+    // stale entries are left in the queue when a module is rescheduled
+    // earlier
+    active.clear();
+    while (!_events[p].empty() && (_events[p].top().first <= _cycle))
+    {
+      long long int const cycle = _events[p].top().first;
+      long long int const m = _events[p].top().second;
+      _events[p].pop();
+      if (_module_next[m] == cycle)
+      {
+        _module_next[m] = numeric_limits<long long int>::max();
+        active.push_back(m);
+      }
+    }
+    // keep the order of the tick kernel
+    sort(active.begin(), active.end());
+
+    for (vector<long long int>::const_iterator iter = active.begin();
+         iter != active.end();
+         ++iter)
+    {
+      TimedModule *const module = _timed_modules[*iter];
+      long long int const idle = _cycle - _module_last[*iter] - 1;
+      if (idle > 0)
+      {
+        module->Idle(idle);
+      }
+      module->ReadInputs();
+    }
+    return;
+  }
+
+  for (vector<long long int>::const_iterator iter = active.begin();
+       iter != active.end();
        ++iter)
   {
-    (*iter)->ReadInputs();
+    _timed_modules[*iter]->Evaluate();
+  }
+  for (vector<long long int>::const_iterator iter = active.begin();
+       iter != active.end();
+       ++iter)
+  {
+    _timed_modules[*iter]->WriteOutputs();
+  }
+  for (vector<long long int>::const_iterator iter = active.begin();
+       iter != active.end();
+       ++iter)
+  {
+    long long int const m = *iter;
+    _module_last[m] = _cycle;
+    if (_module_shared[m])
+    {
+      _remote_wakes[p].push_back(m);
+    }
+    else
+    {
+      _Schedule(m);
+    }
+    // data presented on a channel is consumed by its reader on the next
+    // cycle; channels are placed with their reader
+    if ((_module_reader[m] >= 0) && _timed_modules[m]->HasOutput())
+    {
+      assert(_module_partition[_module_reader[m]] == p);
+      _ScheduleAt(_module_reader[m], _cycle + 1);
+    }
+    // channels written to by this module pick the data up on the next
+    // cycle; those owned by another partition are woken after the phase
+    for (vector<long long int>::const_iterator write = _module_writes[m].begin();
+         write != _module_writes[m].end();
+         ++write)
+    {
+      if (_module_partition[*write] == p)
+      {
+        _Schedule(*write);
+      }
+      else
+      {
+        _remote_wakes[p].push_back(*write);
+      }
+    }
   }
 }
 
+void Network::_Worker(long long int p, SimContext context)
+{
+  context.Install();
+  gRandomLocked = true;
+  long long int seen = 0;
+  while (true)
+  {
+    long long int job;
+    while ((job = _job.load(memory_order_acquire)) == seen)
+    {
+      this_thread::yield();
+    }
+    seen = job;
+    if (_job_phase < 0)
+    {
+      return;
+    }
+    _RunPartition(p, _job_phase);
+    _job_done.fetch_add(1, memory_order_acq_rel);
+  }
+}
+
+void Network::_RunPhase(int phase)
+{
+  if (_threads == 1)
+  {
+    _RunPartition(0, phase);
+    return;
+  }
+  gRandomLocked = true;
+  _job_phase = phase;
+  _job_done.store(0, memory_order_relaxed);
+  _job.fetch_add(1, memory_order_release);
+  _RunPartition(0, phase);
+  while (_job_done.load(memory_order_acquire) < _threads - 1)
+  {
+    this_thread::yield();
+  }
+  gRandomLocked = false;
+}
+
+void Network::_ScheduleAt(long long int m, long long int cycle)
+{
+  if (cycle < _module_next[m])
+  {
+    _module_next[m] = cycle;
+    _events[_module_partition[m]].push(make_pair(cycle, m));
+  }
+}
+
+void Network::_Schedule(long long int m)
+{
+  long long int const time = _timed_modules[m]->NextEventTime();
+  if (time != numeric_limits<long long int>::max())
+  {
+    _ScheduleAt(m, _cycle + time - GetSimTime());
+  }
+}
+
+void Network::ReadInputs()
+{
+  if (!_event_driven && (_threads == 1))
+  {
+    for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+         iter != _timed_modules.end();
+         ++iter)
+    {
+      (*iter)->ReadInputs();
+    }
+    return;
+  }
+
+  ++_cycle;
+  if (_module_partition.empty())
+  {
+    _BuildPartitions();
+  }
+
+  // the event kernels only synchronize the partitions on cycles where some
+  // module is due; the pending stage and channel delays bound how far ahead
+  // that is
+  if (_event_driven)
+  {
+    _stepping = false;
+    for (long long int p = 0; p < _threads; ++p)
+    {
+      if (!_events[p].empty() && (_events[p].top().first <= _cycle))
+      {
+        _stepping = true;
+        break;
+      }
+    }
+    if (!_stepping)
+    {
+      return;
+    }
+  }
+  _RunPhase(0);
+}
+
 void Network::Evaluate()
 {
-  for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-       iter != _timed_modules.end();
-       ++iter)
+  if (!_event_driven && (_threads == 1))
   {
-    (*iter)->Evaluate();
+    for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+         iter != _timed_modules.end();
+         ++iter)
+    {
+      (*iter)->Evaluate();
+    }
   }
+  // otherwise evaluated together with the outputs
 }
 
 void Network::WriteOutputs()
 {
-  for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-       iter != _timed_modules.end();
-       ++iter)
+  if (!_event_driven && (_threads == 1))
   {
-    (*iter)->WriteOutputs();
+    for (deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+         iter != _timed_modules.end();
+         ++iter)
+    {
+      (*iter)->WriteOutputs();
+    }
+    return;
+  }
+
+  if (_event_driven && !_stepping)
+  {
+    return;
+  }
+  _RunPhase(1);
+  if (_event_driven)
+  {
+    for (long long int p = 0; p < _threads; ++p)
+    {
+      for (vector<long long int>::const_iterator write = _remote_wakes[p].begin();
+           write != _remote_wakes[p].end();
+           ++write)
+      {
+        _Schedule(*write);
+      }
+      _remote_wakes[p].clear();
+    }
   }
 }
 
@@ -250,6 +644,10 @@ void Network::WriteFlit(Flit *f, long long int source)
 {
   assert((source >= 0) && (source < _nodes));
   _inject[source]->Send(f);
+  if (_event_driven && !_module_partition.empty())
+  {
+    _ScheduleAt(_inject_module[source], _cycle + 1);
+  }
 }
 
 Flit *Network::ReadFlit(long long int dest)
@@ -262,6 +660,10 @@ void Network::WriteCredit(Credit *c, long long int dest)
 {
   assert((dest >= 0) && (dest < _nodes));
   _eject_cred[dest]->Send(c);
+  if (_event_driven && !_module_partition.empty())
+  {
+    _ScheduleAt(_eject_cred_module[dest], _cycle + 1);
+  }
 }
 
 Credit *Network::ReadCredit(long long int source)
@@ -290,6 +692,54 @@ double Network::Capacity() const
  * neceesary of the network, by default, call display on each router
  * and display the channel utilization rate
  */
+void Network::SettleIdle()
+{
+  if (!_event_driven || _module_last.empty())
+  {
+    return;
+  }
+  for (size_t m = 0; m < _timed_modules.size(); ++m)
+  {
+    long long int const idle = _cycle - _module_last[m];
+    if (idle > 0)
+    {
+      _timed_modules[m]->Idle(idle);
+      _module_last[m] = _cycle;
+    }
+  }
+}
+
+void Network::Serialize(Checkpoint &cp)
+{
+  cp.Check(_nodes, "nodes");
+  cp.Check(_size, "routers");
+  cp.Check(_channels, "channels");
+  cp.Check(_classes, "classes");
+
+  // the saved state is the one the tick kernel would have
+  if (cp.Saving())
+  {
+    SettleIdle();
+  }
+
+  for (long long int r = 0; r < _size; ++r)
+  {
+    _routers[r]->Serialize(cp);
+  }
+  for (long long int n = 0; n < _nodes; ++n)
+  {
+    _inject[n]->Serialize(cp);
+    _inject_cred[n]->Serialize(cp);
+    _eject[n]->Serialize(cp);
+    _eject_cred[n]->Serialize(cp);
+  }
+  for (long long int c = 0; c < _channels; ++c)
+  {
+    _chan[c]->Serialize(cp);
+    _chan_cred[c]->Serialize(cp);
+  }
+}
+
 void Network::Display(ostream &os) const
 {
   for (long long int r = 0; r < _size; ++r)
@@ -391,6 +841,7 @@ void Network::_PowerReports(int report_mode, string fileout, long long power_tim
   {
     for (int r = 0; r < _size; r++)
     {
+      _routers[r]->FlushOrionActivity();
 
       total_number_of_crossed_flits += _routers[r]->_number_of_crossed_flits;
       total_number_of_crossed_headerFlits += _routers[r]->_number_of_crossed_headerFlits;
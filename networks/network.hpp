@@ -30,6 +30,10 @@
 
 #include <vector>
 #include <deque>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <atomic>
 
 #include "module.hpp"
 #include "flit.hpp"
@@ -75,11 +79,51 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // event-driven kernels: only modules with work due are stepped on a given
+  // cycle; the cycles a module skips are settled through Idle() when it is
+  // stepped again. Cycles are counted locally so that the schedule survives
+  // the simulation time being reset between runs.
+  bool _event_driven;
+  bool _stepping;
+  long long int _cycle;
+  vector<long long int> _module_next;
+  vector<long long int> _module_last;
+  vector<long long int> _module_reader;
+  vector<vector<long long int>> _module_writes;
+  vector<long long int> _inject_module;
+  vector<long long int> _eject_cred_module;
+
+  // parallel kernels: modules are partitioned across threads and each phase
+  // of a cycle is run by all partitions, with the caller as partition 0;
+  // each partition keeps its own schedule under the event-driven kernel
+  long long int _threads;
+  vector<long long int> _module_partition;
+  vector<vector<TimedModule *>> _partitions;
+  vector<priority_queue<pair<long long int, long long int>,
+                        vector<pair<long long int, long long int>>,
+                        greater<pair<long long int, long long int>>>>
+      _events;
+  vector<vector<long long int>> _active_modules;
+  vector<vector<long long int>> _remote_wakes;
+  vector<bool> _module_shared;
+  vector<thread> _workers;
+  atomic<long long int> _job;
+  atomic<long long int> _job_done;
+  int _job_phase;
+
   virtual void _ComputeSize(const Configuration &config) = 0;
   virtual void _BuildNet(const Configuration &config) = 0;
 
   void _Alloc();
 
+  void _BuildGraph();
+  void _BuildPartitions();
+  void _RunPartition(long long int p, int phase);
+  void _RunPhase(int phase);
+  void _Worker(long long int p, SimContext context);
+  void _Schedule(long long int m);
+  void _ScheduleAt(long long int m, long long int cycle);
+
 public:
   Network(const Configuration &config, const string &name);
   virtual ~Network();
@@ -103,6 +147,14 @@ public:
   virtual void Evaluate();
   virtual void WriteOutputs();
 
+  // modules the event kernels have skipped catch up on their idle cycles,
+  // so that their counters read as under the tick kernel
+  void SettleIdle();
+
+  // saves or restores the state of the routers and channels; a restored
+  // network is stepped as if it had just been built
+  void Serialize(Checkpoint &cp);
+
   void Display(ostream &os = cout) const;
   void DumpChannelMap(ostream &os = cout, string const &prefix = "") const;
   void DumpNodeMap(ostream &os = cout, string const &prefix = "") const;
@@ -289,6 +289,37 @@ int SIM_arbiter_record(SIM_arbiter_t *arb, LIB_Type_max_uint new_req, LIB_Type_m
 	return 0;
 }
 
+/* record n_record arbitrations at once; n_chg_req and n_chg_grant are the
+ * summed request Hamming distances and grant changes of those arbitrations */
+int SIM_arbiter_record_n(SIM_arbiter_t *arb, LIB_Type_max_uint n_record, LIB_Type_max_uint n_chg_req, LIB_Type_max_uint n_chg_grant)
+{
+	switch (arb->model)
+	{
+	case MATRIX_ARBITER:
+		arb->n_chg_req += n_chg_req;
+		arb->n_chg_grant += n_chg_grant;
+		arb->n_chg_mint += n_record * ((arb->req_width - 1) * arb->req_width / 2);
+		arb->pri_ff.n_switch += n_record * ((arb->req_width - 1) / 2);
+		break;
+
+	case RR_ARBITER:
+		arb->n_chg_req += n_chg_req;
+		arb->n_chg_grant += n_chg_grant;
+		arb->n_chg_carry += n_record * (arb->req_width / 2);
+		arb->n_chg_carry_in += n_record * (arb->req_width / 2 - 1);
+		arb->pri_ff.n_switch += n_record * 2;
+		break;
+
+	case QUEUE_ARBITER:
+		break;
+
+	default:
+		printf("error arbiter 292 : %d \n", arb->model); /* some error handler */
+	}
+
+	return 0;
+}
+
 double SIM_arbiter_report(SIM_arbiter_t *arb)
 {
 	switch (arb->model)
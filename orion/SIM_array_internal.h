@@ -206,12 +206,15 @@ extern int SIM_array_dec_record(SIM_array_dec_t *dec, LIB_Type_max_uint prev_add
 extern int SIM_array_wordline_record(SIM_array_wordline_t *wordline, int rw, LIB_Type_max_uint n_switch);
 extern int SIM_array_bitline_record(SIM_array_bitline_t *bitline, int rw, u_int cols, LIB_Type_max_uint old_value, LIB_Type_max_uint new_value);
 extern int SIM_array_amp_record(SIM_array_amp_t *amp, u_int cols);
+extern int SIM_array_bitline_record_n(SIM_array_bitline_t *bitline, int rw, u_int cols, LIB_Type_max_uint old_value, LIB_Type_max_uint new_value, LIB_Type_max_uint n);
+extern int SIM_array_amp_record_n(SIM_array_amp_t *amp, u_int cols, LIB_Type_max_uint n);
 extern int SIM_array_comp_global_record(SIM_array_comp_t *comp, LIB_Type_max_uint prev_value, LIB_Type_max_uint curr_value, int miss);
 extern int SIM_array_comp_local_record(SIM_array_comp_t *comp, LIB_Type_max_uint prev_tag, LIB_Type_max_uint curr_tag, LIB_Type_max_uint input, int recover);
 extern int SIM_array_mux_record(SIM_array_mux_t *mux, LIB_Type_max_uint prev_addr, LIB_Type_max_uint curr_addr, int miss);
 extern int SIM_array_outdrv_global_record(SIM_array_out_t *outdrv, LIB_Type_max_uint data);
 extern int SIM_array_outdrv_local_record(SIM_array_out_t *outdrv, LIB_Type_max_uint prev_data, LIB_Type_max_uint curr_data, int recover);
 extern int SIM_array_mem_record(SIM_array_mem_t *mem, LIB_Type_max_uint prev_value, LIB_Type_max_uint curr_value, u_int cols);
+extern int SIM_array_mem_record_n(SIM_array_mem_t *mem, LIB_Type_max_uint prev_value, LIB_Type_max_uint curr_value, u_int cols, LIB_Type_max_uint n);
 extern int SIM_array_pre_record(SIM_array_pre_t *pre, LIB_Type_max_uint n_charge);
 
 /* structural-level report functions */
@@ -669,6 +669,29 @@ int SIM_array_bitline_record(SIM_array_bitline_t *bitline, int rw, u_int cols, L
 	return 0;
 }
 
+/* record n identical bitline accesses at once */
+int SIM_array_bitline_record_n(SIM_array_bitline_t *bitline, int rw, u_int cols, LIB_Type_max_uint old_value, LIB_Type_max_uint new_value, LIB_Type_max_uint n)
+{
+	LIB_Type_max_uint mask = HAMM_MASK(cols);
+
+	if (rw)
+	{
+		if (bitline->share_rw)
+			bitline->n_col_write += n * cols;
+		else
+			bitline->n_col_write += n * SIM_Hamming(old_value, new_value, mask);
+	}
+	else
+	{
+		if (bitline->end == 2)
+			bitline->n_col_read += n * cols;
+		else
+			bitline->n_col_read += n * SIM_Hamming(mask, ~new_value, mask);
+	}
+
+	return 0;
+}
+
 double SIM_array_bitline_report(SIM_array_bitline_t *bitline)
 {
 	return (bitline->n_col_write * bitline->e_col_write +
@@ -713,6 +736,13 @@ int SIM_array_amp_record(SIM_array_amp_t *amp, u_int cols)
 	return 0;
 }
 
+int SIM_array_amp_record_n(SIM_array_amp_t *amp, u_int cols, LIB_Type_max_uint n)
+{
+	amp->n_access += n * cols;
+
+	return 0;
+}
+
 double SIM_array_amp_report(SIM_array_amp_t *amp)
 {
 	return (amp->n_access * amp->e_access);
@@ -1184,6 +1214,13 @@ int SIM_array_mem_record(SIM_array_mem_t *mem, LIB_Type_max_uint prev_value, LIB
 	return 0;
 }
 
+int SIM_array_mem_record_n(SIM_array_mem_t *mem, LIB_Type_max_uint prev_value, LIB_Type_max_uint curr_value, u_int width, LIB_Type_max_uint n)
+{
+	mem->n_switch += n * SIM_Hamming(prev_value, curr_value, HAMM_MASK(width));
+
+	return 0;
+}
+
 double SIM_array_mem_report(SIM_array_mem_t *mem)
 {
 	return (mem->n_switch * mem->e_switch);
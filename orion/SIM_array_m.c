@@ -201,6 +201,75 @@ int SIM_array_data_write(SIM_array_info_t *info, SIM_array_t *arr, SIM_array_set
 	return 0;
 }
 
+/* record n wordline activities of accesses to row 0, as SIM_array_dec does
+ * for callers without port state; repeated accesses to one row leave the
+ * row decoder alone, so only the wordlines are counted */
+int SIM_array_dec_n(SIM_array_info_t *info, SIM_array_t *arr, int rw, LIB_Type_max_uint n)
+{
+	if (!IS_FULLY_ASSOC(info))
+	{
+		SIM_array_wordline_record(&arr->data_wordline, rw, n * info->data_ndwl);
+		if (HAVE_TAG(info))
+			SIM_array_wordline_record(&arr->tag_wordline, rw, n * info->tag_ndwl);
+
+		return 0;
+	}
+	else
+		return -1;
+}
+
+/* record n reads of the same data at once */
+int SIM_array_data_read_n(SIM_array_info_t *info, SIM_array_t *arr, LIB_Type_max_uint data, LIB_Type_max_uint n)
+{
+	if (info->data_end == 1)
+	{
+		SIM_array_bitline_record_n(&arr->data_bitline, SIM_ARRAY_READ, info->eff_data_cols, 0, data, n);
+
+		return 0;
+	}
+	else if (!IS_FULLY_ASSOC(info))
+	{
+		SIM_array_bitline_record_n(&arr->data_bitline, SIM_ARRAY_READ, info->eff_data_cols, 0, 0, n);
+		SIM_array_amp_record_n(&arr->data_amp, info->eff_data_cols, n);
+
+		return 0;
+	}
+	else
+		return -1;
+}
+
+/* record n writes at once, each of them changing data_line and the memory
+ * cells from old_data to new_data; data_line is updated once at the end */
+int SIM_array_data_write_n(SIM_array_info_t *info, SIM_array_t *arr, u_int n_item, u_char *data_line, u_char *old_data, u_char *new_data, LIB_Type_max_uint n)
+{
+	u_int i;
+
+	/* a fully-associative array needs the set state of each write */
+	if (IS_FULLY_ASSOC(info))
+		return -1;
+
+	if (info->share_rw)
+	{
+		SIM_array_bitline_record_n(&arr->data_bitline, SIM_ARRAY_WRITE, info->eff_data_cols, 0, 0, n);
+
+		if (IS_DIRECT_MAP(info) && info->data_ndbl > 1)
+			SIM_array_bitline_record_n(&arr->data_bitline, SIM_ARRAY_WRITE, n_item * 8 * (info->data_ndbl - 1), 0, 0, n);
+	}
+	else
+	{
+		for (i = 0; i < n_item; i++)
+		{
+			SIM_array_bitline_record_n(&arr->data_bitline, SIM_ARRAY_WRITE, 8, data_line[i], new_data[i], n);
+			data_line[i] = new_data[i];
+		}
+	}
+
+	for (i = 0; i < n_item; i++)
+		SIM_array_mem_record_n(&arr->data_mem, old_data[i], new_data[i], 8, n);
+
+	return 0;
+}
+
 /* record read tag activity (including bitline and sense amplifier) */
 /* only used by non-RF array */
 /* set only used by fully-associative array */
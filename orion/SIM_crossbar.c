@@ -410,6 +410,39 @@ int SIM_crossbar_record(SIM_crossbar_t *xb, int io, LIB_Type_max_uint new_data,
 	return 0;
 }
 
+/* record n_record identical transfers at once; n_chg_port of the output
+ * records changed the connected input port */
+int SIM_crossbar_record_n(SIM_crossbar_t *xb, int io, LIB_Type_max_uint new_data, LIB_Type_max_uint old_data, LIB_Type_max_uint n_record, LIB_Type_max_uint n_chg_port)
+{
+	switch (xb->model)
+	{
+	case MULTREE_CROSSBAR:
+	case MATRIX_CROSSBAR:
+		if (io) /* input port */
+			xb->n_chg_in += n_record * SIM_Hamming(new_data, old_data, xb->mask);
+		else
+		{ /* output port */
+			xb->n_chg_out += n_record * SIM_Hamming(new_data, old_data, xb->mask);
+			xb->n_chg_ctr += n_chg_port;
+		}
+		break;
+
+	case CUT_THRU_CROSSBAR:
+		if (io) /* input port */
+			xb->n_chg_in += n_record * SIM_Hamming(new_data, old_data, xb->mask);
+		else
+		{ /* output port */
+			xb->n_chg_ctr += n_chg_port;
+		}
+		break;
+
+	default:
+		printf("error crossbar 385\n"); /* some error handler */
+	}
+
+	return 0;
+}
+
 double SIM_crossbar_report(SIM_crossbar_t *crsbar)
 {
 	return (crsbar->n_chg_in * crsbar->e_chg_in + crsbar->n_chg_out * crsbar->e_chg_out +
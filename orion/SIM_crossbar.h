@@ -64,6 +64,7 @@ typedef struct
 int SIM_crossbar_init(SIM_crossbar_t *crsbar, int model, u_int n_in, u_int n_out, u_int in_seg, u_int out_seg, u_int data_width, u_int degree, int connect_type, int trans_type, double in_len, double out_len, double *req_len);
 
 int SIM_crossbar_record(SIM_crossbar_t *xb, int io, LIB_Type_max_uint new_data, LIB_Type_max_uint old_data, u_int new_port, u_int old_port);
+int SIM_crossbar_record_n(SIM_crossbar_t *xb, int io, LIB_Type_max_uint new_data, LIB_Type_max_uint old_data, LIB_Type_max_uint n_record, LIB_Type_max_uint n_chg_port);
 
 double SIM_crossbar_report(SIM_crossbar_t *crsbar);
 
@@ -10,47 +10,49 @@
 #ifndef _SIM_PORT_H
 #define _SIM_PORT_H
 extern int Flexus_Orion_init(const Configuration &BookCfg);
+/* the parameters below are per thread, so that the simulations of a sweep
+ * each model power with their own */
 /*Technology related parameters */
 #define PARM_TECH_POINT 65
 #define PARM_TRANSISTOR_TYPE NVT /* transistor type, HVT, NVT, or LVT */
 //#define PARM_Vdd              1.0
-extern double PARM_Vdd; //             1.0
+extern thread_local double PARM_Vdd; //             1.0
 //double PARM_Vdd =            1.0;
-extern double PARM_Freq; //             0.746e9
+extern thread_local double PARM_Freq; //             0.746e9
 #define PARM_VDD_V PARM_Vdd
 #define PARM_FREQ_Hz PARM_Freq
-extern double PARM_tr;
+extern thread_local double PARM_tr;
 
 /* router module parameters */
-extern int PARM_in_port;      // 		5	/* # of router input ports */
+extern thread_local int PARM_in_port;      // 		5	/* # of router input ports */
 #define PARM_cache_in_port 0  /* # of cache input ports */
 #define PARM_mc_in_port 0     /* # of memory controller input ports */
 #define PARM_io_in_port 0     /* # of I/O device input ports */
-extern int PARM_out_port;     //		5
+extern thread_local int PARM_out_port;     //		5
 #define PARM_cache_out_port 0 /* # of cache output ports */
 #define PARM_mc_out_port 0    /* # of memory controller output ports */
 #define PARM_io_out_port 0    /* # of I/O device output ports */
-extern int PARM_flit_width;   //		64	/* flit width in bits */
-extern float bitwidth64x;
+extern thread_local int PARM_flit_width;   //		64	/* flit width in bits */
+extern thread_local float bitwidth64x;
 
 /* virtual channel parameters */
-extern int PARM_v_class;   //       1   /* # of total message classes */
-extern int PARM_v_channel; //      1	/* # of virtual channels per virtual message class*/
+extern thread_local int PARM_v_class;   //       1   /* # of total message classes */
+extern thread_local int PARM_v_channel; //      1	/* # of virtual channels per virtual message class*/
 #define PARM_cache_class 0 /* # of cache port virtual classes */
 #define PARM_mc_class 0    /* # of memory controller port virtual classes */
 #define PARM_io_class 0    /* # of I/O device port virtual classes */
 /* ?? */
-extern int PARM_in_share_buf;  //	0	/* do input virtual channels physically share buffers? */
-extern int PARM_out_share_buf; //	0	/* do output virtual channels physically share buffers? */
+extern thread_local int PARM_in_share_buf;  //	0	/* do input virtual channels physically share buffers? */
+extern thread_local int PARM_out_share_buf; //	0	/* do output virtual channels physically share buffers? */
 /* ?? */
 #define PARM_in_share_switch 1  /* do input virtual channels share crossbar input ports? */
 #define PARM_out_share_switch 1 /* do output virtual channels share crossbar output ports? */
 
 /* crossbar parameters */
-extern int PARM_crossbar_model; //	MULTREE_CROSSBAR	/* crossbar model type MATRIX_CROSSBAR, MULTREE_CROSSBAR, or TRISTATE_CROSSBAR (only for Orion3.0)*/
-extern int PARM_crsbar_degree;  //	4					/* crossbar mux degree */
-extern int PARM_connect_type;   //	TRISTATE_GATE		/* crossbar connector type */
-extern int PARM_trans_type;     //		NP_GATE				/* crossbar transmission gate type */
+extern thread_local int PARM_crossbar_model; //	MULTREE_CROSSBAR	/* crossbar model type MATRIX_CROSSBAR, MULTREE_CROSSBAR, or TRISTATE_CROSSBAR (only for Orion3.0)*/
+extern thread_local int PARM_crsbar_degree;  //	4					/* crossbar mux degree */
+extern thread_local int PARM_connect_type;   //	TRISTATE_GATE		/* crossbar connector type */
+extern thread_local int PARM_trans_type;     //		NP_GATE				/* crossbar transmission gate type */
 #define PARM_crossbar_in_len 0  /* crossbar input line length, if known */
 #define PARM_crossbar_out_len 0 /* crossbar output line length, if known */
 #define PARM_xb_in_seg 0
@@ -61,10 +63,10 @@ extern int PARM_trans_type;     //		NP_GATE				/* crossbar transmission gate typ
 #define PARM_exp_out_seg 2
 
 /* input buffer parameters */
-extern int PARM_in_buf;         //			1		/* have input buffer? */
-extern int PARM_in_buf_set;     //		1
+extern thread_local int PARM_in_buf;         //			1		/* have input buffer? */
+extern thread_local int PARM_in_buf_set;     //		1
 #define PARM_in_buf_rport 1     /* # of read ports */
-extern int PARM_in_buffer_type; //SRAM	/*buffer model type, SRAM or REGISTER*/
+extern thread_local int PARM_in_buffer_type; //SRAM	/*buffer model type, SRAM or REGISTER*/
 
 #define PARM_cache_in_buf 0
 #define PARM_cache_in_buf_set 0
@@ -79,10 +81,10 @@ extern int PARM_in_buffer_type; //SRAM	/*buffer model type, SRAM or REGISTER*/
 #define PARM_io_in_buf_rport 0
 
 /* output buffer parameters */
-extern int PARM_out_buf;     //		0
-extern int PARM_out_buf_set; //		2
+extern thread_local int PARM_out_buf;     //		0
+extern thread_local int PARM_out_buf_set; //		2
 #define PARM_out_buf_wport 1
-extern int PARM_out_buffer_type; //  	SRAM		/*buffer model type, SRAM or REGISTER*/
+extern thread_local int PARM_out_buffer_type; //  	SRAM		/*buffer model type, SRAM or REGISTER*/
 
 /* central buffer parameters */
 #define PARM_central_buf 0 /* have central buffer? */
@@ -113,16 +115,16 @@ extern int PARM_out_buffer_type; //  	SRAM		/*buffer model type, SRAM or REGISTE
 //#define PARM_bitline_pre_model	SINGLE_OTHER
 
 /* switch allocator arbiter parameters */
-extern int PARM_sw_in_arb_model;         //	RR_ARBITER	/* input side arbiter model type, MATRIX_ARBITER , RR_ARBITER, QUEUE_ARBITER*/
+extern thread_local int PARM_sw_in_arb_model;         //	RR_ARBITER	/* input side arbiter model type, MATRIX_ARBITER , RR_ARBITER, QUEUE_ARBITER*/
 #define PARM_sw_in_arb_ff_model NEG_DFF  /* input side arbiter flip-flop model type */
-extern int PARM_sw_out_arb_model;        //	RR_ARBITER	/* output side arbiter model type, MATRIX_ARBITER */
+extern thread_local int PARM_sw_out_arb_model;        //	RR_ARBITER	/* output side arbiter model type, MATRIX_ARBITER */
 #define PARM_sw_out_arb_ff_model NEG_DFF /* output side arbiter flip-flop model type */
 
 /* virtual channel allocator arbiter parameters */
-extern int PARM_vc_allocator_type;       //	TWO_STAGE_ARB	/*vc allocator type, ONE_STAGE_ARB, TWO_STAGE_ARB, VC_SELECT*/
-extern int PARM_vc_in_arb_model;         //   	RR_ARBITER  /*input side arbiter model type for TWO_STAGE_ARB. MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER*/
+extern thread_local int PARM_vc_allocator_type;       //	TWO_STAGE_ARB	/*vc allocator type, ONE_STAGE_ARB, TWO_STAGE_ARB, VC_SELECT*/
+extern thread_local int PARM_vc_in_arb_model;         //   	RR_ARBITER  /*input side arbiter model type for TWO_STAGE_ARB. MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER*/
 #define PARM_vc_in_arb_ff_model NEG_DFF  /* input side arbiter flip-flop model type */
-extern int PARM_vc_out_arb_model;        //  	RR_ARBITER 	/*output side arbiter model type (for both ONE_STAGE_ARB and TWO_STAGE_ARB). MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER */
+extern thread_local int PARM_vc_out_arb_model;        //  	RR_ARBITER 	/*output side arbiter model type (for both ONE_STAGE_ARB and TWO_STAGE_ARB). MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER */
 #define PARM_vc_out_arb_ff_model NEG_DFF /* output side arbiter flip-flop model type */
 #define PARM_vc_select_buf_type REGISTER /* vc_select buffer type, SRAM or REGISTER */
 
@@ -431,6 +431,25 @@ int SIM_buf_power_data_write(SIM_array_info_t *info, SIM_array_t *arr, u_char *d
 	return 0;
 }
 
+/* record n reads of the same data at once */
+int SIM_buf_power_data_read_n(SIM_array_info_t *info, SIM_array_t *arr, LIB_Type_max_uint data, LIB_Type_max_uint n)
+{
+	SIM_array_pre_record(&arr->data_bitline_pre, n * info->blk_bits);
+	SIM_array_dec_n(info, arr, SIM_ARRAY_READ, n);
+	SIM_array_data_read_n(info, arr, data, n);
+
+	return 0;
+}
+
+/* record n writes at once, each as SIM_buf_power_data_write would */
+int SIM_buf_power_data_write_n(SIM_array_info_t *info, SIM_array_t *arr, u_char *data_line, u_char *old_data, u_char *new_data, LIB_Type_max_uint n)
+{
+	SIM_array_dec_n(info, arr, SIM_ARRAY_WRITE, n);
+	SIM_array_data_write_n(info, arr, N_ITEM, data_line, old_data, new_data, n);
+
+	return 0;
+}
+
 /* WHS: missing data output wrapper function */
 
 /* ==================== buffer (wrapper functions) ==================== */
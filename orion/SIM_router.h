@@ -174,6 +174,8 @@ extern int SIM_router_init(SIM_router_info_t *info, SIM_router_power_t *SIM_rout
 
 extern int SIM_buf_power_data_read(SIM_array_info_t *info, SIM_array_t *arr, LIB_Type_max_uint data);
 extern int SIM_buf_power_data_write(SIM_array_info_t *info, SIM_array_t *arr, u_char *data_line, u_char *old_data, u_char *new_data);
+extern int SIM_buf_power_data_read_n(SIM_array_info_t *info, SIM_array_t *arr, LIB_Type_max_uint data, LIB_Type_max_uint n);
+extern int SIM_buf_power_data_write_n(SIM_array_info_t *info, SIM_array_t *arr, u_char *data_line, u_char *old_data, u_char *new_data, LIB_Type_max_uint n);
 
 extern int SIM_router_power_init(SIM_router_info_t *info, SIM_router_power_t *router);
 extern int SIM_router_power_report(SIM_router_info_t *info, SIM_router_power_t *router);
@@ -3,32 +3,32 @@
 #include "SIM_link_model.h"
 #include <stdio.h>
 
-double PARM_Vdd;     //	=      	1.0;
-double PARM_tr;      //	= 	0.1 ;
-double PARM_Freq;    //	=	1e9;
-int PARM_in_port;    // 	=	5;
-int PARM_out_port;   //	=	5;
-int PARM_flit_width; //	=       128;
-float bitwidth64x = 1.0;
-int PARM_v_class;           //   =	1;   /* # of total message classes */
-int PARM_v_channel;         //=	2;	/* # of virtual channels per virtual message class*/
-int PARM_in_share_buf;      //=	0;	/* do input virtual channels physically share buffers? */
-int PARM_out_share_buf;     //=	0;	/* do output virtual channels physically share buffers? */
-int PARM_crossbar_model;    //=	MULTREE_CROSSBAR;	/* crossbar model type MATRIX_CROSSBAR, MULTREE_CROSSBAR, or TRISTATE_CROSSBAR (only for Orion3.0)*/
-int PARM_crsbar_degree;     //=	4;					/* crossbar mux degree */
-int PARM_connect_type;      //=	TRISTATE_GATE;		/* crossbar connector type */
-int PARM_trans_type;        //=	NP_GATE;
-int PARM_in_buf;            //=1;//			1		/* have input buffer? */
-int PARM_in_buf_set;        //=8;//		//number of buffer slots per VC per port, 0 is automatically converted to 1
-int PARM_in_buffer_type;    //= SRAM ;//SRAM	/*buffer model type, SRAM or REGISTER*/
-int PARM_out_buf;           //=0	;//		0
-int PARM_out_buf_set;       //=0;//		2
-int PARM_out_buffer_type;   //=SRAM;//  	SRAM		/*buffer model type, SRAM or REGISTER*/
-int PARM_sw_in_arb_model;   //= RR_ARBITER;//		/* input side arbiter model type, MATRIX_ARBITER , RR_ARBITER, QUEUE_ARBITER*/
-int PARM_sw_out_arb_model;  //=	RR_ARBITER;//	/* output side arbiter model type, MATRIX_ARBITER */
-int PARM_vc_allocator_type; //=	TWO_STAGE_ARB;//	/*vc allocator type, ONE_STAGE_ARB, TWO_STAGE_ARB, VC_SELECT*/
-int PARM_vc_in_arb_model;   //= 	RR_ARBITER;//    /*input side arbiter model type for TWO_STAGE_ARB. MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER*/
-int PARM_vc_out_arb_model;  // =	RR_ARBITER ;// 	/*output side arbiter model type (for both ONE_STAGE_ARB and TWO_STAGE_ARB). MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER */
+thread_local double PARM_Vdd;     //	=      	1.0;
+thread_local double PARM_tr;      //	= 	0.1 ;
+thread_local double PARM_Freq;    //	=	1e9;
+thread_local int PARM_in_port;    // 	=	5;
+thread_local int PARM_out_port;   //	=	5;
+thread_local int PARM_flit_width; //	=       128;
+thread_local float bitwidth64x = 1.0;
+thread_local int PARM_v_class;           //   =	1;   /* # of total message classes */
+thread_local int PARM_v_channel;         //=	2;	/* # of virtual channels per virtual message class*/
+thread_local int PARM_in_share_buf;      //=	0;	/* do input virtual channels physically share buffers? */
+thread_local int PARM_out_share_buf;     //=	0;	/* do output virtual channels physically share buffers? */
+thread_local int PARM_crossbar_model;    //=	MULTREE_CROSSBAR;	/* crossbar model type MATRIX_CROSSBAR, MULTREE_CROSSBAR, or TRISTATE_CROSSBAR (only for Orion3.0)*/
+thread_local int PARM_crsbar_degree;     //=	4;					/* crossbar mux degree */
+thread_local int PARM_connect_type;      //=	TRISTATE_GATE;		/* crossbar connector type */
+thread_local int PARM_trans_type;        //=	NP_GATE;
+thread_local int PARM_in_buf;            //=1;//			1		/* have input buffer? */
+thread_local int PARM_in_buf_set;        //=8;//		//number of buffer slots per VC per port, 0 is automatically converted to 1
+thread_local int PARM_in_buffer_type;    //= SRAM ;//SRAM	/*buffer model type, SRAM or REGISTER*/
+thread_local int PARM_out_buf;           //=0	;//		0
+thread_local int PARM_out_buf_set;       //=0;//		2
+thread_local int PARM_out_buffer_type;   //=SRAM;//  	SRAM		/*buffer model type, SRAM or REGISTER*/
+thread_local int PARM_sw_in_arb_model;   //= RR_ARBITER;//		/* input side arbiter model type, MATRIX_ARBITER , RR_ARBITER, QUEUE_ARBITER*/
+thread_local int PARM_sw_out_arb_model;  //=	RR_ARBITER;//	/* output side arbiter model type, MATRIX_ARBITER */
+thread_local int PARM_vc_allocator_type; //=	TWO_STAGE_ARB;//	/*vc allocator type, ONE_STAGE_ARB, TWO_STAGE_ARB, VC_SELECT*/
+thread_local int PARM_vc_in_arb_model;   //= 	RR_ARBITER;//    /*input side arbiter model type for TWO_STAGE_ARB. MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER*/
+thread_local int PARM_vc_out_arb_model;  // =	RR_ARBITER ;// 	/*output side arbiter model type (for both ONE_STAGE_ARB and TWO_STAGE_ARB). MATRIX_ARBITER, RR_ARBITER, QUEUE_ARBITER */
 //link wire parameters
 /*
 int 	WIRE_LAYER_TYPE =        INTERMEDIATE ;//wire layer type, INTERMEDIATE or GLOBAL
@@ -9,38 +9,50 @@
  */
 
 #include <cassert>
+#include <cstdlib>
+#include <iostream>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
-
-void OutputSet::Clear()
-{
-  _outputs.clear();
-}
-
-void OutputSet::Add(long long int output_port, long long int vc, long long int pri)
-{
-  AddRange(output_port, vc, vc, pri);
-}
+#include "checkpoint.hpp"
 
 void OutputSet::AddRange(long long int output_port, long long int vc_start, long long int vc_end, long long int pri)
 {
+  size_t pos = 0;
+  while ((pos < _size) && (_outputs[pos].pri > pri))
+  {
+    ++pos;
+  }
+  if ((pos < _size) && (_outputs[pos].pri == pri))
+  {
+    // an entry of this priority is already present
+    return;
+  }
+  if (_size == max_entries)
+  {
+    cerr << "OutputSet: more than " << max_entries << " route priorities." << endl;
+    exit(-1);
+  }
+  for (size_t i = _size; i > pos; --i)
+  {
+    _outputs[i] = _outputs[i - 1];
+  }
 
-  sSetElement s;
+  sSetElement &s = _outputs[pos];
 
   s.vc_start = vc_start;
   s.vc_end = vc_end;
   s.pri = pri;
   s.output_port = output_port;
-  _outputs.insert(s);
+  ++_size;
 }
 
 //legacy support, for performance, just use GetSet()
 long long int OutputSet::NumVCs(long long int output_port) const
 {
   long long int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin();
-  while (i != _outputs.end())
+  const_iterator i = begin();
+  while (i != end())
   {
     if (i->output_port == output_port)
     {
@@ -53,8 +65,8 @@ long long int OutputSet::NumVCs(long long int output_port) const
 
 bool OutputSet::OutputEmpty(long long int output_port) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin();
-  while (i != _outputs.end())
+  const_iterator i = begin();
+  while (i != end())
   {
     if (i->output_port == output_port)
     {
@@ -65,11 +77,6 @@ bool OutputSet::OutputEmpty(long long int output_port) const
   return true;
 }
 
-const set<OutputSet::sSetElement> &OutputSet::GetSet() const
-{
-  return _outputs;
-}
-
 //legacy support, for performance, just use GetSet()
 long long int OutputSet::GetVC(long long int output_port, long long int vc_index, long long int *pri) const
 {
@@ -83,8 +90,8 @@ long long int OutputSet::GetVC(long long int output_port, long long int vc_index
     *pri = -1;
   }
 
-  set<sSetElement>::const_iterator i = _outputs.begin();
-  while (i != _outputs.end())
+  const_iterator i = begin();
+  while (i != end())
   {
     if (i->output_port == output_port)
     {
@@ -115,12 +122,12 @@ bool OutputSet::GetPortVC(long long int *out_port, long long int *out_vc) const
   bool single_output = false;
   long long int used_outputs = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin();
-  if (i != _outputs.end())
+  const_iterator i = begin();
+  if (i != end())
   {
     used_outputs = i->output_port;
   }
-  while (i != _outputs.end())
+  while (i != end())
   {
 
     if (i->vc_start == i->vc_end)
@@ -144,3 +151,26 @@ bool OutputSet::GetPortVC(long long int *out_port, long long int *out_vc) const
   }
   return single_output;
 }
+
+void OutputSet::Serialize(Checkpoint &cp)
+{
+  size_t size = _size;
+  cp.Io(size);
+  if (cp.Restoring())
+  {
+    _size = 0;
+  }
+  for (size_t i = 0; i < size; ++i)
+  {
+    sSetElement s;
+    if (cp.Saving())
+    {
+      s = _outputs[i];
+    }
+    cp.Raw(&s, sizeof(s));
+    if (cp.Restoring())
+    {
+      AddRange(s.output_port, s.vc_start, s.vc_end, s.pri);
+    }
+  }
+}
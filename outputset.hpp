@@ -3,8 +3,14 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
+#include <cstddef>
 
+class Checkpoint;
+
+// The candidate outputs of a route, highest priority first. Like the ordered
+// set it replaces, it keeps one entry per priority: an entry whose priority
+// is already present is dropped. The entries are stored inline, so routing
+// into an OutputSet never allocates.
 class OutputSet
 {
 
@@ -17,26 +23,38 @@ public:
     long long int output_port;
   };
 
-  void Clear();
-  void Add(long long int output_port, long long int vc, long long int pri = 0);
+  // distinct priorities a route can hold; the routing functions use two
+  static long long int const max_entries = 4;
+
+  typedef sSetElement const *const_iterator;
+
+  OutputSet() : _size(0) {}
+
+  inline void Clear() { _size = 0; }
+  inline void Add(long long int output_port, long long int vc, long long int pri = 0)
+  {
+    AddRange(output_port, vc, vc, pri);
+  }
   void AddRange(long long int output_port, long long int vc_start, long long int vc_end, long long int pri = 0);
 
   bool OutputEmpty(long long int output_port) const;
   long long int NumVCs(long long int output_port) const;
 
-  const set<sSetElement> &GetSet() const;
+  inline const OutputSet &GetSet() const { return *this; }
+
+  inline const_iterator begin() const { return _outputs; }
+  inline const_iterator end() const { return _outputs + _size; }
+  inline size_t size() const { return _size; }
+  inline bool empty() const { return _size == 0; }
 
   long long int GetVC(long long int output_port, long long int vc_index, long long int *pri = 0) const;
   bool GetPortVC(long long int *out_port, long long int *out_vc) const;
 
+  void Serialize(Checkpoint &cp);
+
 private:
-  set<sSetElement> _outputs;
+  size_t _size;
+  sSetElement _outputs[max_entries];
 };
 
-inline bool operator<(const OutputSet::sSetElement &se1,
-                      const OutputSet::sSetElement &se2)
-{
-  return se1.pri > se2.pri; // higher priorities first!
-}
-
 #endif
@@ -28,6 +28,7 @@
 #include "buffer_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 BufferMonitor::BufferMonitor(long long int inputs, long long int classes)
     : _cycles(0), _inputs(inputs), _classes(classes)
@@ -43,9 +44,9 @@ long long int BufferMonitor::index(long long int input, long long int cl) const
   return cl + _classes * input;
 }
 
-void BufferMonitor::cycle()
+void BufferMonitor::cycle(long long int cycles)
 {
-  _cycles++;
+  _cycles += cycles;
 }
 
 void BufferMonitor::write(long long int input, Flit const *f)
@@ -74,6 +75,13 @@ void BufferMonitor::display(ostream &os) const
   }
 }
 
+void BufferMonitor::Serialize(Checkpoint &cp)
+{
+  cp.Io(_cycles);
+  cp.Io(_reads);
+  cp.Io(_writes);
+}
+
 ostream &operator<<(ostream &os, BufferMonitor const &obj)
 {
   obj.display(os);
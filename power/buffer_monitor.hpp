@@ -34,6 +34,7 @@
 using namespace std;
 
 class Flit;
+class Checkpoint;
 
 class BufferMonitor
 {
@@ -46,7 +47,7 @@ class BufferMonitor
 
 public:
   BufferMonitor(long long int inputs, long long int classes);
-  void cycle();
+  void cycle(long long int cycles = 1);
   void write(long long int input, Flit const *f);
   void read(long long int input, Flit const *f);
   inline const vector<long long int> &GetReads() const
@@ -66,6 +67,7 @@ public:
     return _classes;
   }
   void display(ostream &os) const;
+  void Serialize(Checkpoint &cp);
 };
 
 ostream &operator<<(ostream &os, BufferMonitor const &obj);
@@ -25,6 +25,10 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
 #include "power_module.hpp"
 #include "booksim_config.hpp"
 #include "buffer_monitor.hpp"
@@ -103,8 +107,23 @@ Power_Module::Power_Module(Network *n, const Configuration &config)
 
   ChannelPitch = 2.0 * MetalPitch;
   CrossbarPitch = 2.0 * MetalPitch;
+
+  //everything the wire optimization depends on
+  ostringstream key;
+  key.precision(17);
+  key << "wires1 " << R << ' ' << Cw << ' ' << Rw << ' ' << Ci_delay << ' '
+      << Co_delay << ' ' << Ci << ' ' << Co << ' ' << Cg_pwr << ' ' << Vdd
+      << ' ' << tCLK;
+  tech_key = key.str();
+
+  wire_cache_file = config.GetStr("wire_cache");
+  wire_cache_dirty = false;
+  loadWireCache();
 }
 
+map<string, map<double, wire>> Power_Module::wire_cache;
+mutex Power_Module::wire_cache_lock;
+
 Power_Module::~Power_Module()
 {
 }
@@ -149,48 +168,185 @@ wire const &Power_Module::wireOptimize(double L)
   map<double, wire>::iterator iter = wire_map.find(L);
   if (iter == wire_map.end())
   {
-
-    double W = 64;
-    double bestMetric = 100000000;
-    double bestK = -1;
-    double bestM = -1;
-    double bestN = -1;
-    for (double K = 1.0; K < 10; K += 0.1)
+    wire temp;
+    bool found;
     {
-      for (double N = 1.0; N < 40; N += 1.0)
+      lock_guard<mutex> guard(wire_cache_lock);
+      map<double, wire> const &known = wire_cache[tech_key];
+      map<double, wire>::const_iterator cached = known.find(L);
+      found = (cached != known.end());
+      if (found)
       {
-        for (double M = 1.0; M < 40.0; M += 1.0)
-        {
-          double l = 1.0 * L / (N * M);
-
-          double k0 = R * (Co_delay + Ci_delay);
-          double k1 = R / K * Cw + K * Rw * Ci_delay;
-          double k2 = 0.5 * Rw * Cw;
-          double Tw = k0 + (k1 * l) + k2 * (l * l);
-          double alpha = 0.2;
-          double power = alpha * W * powerRepeatedWire(L, K, M, N) + powerWireDFF(M, W, alpha);
-          double metric = M * M * M * M * power;
-          if ((N * Tw) < (0.8 * tCLK))
-          {
-            if (metric < bestMetric)
-            {
-              bestMetric = metric;
-              bestK = K;
-              bestM = M;
-              bestN = N;
-            }
-          }
-        }
+        temp = cached->second;
       }
     }
-    cout << "L = " << L << " K = " << bestK << " M = " << bestM << " N = " << bestN << endl;
+    if (!found)
+    {
+      //searched without the lock; a thread that got there first found the
+      //same wire
+      temp = searchWire(L);
+      lock_guard<mutex> guard(wire_cache_lock);
+      wire_cache[tech_key].insert(make_pair(L, temp));
+      wire_cache_dirty = true;
+    }
+    cout << "L = " << L << " K = " << temp.K << " M = " << temp.M << " N = " << temp.N << endl;
 
-    wire const temp = {L, bestK, bestM, bestN};
     iter = wire_map.insert(make_pair(L, temp)).first;
   }
   return iter->second;
 }
 
+//repeater size K, pipeline stages M and repeaters per stage N with the least
+//M^4-weighted power that still meets timing; picks the same wire as trying
+//every K in [1, 10) by 0.1, N and M in [1, 40), but only visits the fewest
+//stages for each (K, M) and stops early once the metric can no longer win
+wire Power_Module::searchWire(double L)
+{
+  double bestMetric = 100000000;
+  double bestK = -1;
+  double bestM = -1;
+  double bestN = -1;
+  long long int bestStep = -1;
+  long long int step = 0;
+  for (double K = 1.0; K < 10; K += 0.1, ++step)
+  {
+    double k1 = R / K * Cw + K * Rw * Ci_delay;
+    bool improvable = false;
+    for (double M = 1.0; M < 40.0; M += 1.0)
+    {
+      //the metric grows with N, K and M, so one stage per repeater bounds
+      //every remaining candidate from below
+      if (wireMetric(L, K, M, 1.0) > bestMetric)
+      {
+        break;
+      }
+      improvable = true;
+      double N = fewestStages(L, M, k1);
+      if (N < 0.0)
+      {
+        continue;
+      }
+      double metric = wireMetric(L, K, M, N);
+      //on a tie the exhaustive search keeps the first in (K, N, M) order
+      if ((metric < bestMetric) ||
+          ((metric == bestMetric) && (step == bestStep) &&
+           ((N < bestN) || ((N == bestN) && (M < bestM)))))
+      {
+        bestMetric = metric;
+        bestK = K;
+        bestM = M;
+        bestN = N;
+        bestStep = step;
+      }
+    }
+    if (!improvable)
+    {
+      break;
+    }
+  }
+  wire const temp = {L, bestK, bestM, bestN};
+  return temp;
+}
+
+double Power_Module::wireMetric(double L, double K, double M, double N)
+{
+  double W = 64;
+  double alpha = 0.2;
+  double power = alpha * W * powerRepeatedWire(L, K, M, N) + powerWireDFF(M, W, alpha);
+  return M * M * M * M * power;
+}
+
+bool Power_Module::wireMeetsTiming(double L, double M, double N, double k1)
+{
+  double l = 1.0 * L / (N * M);
+
+  double k0 = R * (Co_delay + Ci_delay);
+  double k2 = 0.5 * Rw * Cw;
+  double Tw = k0 + (k1 * l) + k2 * (l * l);
+  return (N * Tw) < (0.8 * tCLK);
+}
+
+//smallest N in [1, 40) that meets timing, or -1; the delay N * Tw is convex
+//in N with its minimum at L / M * sqrt(k2 / k0), and falls until there
+double Power_Module::fewestStages(double L, double M, double k1)
+{
+  double k0 = R * (Co_delay + Ci_delay);
+  double k2 = 0.5 * Rw * Cw;
+  double top = floor(L / M * sqrt(k2 / k0));
+  top = max(1.0, min(top, 39.0));
+  if (!wireMeetsTiming(L, M, top, k1))
+  {
+    if ((top < 39.0) && wireMeetsTiming(L, M, top + 1.0, k1))
+    {
+      return top + 1.0;
+    }
+    return -1.0;
+  }
+  double lo = 1.0;
+  while (lo < top)
+  {
+    double mid = floor((lo + top) / 2.0);
+    if (wireMeetsTiming(L, M, mid, k1))
+    {
+      top = mid;
+    }
+    else
+    {
+      lo = mid + 1.0;
+    }
+  }
+  return top;
+}
+
+//the cache file holds the technology key on its first line, then one wire
+//per line; a file written for another technology is ignored and replaced
+void Power_Module::loadWireCache()
+{
+  if (wire_cache_file.empty())
+  {
+    return;
+  }
+  lock_guard<mutex> guard(wire_cache_lock);
+  ifstream in(wire_cache_file.c_str());
+  string key;
+  if (!in || !getline(in, key) || (key != tech_key))
+  {
+    return;
+  }
+  map<double, wire> &known = wire_cache[tech_key];
+  wire w;
+  while (in >> w.L >> w.K >> w.M >> w.N)
+  {
+    known.insert(make_pair(w.L, w));
+  }
+}
+
+void Power_Module::saveWireCache()
+{
+  if (wire_cache_file.empty() || !wire_cache_dirty)
+  {
+    return;
+  }
+  //the whole table is written, so the last run to save leaves every wire
+  //any of the runs found
+  lock_guard<mutex> guard(wire_cache_lock);
+  ofstream out(wire_cache_file.c_str());
+  if (!out)
+  {
+    cerr << "Unable to write wire cache " << wire_cache_file << endl;
+    return;
+  }
+  out.precision(17);
+  out << tech_key << endl;
+  map<double, wire> const &known = wire_cache[tech_key];
+  for (map<double, wire>::const_iterator iter = known.begin(); iter != known.end(); ++iter)
+  {
+    out << iter->second.L << ' ' << iter->second.K << ' '
+        << iter->second.M << ' ' << iter->second.N << endl;
+  }
+  wire_cache_dirty = false;
+}
+
 double Power_Module::powerRepeatedWire(double L, double K, double M, double N)
 {
 
@@ -227,6 +383,34 @@ double Power_Module::powerWireDFF(double M, double W, double alpha)
   return Cint * M * W * (Vdd * Vdd) * fCLK;
 }
 
+routerPower Power_Module::calcRouterPower(const BufferMonitor *bm, const SwitchMonitor *sm)
+{
+  routerPower p;
+  double depth = numVC * depthVC;
+  double Pwl = powerWordLine(channel_width, depth);
+  p.write = Pwl + powerMemoryBitWrite(depth) * channel_width;
+  p.read = Pwl + powerMemoryBitRead(depth) * channel_width;
+
+  double inputs = sm->NumInputs();
+  double outputs = sm->NumOutputs();
+  double Px = 0.0;
+  for (long long int i = 0; i < sm->NumOutputs(); i++)
+  {
+    for (long long int j = 0; j < sm->NumInputs(); j++)
+    {
+      Px += powerCrossbar(channel_width, inputs, outputs, j, i);
+    }
+  }
+  Px /= inputs * outputs;
+  p.traversal = channel_width * Px + powerCrossbarCtrl(channel_width, inputs, outputs) +
+                powerWireDFF(1, channel_width, 1.0) + powerOutputCtrl(channel_width);
+
+  p.leakage = bm->NumInputs() * powerMemoryBitLeak(depth) * channel_width +
+              powerCrossbarLeak(channel_width, inputs, outputs);
+  p.clock = outputs * powerWireClk(1, channel_width);
+  return p;
+}
+
 ///////////////////////////////////////////////////////////////
 //Memory
 //////////////////////////////////////////////////////////////
@@ -516,6 +700,7 @@ void Power_Module::run()
   {
     calcChannel(chan[i]);
   }
+  saveWireCache();
 
   vector<Router *> routers = net->GetRouters();
   for (size_t i = 0; i < routers.size(); i++)
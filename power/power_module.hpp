@@ -29,6 +29,8 @@
 #define _POWER_MODULE_HPP_
 
 #include <map>
+#include <string>
+#include <mutex>
 
 #include "module.hpp"
 #include "network.hpp"
@@ -45,6 +47,17 @@ struct wire
   double N;
 };
 
+//power of one router per event (at an activity factor of one) and per
+//ungated cycle, for converting activity counts over time
+struct routerPower
+{
+  double write;
+  double read;
+  double traversal;
+  double leakage;
+  double clock;
+};
+
 class Power_Module : public Module
 {
 
@@ -67,6 +80,15 @@ protected:
   //store the property of wires based on length
   map<double, wire> wire_map;
 
+  //wires optimized so far in this process, per technology; backed by
+  //wire_cache_file when one is given. Sweep runs share it from several
+  //threads, so the table and the file are only touched under the lock
+  static map<string, map<double, wire>> wire_cache;
+  static mutex wire_cache_lock;
+  string wire_cache_file;
+  string tech_key;
+  bool wire_cache_dirty;
+
   //////////////////////////////////Constants/////////////////////////////
   //wire length in (mm)
   double wire_length;
@@ -147,6 +169,12 @@ protected:
   //channels
   void calcChannel(const FlitChannel *f);
   wire const &wireOptimize(double l);
+  wire searchWire(double L);
+  double wireMetric(double L, double K, double M, double N);
+  bool wireMeetsTiming(double L, double M, double N, double k1);
+  double fewestStages(double L, double M, double k1);
+  void loadWireCache();
+  void saveWireCache();
   double powerRepeatedWire(double L, double K, double M, double N);
   double powerRepeatedWireLeak(double K, double M, double N);
   double powerWireClk(double M, double W);
@@ -180,5 +208,8 @@ public:
   ~Power_Module();
 
   void run();
+
+  //crossbar traversals are averaged over all input/output pairs
+  routerPower calcRouterPower(const BufferMonitor *bm, const SwitchMonitor *sm);
 };
 #endif
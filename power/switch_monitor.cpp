@@ -28,6 +28,7 @@
 #include "switch_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 SwitchMonitor::SwitchMonitor(long long int inputs, long long int outputs, long long int classes)
     : _cycles(0), _inputs(inputs), _outputs(outputs), _classes(classes)
@@ -43,9 +44,9 @@ long long int SwitchMonitor::index(long long int input, long long int output, lo
   return cl + _classes * (output + _outputs * input);
 }
 
-void SwitchMonitor::cycle()
+void SwitchMonitor::cycle(long long int cycles)
 {
-  _cycles++;
+  _cycles += cycles;
 }
 
 void SwitchMonitor::traversal(long long int input, long long int output, Flit const *f)
@@ -69,6 +70,12 @@ void SwitchMonitor::display(ostream &os) const
   }
 }
 
+void SwitchMonitor::Serialize(Checkpoint &cp)
+{
+  cp.Io(_cycles);
+  cp.Io(_event);
+}
+
 ostream &operator<<(ostream &os, SwitchMonitor const &obj)
 {
   obj.display(os);
@@ -34,6 +34,7 @@
 using namespace std;
 
 class Flit;
+class Checkpoint;
 
 class SwitchMonitor
 {
@@ -46,7 +47,7 @@ class SwitchMonitor
 
 public:
   SwitchMonitor(long long int inputs, long long int outputs, long long int classes);
-  void cycle();
+  void cycle(long long int cycles = 1);
   vector<long long int> const &GetActivity() const
   {
     return _event;
@@ -65,6 +66,7 @@ public:
   }
   void traversal(long long int input, long long int output, Flit const *f);
   void display(ostream &os) const;
+  void Serialize(Checkpoint &cp);
 };
 
 ostream &operator<<(ostream &os, SwitchMonitor const &obj);
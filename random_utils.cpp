@@ -1,12 +1,81 @@
 // $Id$
 
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 #include <algorithm>
 #include <cassert>
 
-extern long ran_x[];
-extern double ran_u[];
+extern thread_local long ran_x[];
+extern thread_local double ran_u[];
+extern thread_local long ran_arr_buf[];
+extern thread_local double ranf_arr_buf[];
+extern thread_local long ran_arr_dummy, ran_arr_started;
+extern thread_local double ranf_arr_dummy, ranf_arr_started;
+extern thread_local long *ran_arr_ptr;
+extern thread_local double *ranf_arr_ptr;
 #define KK 100
+#define QUALITY 1009
+
+// the read pointers either point into the output buffers or at one of two
+// sentinels, which are saved as negative positions
+#define PTR_DUMMY -1
+#define PTR_STARTED -2
+
+thread_local bool gRandomLocked = false;
+thread_local RandomStream *gRandomStream = NULL;
+
+RandomStream::RandomStream()
+{
+  Seed(0, RANDOM_INJECTION, 0);
+}
+
+void RandomStream::Seed(long long int seed, eRandomPurpose purpose, long long int id)
+{
+  _key[0] = (unsigned int)seed;
+  _key[1] = (unsigned int)((unsigned long long int)seed >> 32);
+  // counter words 0 and 1 count the blocks, 2 and 3 name the stream
+  _ctr[0] = 0;
+  _ctr[1] = 0;
+  _ctr[2] = (unsigned int)id;
+  _ctr[3] = (unsigned int)purpose;
+  _used = 4;
+}
+
+void RandomStream::_Refill()
+{
+  unsigned int c0 = _ctr[0], c1 = _ctr[1], c2 = _ctr[2], c3 = _ctr[3];
+  unsigned int k0 = _key[0], k1 = _key[1];
+  for (int round = 0; round < 10; ++round)
+  {
+    unsigned long long int const p0 = 0xD2511F53ULL * c0;
+    unsigned long long int const p1 = 0xCD9E8D57ULL * c2;
+    unsigned int const n0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+    unsigned int const n2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+    c0 = n0;
+    c1 = (unsigned int)p1;
+    c2 = n2;
+    c3 = (unsigned int)p0;
+    k0 += 0x9E3779B9U;
+    k1 += 0xBB67AE85U;
+  }
+  _out[0] = c0;
+  _out[1] = c1;
+  _out[2] = c2;
+  _out[3] = c3;
+  if (!++_ctr[0])
+  {
+    ++_ctr[1];
+  }
+  _used = 0;
+}
+
+void RandomStream::Serialize(Checkpoint &cp)
+{
+  cp.IoArray(_key, 2);
+  cp.IoArray(_ctr, 4);
+  cp.IoArray(_out, 4);
+  cp.Io(_used);
+}
 
 void SaveRandomState(std::vector<long> &save_x, std::vector<double> &save_u)
 {
@@ -21,3 +90,29 @@ void RestoreRandomState(std::vector<long> const &save_x, std::vector<double> con
   assert(save_u.size() == KK);
   std::copy(save_u.begin(), save_u.end(), ran_u);
 }
+
+void SaveRandomStream(std::vector<long> &save_x, std::vector<double> &save_u)
+{
+  save_x.assign(ran_x, ran_x + KK);
+  save_x.insert(save_x.end(), ran_arr_buf, ran_arr_buf + QUALITY);
+  save_x.push_back((ran_arr_ptr == &ran_arr_dummy) ? PTR_DUMMY : (ran_arr_ptr == &ran_arr_started) ? PTR_STARTED : (ran_arr_ptr - ran_arr_buf));
+
+  save_u.assign(ran_u, ran_u + KK);
+  save_u.insert(save_u.end(), ranf_arr_buf, ranf_arr_buf + QUALITY);
+  save_u.push_back((ranf_arr_ptr == &ranf_arr_dummy) ? PTR_DUMMY : (ranf_arr_ptr == &ranf_arr_started) ? PTR_STARTED : (ranf_arr_ptr - ranf_arr_buf));
+}
+
+void RestoreRandomStream(std::vector<long> const &save_x, std::vector<double> const &save_u)
+{
+  assert(save_x.size() == KK + QUALITY + 1);
+  std::copy(save_x.begin(), save_x.begin() + KK, ran_x);
+  std::copy(save_x.begin() + KK, save_x.begin() + KK + QUALITY, ran_arr_buf);
+  long const x_pos = save_x.back();
+  ran_arr_ptr = (x_pos == PTR_DUMMY) ? &ran_arr_dummy : (x_pos == PTR_STARTED) ? &ran_arr_started : (ran_arr_buf + x_pos);
+
+  assert(save_u.size() == KK + QUALITY + 1);
+  std::copy(save_u.begin(), save_u.begin() + KK, ran_u);
+  std::copy(save_u.begin() + KK, save_u.begin() + KK + QUALITY, ranf_arr_buf);
+  long const u_pos = (long)save_u.back();
+  ranf_arr_ptr = (u_pos == PTR_DUMMY) ? &ranf_arr_dummy : (u_pos == PTR_STARTED) ? &ranf_arr_started : (ranf_arr_buf + u_pos);
+}
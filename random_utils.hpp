@@ -4,6 +4,7 @@
 #define _RANDOM_UTILS_HPP_
 
 #include <vector>
+#include <cassert>
 
 // interface to Knuth's RANARRAY RNG
 void ran_start(long seed);
@@ -11,6 +12,84 @@ long ran_next();
 void ranf_start(long seed);
 double ranf_next();
 
+class Checkpoint;
+
+// set while the network is stepped from several threads, and always on the
+// network's worker threads; the generators cannot be drawn from then without
+// losing determinism
+extern thread_local bool gRandomLocked;
+
+// Counter-based generator (Philox4x32-10). Every stream is keyed by the seed
+// and a (purpose, id) pair and yields the encryption of a running counter,
+// so streams are independent of each other and of the order in which they
+// are drawn from.
+enum eRandomPurpose
+{
+  RANDOM_INJECTION = 1, // injection process, per class and source
+  RANDOM_TRAFFIC,       // destinations and packet sizes, per class and source
+  RANDOM_SOURCE,        // routing at injection, per source
+  RANDOM_ROUTER         // routing and allocation, per router
+};
+
+class RandomStream
+{
+  unsigned int _key[2];
+  unsigned int _ctr[4];
+  unsigned int _out[4];
+  long long int _used;
+
+  void _Refill();
+
+public:
+  RandomStream();
+
+  void Seed(long long int seed, eRandomPurpose purpose, long long int id);
+
+  inline unsigned long long int Next()
+  {
+    if (_used >= 4)
+    {
+      _Refill();
+    }
+    unsigned long long int const r = ((unsigned long long int)_out[_used] << 32) | _out[_used + 1];
+    _used += 2;
+    return r;
+  }
+
+  // same ranges as RandomInt and RandomFloat below
+  inline long long int Int(long long int max)
+  {
+    return (long long int)(Next() % (unsigned long long int)(max + 1));
+  }
+  inline double Float()
+  {
+    return (double)(Next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  void Serialize(Checkpoint &cp);
+};
+
+// while set, the Random* functions below draw from this stream instead of
+// the shared generators
+extern thread_local RandomStream *gRandomStream;
+
+// installs a stream for the lifetime of the scope; NULL keeps the shared
+// generators
+class RandomStreamScope
+{
+  RandomStream *_saved;
+
+public:
+  inline RandomStreamScope(RandomStream *stream) : _saved(gRandomStream)
+  {
+    gRandomStream = stream;
+  }
+  inline ~RandomStreamScope()
+  {
+    gRandomStream = _saved;
+  }
+};
+
 inline void RandomSeed(long seed)
 {
   ran_start(seed);
@@ -19,24 +98,44 @@ inline void RandomSeed(long seed)
 
 inline unsigned long RandomIntLong()
 {
+  if (gRandomStream)
+  {
+    return (unsigned long)(gRandomStream->Next() >> 34);
+  }
+  assert(!gRandomLocked);
   return ran_next();
 }
 
 // Returns a random integer in the range [0,max]
 inline long long int RandomInt(long long int max)
 {
+  if (gRandomStream)
+  {
+    return gRandomStream->Int(max);
+  }
+  assert(!gRandomLocked);
   return (ran_next() % (max + 1));
 }
 
 // Returns a random floating-point value in the rage [0,1]
 inline double RandomFloat()
 {
+  if (gRandomStream)
+  {
+    return gRandomStream->Float();
+  }
+  assert(!gRandomLocked);
   return ranf_next();
 }
 
 // Returns a random floating-point value in the rage [0,max]
 inline double RandomFloat(double max)
 {
+  if (gRandomStream)
+  {
+    return gRandomStream->Float() * max;
+  }
+  assert(!gRandomLocked);
   return (ranf_next() * max);
 }
 
@@ -46,4 +145,12 @@ void SaveRandomState(std::vector<long> &save_x, std::vector<double> &save_u);
 // Restores the generator state from previously saved values
 void RestoreRandomState(std::vector<long> const &save_x, std::vector<double> const &save_u);
 
+// Saves the complete generator state, including the numbers already
+// generated but not yet handed out, so that a restored stream continues
+// exactly where it was saved
+void SaveRandomStream(std::vector<long> &save_x, std::vector<double> &save_u);
+
+// Restores a stream saved by SaveRandomStream
+void RestoreRandomStream(std::vector<long> const &save_x, std::vector<double> const &save_u);
+
 #endif
@@ -25,6 +25,7 @@
 #include "cmesh.hpp"
 
 map<string, tRoutingFunction> gRoutingFunctionMap;
+set<tRoutingFunction> gTableRoutingFunctions;
 
 /* Global information used by routing functions */
 
@@ -1183,7 +1184,7 @@ void valiant_mesh(const Router *r, const Flit *f, long long int in_channel, Outp
     }
 
     out_port = dor_next_mesh(r->GetID(), (f->ph == 0) ? f->intm : f->dest);
-    printf("\nThe outport for the packet from Source : %lld to Dest : %lld and intermediate node : %lld at router %lld is: %lld\n", f->src, f->dest, f->intm, r->GetID(), out_port); //Sneha
+    cout << "\nThe outport for the packet from Source : " << f->src << " to Dest : " << f->dest << " and intermediate node : " << f->intm << " at router " << r->GetID() << " is: " << out_port << endl; //Sneha
 
     // at the destination router, we don't need to separate VCs by phase
     if (r->GetID() != f->dest)
@@ -1858,4 +1859,11 @@ void InitializeRoutingMap(const Configuration &config)
 
   gRoutingFunctionMap["chaos_mesh"] = &chaos_mesh;
   gRoutingFunctionMap["chaos_torus"] = &chaos_torus;
+
+  // dimension-order torus routing is not listed: its VC partition is kept in
+  // the flit across hops, and ties on even radices are broken randomly
+  gTableRoutingFunctions.insert(&dim_order_mesh);
+  gTableRoutingFunctions.insert(&dim_order_ni_mesh);
+  gTableRoutingFunctions.insert(&dim_order_pni_mesh);
+  gTableRoutingFunctions.insert(&dest_tag_fly);
 }
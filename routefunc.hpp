@@ -5,18 +5,21 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "flit.hpp"
 #include "router.hpp"
 #include "outputset.hpp"
 #include "config_utils.hpp"
 
-typedef void (*tRoutingFunction)(const Router *, const Flit *, long long int in_channel, OutputSet *, bool);
-
 void InitializeRoutingMap(const Configuration &config);
 
 extern map<string, tRoutingFunction> gRoutingFunctionMap;
 
+// deterministic routing functions whose routes depend only on the router,
+// the destination and the class, and can be precomputed (routing_table)
+extern set<tRoutingFunction> gTableRoutingFunctions;
+
 extern long long int gNumVCs;
 extern long long int gNumClasses;
 extern vector<long long int> gBeginVCs;
@@ -135,6 +135,7 @@ ChaosRouter::~ChaosRouter()
 
 void ChaosRouter::ReadInputs()
 {
+  RandomStreamScope random_scope(_random_stream);
   Flit *f;
   Credit *c;
 
@@ -26,7 +26,7 @@
 #include "buffer_monitor.hpp"
 
 IQRouter::IQRouter(Configuration const &config, Module *parent, string const &name, long long int id, long long int inputs, long long int outputs)
-    : Router(config, parent, name, id, inputs, outputs), _active(false)
+    : Router(config, parent, name, id, inputs, outputs), _active(false), _internal_time(0), _idle_since(-1)
 {
 
   _vcs = config.GetLongInt("num_vcs");
@@ -213,127 +213,25 @@ void IQRouter::ReadInputs()
 void IQRouter::_InternalStep()
 {
   //==========================gating===================================
-  if (asyncConfig->doGating)
+  // only the start of an idle window is recorded; the window is accounted
+  // for once the router wakes up, see _EndIdleWindow
+  if (asyncConfig->doGating &&
+      ((asyncConfig->gatingMode == 0) || (asyncConfig->gatingMode == 1)))
   {
-    if (asyncConfig->gatingMode == 0)
+    if (!_active)
     {
-      if (!_active)
+      if (_idle_since < 0)
       {
-        asyncConfig->idleTicksCounter[_id]++;
-        if (asyncConfig->idleTicksCounter[_id] >= asyncConfig->sleepThreshold)
-        {
-          asyncConfig->gatedTicksCounter[_id]++;
-        }
-      }
-      else
-      {
-        if (asyncConfig->idleTicksCounter[_id] > 0)
-        {
-
-          if (asyncConfig->idleTicksCounter[_id] >= asyncConfig->breakEvenThreshold)
-          {
-
-            asyncConfig->viableIdleTicksSum[_id] = asyncConfig->viableIdleTicksSum[_id] + asyncConfig->idleTicksCounter[_id] - asyncConfig->breakEvenThreshold;
-            asyncConfig->viableIdleTimesSum[_id]++;
-          }
-
-          asyncConfig->idleTicksCounter[_id] = 0;
-
-          if (asyncConfig->gatedTicksCounter[_id] > 0)
-          {
-            asyncConfig->viableGatedTicksSum[_id] = asyncConfig->viableGatedTicksSum[_id] + asyncConfig->gatedTicksCounter[_id] - asyncConfig->breakEvenThreshold;
-            asyncConfig->gatedTicksCounter[_id] = 0;
-            asyncConfig->gatedTimesSum[_id]++;
-          }
-        }
+        _idle_since = _internal_time;
       }
     }
-    else if (asyncConfig->gatingMode == 1)
+    else if (_idle_since >= 0)
     {
-      if (!_active)
-      {
-        //deal with oracular finding all windows of idle times
-        asyncConfig->idleTicksCounter[_id]++;
-
-        //deals with gating depending on threshold set counting all idle ticks about the sleep threshold set for that router
-        if (asyncConfig->idleTicksCounter[_id] >= asyncConfig->routerSleepThreshold[_id])
-        {
-          asyncConfig->gatedTicksCounter[_id]++;
-        }
-      }
-      else
-      {
-        //seeing if there was idle time
-        if (asyncConfig->idleTicksCounter[_id] > 0)
-        {
-          long long int flagSpuriousCase = 0;
-
-          //adding the idle window to the oracular gated tick if it was indeed a window that could be gated.
-
-          if (asyncConfig->idleTicksCounter[_id] >= asyncConfig->breakEvenThreshold)
-          {
-            //there is an interesting scenario here - because of large sleepthreshold window there could be op missing
-
-            if ((asyncConfig->idleTicksCounter[_id] - asyncConfig->breakEvenThreshold) < asyncConfig->routerSleepThreshold[_id])
-            {
-              flagSpuriousCase = 1;
-            }
-
-            asyncConfig->viableIdleTicksSum[_id] = asyncConfig->viableIdleTicksSum[_id] + asyncConfig->idleTicksCounter[_id] - asyncConfig->breakEvenThreshold;
-
-            asyncConfig->viableIdleTimesSum[_id]++;
-          }
-          //reseting the  oracular idle tick counter
-          asyncConfig->idleTicksCounter[_id] = 0;
-
-          //seeing if the previous window was gated, satisfying the threshold
-          if (asyncConfig->gatedTicksCounter[_id] > 0)
-          {
-            //adding the effective time of gating.
-            //logic to handle dynamic sleep threshold
-            if (asyncConfig->gatedTicksCounter[_id] > asyncConfig->breakEvenThreshold)
-            {
-              //successfull gating
-              if (asyncConfig->routerSleepThreshold[_id] <= asyncConfig->sleepThresholdStep)
-              {
-                //do nothing..
-              }
-              else
-              {
-                //decrease the sleepThreshold
-                asyncConfig->routerSleepThreshold[_id] = asyncConfig->routerSleepThreshold[_id] - asyncConfig->sleepThresholdStep;
-              }
-            }
-            else
-            { //failed gating
-              if (flagSpuriousCase == 1)
-              {
-                 asyncConfig->routerSleepThreshold[_id] = asyncConfig->sleepThresholdStep;
-              }
-              else
-              {
-                if (asyncConfig->routerSleepThreshold[_id] >= asyncConfig->breakEvenThreshold)
-                {
-                  //do nothing..
-                }
-                else
-                {
-                  //increase the sleepThreshold
-                  asyncConfig->routerSleepThreshold[_id] = asyncConfig->routerSleepThreshold[_id] + asyncConfig->sleepThresholdStep;
-                }
-              }
-            }
-
-            //stat collection
-            asyncConfig->viableGatedTicksSum[_id] = asyncConfig->viableGatedTicksSum[_id] + asyncConfig->gatedTicksCounter[_id] - asyncConfig->breakEvenThreshold;
-            //reseting
-            asyncConfig->gatedTicksCounter[_id] = 0;
-            asyncConfig->gatedTimesSum[_id]++;
-          }
-        }
-      }
+      _EndIdleWindow(_internal_time - _idle_since);
+      _idle_since = -1;
     }
   }
+  ++_internal_time;
 
   //===============================end gating==========================
 
@@ -349,11 +247,11 @@ void IQRouter::_InternalStep()
   //_in_queue_flits
   //_vc_alloc_vcs
 
-  asyncConfig->queueTicks += _in_queue_flits.size();
-  asyncConfig->routeTicks += _route_vcs.size();
-  asyncConfig->vcaTicks += _vc_alloc_vcs.size();
-  asyncConfig->swaTicks += _sw_alloc_vcs.size();
-  asyncConfig->crossbarTicks += _crossbar_flits.size();
+  asyncConfig->queueTicks[_id] += _in_queue_flits.size();
+  asyncConfig->routeTicks[_id] += _route_vcs.size();
+  asyncConfig->vcaTicks[_id] += _vc_alloc_vcs.size();
+  asyncConfig->swaTicks[_id] += _sw_alloc_vcs.size();
+  asyncConfig->crossbarTicks[_id] += _crossbar_flits.size();
 
   _InputQueuing();
   bool activity = !_proc_credits.empty();
@@ -421,6 +319,186 @@ void IQRouter::WriteOutputs()
   _SendCredits();
 }
 
+// deadline of the head of a pipeline stage queue; entries that have not been
+// evaluated yet (time -1) are picked up on the next cycle
+template <typename T>
+static long long int _HeadDeadline(StageQueue<T> const &q)
+{
+  if (q.empty())
+  {
+    return numeric_limits<long long int>::max();
+  }
+  long long int const time = q.front().time;
+  return max(time, GetSimTime() + 1);
+}
+
+long long int IQRouter::NextEventTime() const
+{
+  long long int const next = GetSimTime() + 1;
+
+  if (_internal_speedup != 1.0)
+  {
+    return next;
+  }
+  for (long long int output = 0; output < _outputs; ++output)
+  {
+    if (!_output_buffer[output].empty())
+    {
+      return next;
+    }
+  }
+  for (long long int input = 0; input < _inputs; ++input)
+  {
+    if (!_credit_buffer[input].empty())
+    {
+      return next;
+    }
+  }
+  if (!_active)
+  {
+    return numeric_limits<long long int>::max();
+  }
+  if (!_sw_hold_vcs.empty() ||
+      (_vc_allocator && _vc_allocator->AdvancesWhenIdle()) ||
+      _sw_allocator->AdvancesWhenIdle() ||
+      (_spec_sw_allocator && _spec_sw_allocator->AdvancesWhenIdle()))
+  {
+    return next;
+  }
+
+  long long int time = _HeadDeadline(_proc_credits);
+  time = min(time, _HeadDeadline(_route_vcs));
+  time = min(time, _HeadDeadline(_vc_alloc_vcs));
+  time = min(time, _HeadDeadline(_sw_alloc_vcs));
+  time = min(time, _HeadDeadline(_crossbar_flits));
+  return time;
+}
+
+// replays the bookkeeping _InternalStep performs on cycles where the pipeline
+// makes no progress
+void IQRouter::Idle(long long int cycles)
+{
+  if (_active)
+  {
+    asyncConfig->queueTicks[_id] += cycles * _in_queue_flits.size();
+    asyncConfig->routeTicks[_id] += cycles * _route_vcs.size();
+    asyncConfig->vcaTicks[_id] += cycles * _vc_alloc_vcs.size();
+    asyncConfig->swaTicks[_id] += cycles * _sw_alloc_vcs.size();
+    asyncConfig->crossbarTicks[_id] += cycles * _crossbar_flits.size();
+    _bufferMonitor->cycle(cycles);
+    _switchMonitor->cycle(cycles);
+  }
+  else if (asyncConfig->doGating &&
+           ((asyncConfig->gatingMode == 0) || (asyncConfig->gatingMode == 1)) &&
+           (_idle_since < 0))
+  {
+    // the skipped cycles open an idle window
+    _idle_since = _internal_time;
+  }
+  _internal_time += cycles;
+}
+
+long long int IQRouter::_GatedTicks(long long int idle) const
+{
+  // the idle ticks from the sleep threshold on are gated
+  long long int const threshold = (asyncConfig->gatingMode == 0) ? asyncConfig->sleepThreshold : asyncConfig->routerSleepThreshold[_id];
+  return max(0LL, idle - max(1LL, threshold) + 1);
+}
+
+void IQRouter::_EndIdleWindow(long long int idle)
+{
+  long long int const gated = _GatedTicks(idle);
+  long long int const breakEven = asyncConfig->breakEvenThreshold;
+
+  //adding the idle window to the oracular gated ticks if it could have been gated
+  if (idle >= breakEven)
+  {
+    asyncConfig->viableIdleTicksSum[_id] += idle - breakEven;
+    asyncConfig->viableIdleTimesSum[_id]++;
+  }
+  asyncConfig->idleTicksTotal[_id] += idle;
+
+  if (gated == 0)
+  {
+    return;
+  }
+
+  //logic to handle dynamic sleep threshold
+  if (asyncConfig->gatingMode == 1)
+  {
+    long long int &threshold = asyncConfig->routerSleepThreshold[_id];
+    long long int const step = asyncConfig->sleepThresholdStep;
+    if (gated > breakEven)
+    {
+      //successful gating, decrease the sleepThreshold
+      if (threshold > step)
+      {
+        threshold -= step;
+      }
+    }
+    else if ((idle >= breakEven) && (idle - breakEven < threshold))
+    {
+      //failed gating of a window a smaller threshold would have gated
+      threshold = step;
+    }
+    else if (threshold < breakEven)
+    {
+      //failed gating, increase the sleepThreshold
+      threshold += step;
+    }
+  }
+
+  //stat collection
+  asyncConfig->viableGatedTicksSum[_id] += gated - breakEven;
+  asyncConfig->gatedTicksTotal[_id] += gated;
+  asyncConfig->gatedTimesSum[_id]++;
+}
+
+void IQRouter::Serialize(Checkpoint &cp)
+{
+  _Serialize(cp, _vcs);
+  cp.Io(_active);
+  cp.Io(_internal_time);
+  cp.Io(_idle_since);
+  cp.Io(_in_queue_flits);
+  cp.Io(_proc_credits);
+  cp.Io(_route_vcs);
+  cp.Io(_vc_alloc_vcs);
+  cp.Io(_sw_hold_vcs);
+  cp.Io(_sw_alloc_vcs);
+  cp.Io(_crossbar_flits);
+  cp.Io(_out_queue_credits);
+  for (long long int i = 0; i < _inputs; ++i)
+  {
+    _buf[i]->Serialize(cp);
+  }
+  for (long long int j = 0; j < _outputs; ++j)
+  {
+    _next_buf[j]->Serialize(cp);
+  }
+  _vc_allocator->Serialize(cp);
+  _sw_allocator->Serialize(cp);
+  if (_spec_sw_allocator)
+  {
+    _spec_sw_allocator->Serialize(cp);
+  }
+  cp.Io(_vc_rr_offset);
+  cp.Io(_sw_rr_offset);
+  cp.Io(_output_buffer);
+  cp.Io(_credit_buffer);
+  cp.Io(_switch_hold_in);
+  cp.Io(_switch_hold_out);
+  cp.Io(_switch_hold_vc);
+  cp.Io(_noq_next_output_port);
+  cp.Io(_noq_next_vc_start);
+  cp.Io(_noq_next_vc_end);
+#ifdef TRACK_FLOWS
+  cp.Io(_outstanding_classes);
+#endif
+  _switchMonitor->Serialize(cp);
+  _bufferMonitor->Serialize(cp);
+}
+
 //------------------------------------------------------------------------------
 // read inputs
 //------------------------------------------------------------------------------
@@ -450,7 +528,7 @@ bool IQRouter::_ReceiveCredits()
     if (c)
     {
       //glint
-      _proc_credits.push_back(make_pair(GetSimTime() + asyncConfig->getCreditDelay(_id), make_pair(c, output)));
+      _proc_credits.push_back({GetSimTime() + asyncConfig->getCreditDelay(_id), c, output});
       // _proc_credits.push_back(make_pair(GetSimTime() + _credit_delay, make_pair(c, output)));
       activity = true;
     }
@@ -476,11 +554,11 @@ void IQRouter::_InputQueuing()
     _number_of_crossed_flits++;
     if (f->head)
       _number_of_crossed_headerFlits++;
-    u_char x[8] = "abcdefg";
-    u_char y[8] = "pqrstuv";
-    u_char z[8] = "abcdtuv";
-    SIM_buf_power_data_write(&(_orion_router_info.in_buf_info), &(_orion_router_power.in_buf), x, y, z);
-    _number_of_calls_of_power_functions++;
+    if (_orion_power)
+    {
+      _orion_activity.buf_writes++;
+      _number_of_calls_of_power_functions++;
+    }
     /* end [a.mazloumi and modarressi]codes */
     _bufferMonitor->write(input, f);
     //    printf("\nTime:,%lld,%lld,[%lld][%lld],InputQueueing,%lld\n", GetSimTime(), this->GetID(), f->id, f->pid, f->vc); //Sneha
@@ -489,19 +567,19 @@ void IQRouter::_InputQueuing()
       if (_routing_delay)
       {
         cur_buf->SetState(vc, VC::routing);
-        _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+        _route_vcs.push_back({-1, input, vc, -1});
       }
       else
       {
-        cur_buf->SetRouteSet(vc, &f->la_route_set);
+        cur_buf->SetRouteSet(vc, &f->LaRouteSet());
         cur_buf->SetState(vc, VC::vc_alloc);
         if (_speculative)
         {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
+          _sw_alloc_vcs.push_back({-1, input, vc, -1});
         }
         if (_vc_allocator)
         {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
+          _vc_alloc_vcs.push_back({-1, input, vc, -1});
         }
         if (_noq)
         {
@@ -513,11 +591,11 @@ void IQRouter::_InputQueuing()
     {
       if (_switch_hold_vc[input * _input_speedup + vc % _input_speedup] == vc)
       {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
+        _sw_hold_vcs.push_back({-1, input, vc, -1});
       }
       else
       {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
+        _sw_alloc_vcs.push_back({-1, input, vc, -1});
       }
     }
   }
@@ -525,16 +603,16 @@ void IQRouter::_InputQueuing()
 
   while (!_proc_credits.empty())
   {
-    pair<long long int, pair<Credit *, long long int>> const &item = _proc_credits.front();
-    long long int const time = item.first;
+    sCreditRequest const &item = _proc_credits.front();
+    long long int const time = item.time;
     // cout<<"The time and time in packet is"<<GetSimTime()<<","<<time<<endl;
     if (GetSimTime() < time)
     {
       break;
     }
 
-    Credit *const c = item.second.first;
-    long long int const output = item.second.second;
+    Credit *const c = item.c;
+    long long int const output = item.output;
     BufferState *const dest_buf = _next_buf[output];
     dest_buf->ProcessCredit(c);
     c->Free();
@@ -548,14 +626,15 @@ void IQRouter::_InputQueuing()
 
 void IQRouter::_RouteEvaluate()
 {
-  for (deque<pair<long long int, pair<long long int, long long int>>>::iterator iter = _route_vcs.begin(); iter != _route_vcs.end(); ++iter)
+  for (size_t i = 0; i < _route_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _route_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    iter->first = GetSimTime() + asyncConfig->getRoutingDelay(_id) - 1;
+    req.time = GetSimTime() + asyncConfig->getRoutingDelay(_id) - 1;
   }
 }
 
@@ -563,25 +642,25 @@ void IQRouter::_RouteUpdate()
 {
   while (!_route_vcs.empty())
   {
-    pair<long long int, pair<long long int, long long int>> const &item = _route_vcs.front();
-    long long int const time = item.first;
+    sVCRequest const item = _route_vcs.front();
+    long long int const time = item.time;
     if ((time < 0) || (GetSimTime() < time))
     {
       break;
     }
-    long long int const input = item.second.first;
-    long long int const vc = item.second.second;
+    long long int const input = item.input;
+    long long int const vc = item.vc;
     Buffer *const cur_buf = _buf[input];
     Flit *const f = cur_buf->FrontFlit(vc);
     cur_buf->Route(vc, _rf, this, f, input);
     cur_buf->SetState(vc, VC::vc_alloc);
     if (_speculative)
     {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
     }
     if (_vc_allocator)
     {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back({-1, item.input, item.vc, -1});
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -597,28 +676,32 @@ void IQRouter::_VCAllocEvaluate()
   // MoRi
   /* added by a.mazloumi */
   unsigned int _orion_current_vc_requset[_outputs * _vcs];
-  for (int i = 0; i < _outputs * _vcs; i++)
-    _orion_current_vc_requset[i] = 0;
+  if (_orion_power)
+  {
+    for (int i = 0; i < _outputs * _vcs; i++)
+      _orion_current_vc_requset[i] = 0;
+  }
   int _orion_current_vc_grant = 0;
   /* end of a.mazloumicodes */
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _vc_alloc_vcs.begin(); iter != _vc_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _vc_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _vc_alloc_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    long long int const input = iter->second.first.first;
-    long long int const vc = iter->second.first.second;
+    long long int const input = req.input;
+    long long int const vc = req.vc;
     Buffer const *const cur_buf = _buf[input];
     OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
     long long int const out_priority = cur_buf->GetPriority(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const &setlist = route_set->GetSet();
     bool elig = false;
     bool cred = false;
     bool reserved = false;
-    for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
+    for (OutputSet::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
     {
       long long int const out_port = iset->output_port;
       BufferState const *const dest_buf = _next_buf[out_port];
@@ -666,7 +749,8 @@ void IQRouter::_VCAllocEvaluate()
             _vc_allocator->AddRequest(input_and_vc, out_port * _vcs + out_vc, 0, in_priority, out_priority);
             //MoRi
             /* added by [a.mazloumi and modarressi] */
-            _orion_current_vc_requset[out_port * _vcs + out_vc] = _orion_current_vc_requset[out_port * _vcs + out_vc] | ((unsigned int)pow(2, input_and_vc));
+            if (_orion_power)
+              _orion_current_vc_requset[out_port * _vcs + out_vc] |= OrionRequestBit(input_and_vc);
             /* end of [a.mazloumi and modarressi] */
           }
         }
@@ -674,27 +758,28 @@ void IQRouter::_VCAllocEvaluate()
     }
     if (!elig)
     {
-      iter->second.second = STALL_BUFFER_BUSY;
+      req.output = STALL_BUFFER_BUSY;
     }
     else if (_vc_busy_when_full && !cred)
     {
-      iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+      req.output = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
     }
   }
 
   _vc_allocator->Allocate();
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _vc_alloc_vcs.begin(); iter != _vc_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _vc_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _vc_alloc_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    iter->first = GetSimTime() + asyncConfig->getVcAllocDelay(_id) - 1;
-    long long int const input = iter->second.first.first;
-    long long int const vc = iter->second.first.second;
-    if (iter->second.second < -1)
+    req.time = GetSimTime() + asyncConfig->getVcAllocDelay(_id) - 1;
+    long long int const input = req.input;
+    long long int const vc = req.vc;
+    if (req.output < -1)
     {
       continue;
     }
@@ -708,19 +793,24 @@ void IQRouter::_VCAllocEvaluate()
 
       // MoRi
       /* added by [a.mazloumi and modarressi] */
-      _orion_current_vc_grant = input_and_vc;
+      if (_orion_power)
+      {
+        _orion_current_vc_grant = input_and_vc;
 
-      if (!(PARM_v_channel < 2 && PARM_v_class < 2))
-        SIM_arbiter_record(&(_orion_router_power.vc_out_arb), _orion_current_vc_requset[output_and_vc], _orion_last_vc_reguest[output_and_vc], _orion_current_vc_grant, _orion_last_vc_grant[output_and_vc]);
-      _number_of_calls_of_power_functions++;
-      _orion_last_vc_reguest[output_and_vc] = _orion_current_vc_requset[output_and_vc];
-      _orion_last_vc_grant[output_and_vc] = _orion_current_vc_grant;
+        // the Orion parameters are per thread and not set on the workers of
+        // the parallel kernels, so the router's own copy is read here
+        if ((_orion_router_info.n_v_channel > 1) || (_orion_router_info.n_v_class > 1))
+          RecordOrionArbiter(_orion_activity.vc_arb, _orion_router_power.vc_out_arb, _orion_current_vc_requset[output_and_vc], _orion_last_vc_reguest[output_and_vc], _orion_current_vc_grant, _orion_last_vc_grant[output_and_vc]);
+        _number_of_calls_of_power_functions++;
+        _orion_last_vc_reguest[output_and_vc] = _orion_current_vc_requset[output_and_vc];
+        _orion_last_vc_grant[output_and_vc] = _orion_current_vc_grant;
+      }
       /* end of [a.mazloumi and modarressi] */
-      iter->second.second = output_and_vc;
+      req.output = output_and_vc;
     }
     else
     {
-      iter->second.second = STALL_BUFFER_CONFLICT;
+      req.output = STALL_BUFFER_CONFLICT;
     }
   }
 
@@ -729,27 +819,28 @@ void IQRouter::_VCAllocEvaluate()
     return;
   }
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _vc_alloc_vcs.begin(); iter != _vc_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _vc_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _vc_alloc_vcs[i];
+    long long int const time = req.time;
     if (GetSimTime() < time)
     {
       break;
     }
-    long long int const output_and_vc = iter->second.second;
+    long long int const output_and_vc = req.output;
     if (output_and_vc >= 0)
     {
       long long int const match_output = output_and_vc / _vcs;
       long long int const match_vc = output_and_vc % _vcs;
       BufferState const *const dest_buf = _next_buf[match_output];
-      //long long int const input = iter->second.first.first;
+      //long long int const input = req.input;
       if (!dest_buf->IsAvailableFor(match_vc))
       {
-        iter->second.second = STALL_BUFFER_BUSY;
+        req.output = STALL_BUFFER_BUSY;
       }
       else if (_vc_busy_when_full && dest_buf->IsFullFor(match_vc))
       {
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
     }
   }
@@ -759,17 +850,17 @@ void IQRouter::_VCAllocUpdate()
 {
   while (!_vc_alloc_vcs.empty())
   {
-    pair<long long int, pair<pair<long long int, long long int>, long long int>> const &item = _vc_alloc_vcs.front();
-    long long int const time = item.first;
+    sVCRequest const item = _vc_alloc_vcs.front();
+    long long int const time = item.time;
     if ((time < 0) || (GetSimTime() < time))
     {
       break;
     }
-    long long int const input = item.second.first.first;
-    long long int const vc = item.second.first.second;
+    long long int const input = item.input;
+    long long int const vc = item.vc;
     Buffer *const cur_buf = _buf[input];
     //Flit const *const f = cur_buf->FrontFlit(vc);
-    long long int const output_and_vc = item.second.second;
+    long long int const output_and_vc = item.output;
     if (output_and_vc >= 0)
     {
       long long int const match_output = output_and_vc / _vcs;
@@ -780,12 +871,12 @@ void IQRouter::_VCAllocUpdate()
       cur_buf->SetState(vc, VC::active);
       if (!_speculative)
       {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
       }
     }
     else
     {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _vc_alloc_vcs.push_back({-1, item.input, item.vc, -1});
     }
     _vc_alloc_vcs.pop_front();
     //    printf("\nTime:,%lld,%lld,[%lld][%lld],VCUpdate,%lld\n", GetSimTime(), this->GetID(), f->id, f->pid, f->vc); //Sneha
@@ -799,16 +890,17 @@ void IQRouter::_VCAllocUpdate()
 void IQRouter::_SWHoldEvaluate()
 {
   //printf("\n Looks like we come here too\n"); //Sneha
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _sw_hold_vcs.begin(); iter != _sw_hold_vcs.end(); ++iter)
+  for (size_t i = 0; i < _sw_hold_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _sw_hold_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    iter->first = GetSimTime();
-    long long int const input = iter->second.first.first;
-    long long int const vc = iter->second.first.second;
+    req.time = GetSimTime();
+    long long int const input = req.input;
+    long long int const vc = req.vc;
     Buffer const *const cur_buf = _buf[input];
     //Flit const *const f = cur_buf->FrontFlit(vc);
     //long long int const expanded_input = input * _input_speedup + vc % _input_speedup;
@@ -818,11 +910,11 @@ void IQRouter::_SWHoldEvaluate()
     BufferState const *const dest_buf = _next_buf[match_port];
     if (dest_buf->IsFullFor(match_vc))
     {
-      iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+      req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
     }
     else
     {
-      iter->second.second = expanded_output;
+      req.output = expanded_output;
     }
   }
 }
@@ -832,18 +924,18 @@ void IQRouter::_SWHoldUpdate()
   //printf("\n Looks like we come here too\n"); //Sneha
   while (!_sw_hold_vcs.empty())
   {
-    pair<long long int, pair<pair<long long int, long long int>, long long int>> const &item = _sw_hold_vcs.front();
-    long long int const time = item.first;
+    sVCRequest const item = _sw_hold_vcs.front();
+    long long int const time = item.time;
     if (time < 0)
     {
       break;
     }
-    long long int const input = item.second.first.first;
-    long long int const vc = item.second.first.second;
+    long long int const input = item.input;
+    long long int const vc = item.vc;
     Buffer *const cur_buf = _buf[input];
     Flit *const f = cur_buf->FrontFlit(vc);
     long long int const expanded_input = input * _input_speedup + vc % _input_speedup;
-    long long int const expanded_output = item.second.second;
+    long long int const expanded_output = item.output;
     if (expanded_output >= 0 && (_output_buffer_size == -1 || _output_buffer[expanded_output].size() < size_t(_output_buffer_size)))
     {
       long long int const output = expanded_output / _output_speedup;
@@ -852,8 +944,11 @@ void IQRouter::_SWHoldUpdate()
       cur_buf->RemoveFlit(vc);
       // MoRi
       /* added by [a.mazloumi and modarressi] */
-      SIM_buf_power_data_read(&(_orion_router_info.in_buf_info), &(_orion_router_power.in_buf), 0xffff0000);
-      _number_of_calls_of_power_functions++;
+      if (_orion_power)
+      {
+        _orion_activity.buf_reads++;
+        _number_of_calls_of_power_functions++;
+      }
       /* end [a.mazloumi and modarressi] codes */
       _bufferMonitor->read(input, f);
       f->hops++;
@@ -872,28 +967,31 @@ void IQRouter::_SWHoldUpdate()
             _noq_next_vc_start[input][vc] = -1;
             long long int next_vc_end = _noq_next_vc_end[input][vc];
             _noq_next_vc_end[input][vc] = -1;
-            f->la_route_set.Clear();
-            f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+            f->LaRouteSet().Clear();
+            f->LaRouteSet().AddRange(next_output_port, next_vc_start, next_vc_end);
           }
           else
           {
             long long int in_channel = channel->GetSinkPort();
-            _rf(router, f, in_channel, &f->la_route_set, false);
+            router->Route(_rf, f, in_channel, &f->LaRouteSet());
           }
         }
         else
         {
-          f->la_route_set.Clear();
+          f->ClearLaRouteSet();
         }
       }
       dest_buf->SendingFlit(f);
 
       // MoRi
       /* added by [a.mazloumi and modarressi]@ */
-      SIM_crossbar_record(&(_orion_router_power.crossbar), 1, 0xffffffff, 0x0000ffff, 0, 0); //sending to crossbar
-      _number_of_calls_of_power_functions++;
+      if (_orion_power)
+      {
+        _orion_activity.xbar_inputs++; //sending to crossbar
+        _number_of_calls_of_power_functions++;
+      }
       /* end [a.mazloumi and modarressi]@ codes */
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back({-1, f, expanded_input, expanded_output});
       if (_out_queue_credits.count(input) == 0)
       {
         _out_queue_credits.insert(make_pair(input, Credit::New()));
@@ -921,19 +1019,19 @@ void IQRouter::_SWHoldUpdate()
           if (_routing_delay)
           {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back({-1, item.input, item.vc, -1});
           }
           else
           {
-            cur_buf->SetRouteSet(vc, &nf->la_route_set);
+            cur_buf->SetRouteSet(vc, &nf->LaRouteSet());
             cur_buf->SetState(vc, VC::vc_alloc);
             if (_speculative)
             {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+              _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
             }
             if (_vc_allocator)
             {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+              _vc_alloc_vcs.push_back({-1, item.input, item.vc, -1});
             }
             if (_noq)
             {
@@ -943,7 +1041,7 @@ void IQRouter::_SWHoldUpdate()
         }
         else
         {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+          _sw_hold_vcs.push_back({-1, item.input, item.vc, -1});
         }
       }
     }
@@ -954,7 +1052,7 @@ void IQRouter::_SWHoldUpdate()
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
     }
     _sw_hold_vcs.pop_front();
   }
@@ -998,7 +1096,8 @@ bool IQRouter::_SWAllocAddReq(unsigned int *_orion_current_sw_requset, long long
 
         // MoRi
         /* added by [a.mazloumi and modarressi]@ */
-        _orion_current_sw_requset[output] = _orion_current_sw_requset[output] | ((unsigned int)pow(2, (expanded_input)));
+        if (_orion_power)
+          _orion_current_sw_requset[output] |= OrionRequestBit(expanded_input);
         /* end [a.mazloumi and modarressi]@ */
         return true;
       }
@@ -1008,7 +1107,8 @@ bool IQRouter::_SWAllocAddReq(unsigned int *_orion_current_sw_requset, long long
 
     // MoRi
     /* added by [a.mazloumi and modarressi] */
-    _orion_current_sw_requset[output] = _orion_current_sw_requset[output] | ((unsigned int)pow(2, (expanded_input)));
+    if (_orion_power)
+      _orion_current_sw_requset[output] |= OrionRequestBit(expanded_input);
     /* end [a.mazloumi and modarressi] */
 
     return true;
@@ -1021,21 +1121,25 @@ void IQRouter::_SWAllocEvaluate()
   // MoRi
   /* added by a.mazloumi */
   unsigned int _orion_current_sw_requset[_outputs];
-  for (int i = 0; i < _outputs; i++)
-    _orion_current_sw_requset[i] = 0;
+  if (_orion_power)
+  {
+    for (int i = 0; i < _outputs; i++)
+      _orion_current_sw_requset[i] = 0;
+  }
   int _orion_current_sw_grant = 0;
   /* end of a.mazloum*/
   bool watched = false;
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _sw_alloc_vcs.begin(); iter != _sw_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _sw_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _sw_alloc_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    long long int const input = iter->second.first.first;
-    long long int const vc = iter->second.first.second;
+    long long int const input = req.input;
+    long long int const vc = req.vc;
     Buffer const *const cur_buf = _buf[input];
     Flit const *const f = cur_buf->FrontFlit(vc);
     if (cur_buf->GetState(vc) == VC::active)
@@ -1045,7 +1149,7 @@ void IQRouter::_SWAllocEvaluate()
       BufferState const *const dest_buf = _next_buf[dest_output];
       if (dest_buf->IsFullFor(dest_vc) || (_output_buffer_size != -1 && _output_buffer[dest_output].size() >= (size_t)(_output_buffer_size)))
       {
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         continue;
       }
 
@@ -1059,9 +1163,9 @@ void IQRouter::_SWAllocEvaluate()
     // will also speculatively bid for the switch regardless of whether the VC  allocation succeeds.
 
     OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const &setlist = route_set->GetSet();
 
-    for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
+    for (OutputSet::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
     {
       long long int const dest_output = iset->output_port;
       // for lower levels of speculation, ignore credit availability and always issue requests for all output ports in route set
@@ -1102,11 +1206,11 @@ void IQRouter::_SWAllocEvaluate()
 
       if (_spec_check_elig && !elig)
       {
-        iter->second.second = STALL_BUFFER_BUSY;
+        req.output = STALL_BUFFER_BUSY;
       }
       else if (_spec_check_cred && !cred)
       {
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
       else
       {
@@ -1120,22 +1224,23 @@ void IQRouter::_SWAllocEvaluate()
   if (_spec_sw_allocator)
     _spec_sw_allocator->Allocate();
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _sw_alloc_vcs.begin(); iter != _sw_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _sw_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _sw_alloc_vcs[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
     //here
-    long long int const input = iter->second.first.first;
-    long long int const vc = iter->second.first.second;
+    long long int const input = req.input;
+    long long int const vc = req.vc;
     Buffer const *const cur_buf = _buf[input];
     long long dest = cur_buf->GetOutputPort(vc);
 
-    iter->first = GetSimTime() + asyncConfig->getSwAllocDelay(_id, dest) - 1;
+    req.time = GetSimTime() + asyncConfig->getSwAllocDelay(_id, dest) - 1;
 
-    if (iter->second.second < -1)
+    if (req.output < -1)
     {
       continue;
     }
@@ -1151,19 +1256,22 @@ void IQRouter::_SWAllocEvaluate()
       {
         // MoRi
         /* added by [a.mazloumi and modarressi] */
-        _orion_current_sw_grant = expanded_input;
-        SIM_arbiter_record(&(_orion_router_power.sw_out_arb), _orion_current_sw_requset[expanded_output / _output_speedup], _orion_last_sw_request[expanded_output / _output_speedup], _orion_current_sw_grant, _orion_last_sw_grant[expanded_output / _output_speedup]);
-        _number_of_calls_of_power_functions++;
-        _orion_last_sw_request[expanded_output / _output_speedup] = _orion_current_sw_requset[expanded_output / _output_speedup];
-        _orion_last_sw_grant[expanded_output / _output_speedup] = _orion_current_sw_grant;
+        if (_orion_power)
+        {
+          _orion_current_sw_grant = expanded_input;
+          RecordOrionArbiter(_orion_activity.sw_arb, _orion_router_power.sw_out_arb, _orion_current_sw_requset[expanded_output / _output_speedup], _orion_last_sw_request[expanded_output / _output_speedup], _orion_current_sw_grant, _orion_last_sw_grant[expanded_output / _output_speedup]);
+          _number_of_calls_of_power_functions++;
+          _orion_last_sw_request[expanded_output / _output_speedup] = _orion_current_sw_requset[expanded_output / _output_speedup];
+          _orion_last_sw_grant[expanded_output / _output_speedup] = _orion_current_sw_grant;
+        }
         /* end of [a.mazloumi and modarressi] codes */
 
         _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-        iter->second.second = expanded_output;
+        req.output = expanded_output;
       }
       else
       {
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        req.output = STALL_CROSSBAR_CONFLICT;
       }
     }
     else if (_spec_sw_allocator)
@@ -1173,11 +1281,11 @@ void IQRouter::_SWAllocEvaluate()
       {
         if (_spec_mask_by_reqs && _sw_allocator->OutputHasRequests(expanded_output))
         {
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          req.output = STALL_CROSSBAR_CONFLICT;
         }
         else if (!_spec_mask_by_reqs && (_sw_allocator->InputAssigned(expanded_output) >= 0))
         {
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          req.output = STALL_CROSSBAR_CONFLICT;
         }
         else
         {
@@ -1185,22 +1293,22 @@ void IQRouter::_SWAllocEvaluate()
           if (granted_vc == vc)
           {
             _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-            iter->second.second = expanded_output;
+            req.output = expanded_output;
           }
           else
           {
-            iter->second.second = STALL_CROSSBAR_CONFLICT;
+            req.output = STALL_CROSSBAR_CONFLICT;
           }
         }
       }
       else
       {
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        req.output = STALL_CROSSBAR_CONFLICT;
       }
     }
     else
     {
-      iter->second.second = STALL_CROSSBAR_CONFLICT;
+      req.output = STALL_CROSSBAR_CONFLICT;
     }
   }
 
@@ -1209,26 +1317,27 @@ void IQRouter::_SWAllocEvaluate()
     return;
   }
 
-  for (deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>>::iterator iter = _sw_alloc_vcs.begin(); iter != _sw_alloc_vcs.end(); ++iter)
+  for (size_t i = 0; i < _sw_alloc_vcs.size(); ++i)
   {
-    long long int const time = iter->first;
+    sVCRequest &req = _sw_alloc_vcs[i];
+    long long int const time = req.time;
     if (GetSimTime() < time)
     {
       break;
     }
-    long long int const expanded_output = iter->second.second;
+    long long int const expanded_output = req.output;
     if (expanded_output >= 0)
     {
       long long int const output = expanded_output / _output_speedup;
       BufferState const *const dest_buf = _next_buf[output];
-      long long int const input = iter->second.first.first;
-      long long int const vc = iter->second.first.second;
+      long long int const input = req.input;
+      long long int const vc = req.vc;
       long long int const expanded_input = input * _input_speedup + vc % _input_speedup;
       Buffer const *const cur_buf = _buf[input];
       //Flit const *const f = cur_buf->FrontFlit(vc);
       if ((_switch_hold_in[expanded_input] >= 0) || (_switch_hold_out[expanded_output] >= 0))
       {
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        req.output = STALL_CROSSBAR_CONFLICT;
       }
       else if (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc))
       {
@@ -1238,25 +1347,25 @@ void IQRouter::_SWAllocEvaluate()
           long long int const output_and_vc = _vc_allocator->OutputAssigned(input_and_vc);
           if (output_and_vc < 0)
           {
-            iter->second.second = -1; // stall is counted in VC allocation path!
+            req.output = -1; // stall is counted in VC allocation path!
           }
           else if ((output_and_vc / _vcs) != output)
           {
-            iter->second.second = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
+            req.output = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
           }
           else if (dest_buf->IsFullFor((output_and_vc % _vcs)))
           {
-            iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+            req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
           }
         }
         else
         { // VC allocation is piggybacked onto switch allocation
           OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
-          set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+          OutputSet const &setlist = route_set->GetSet();
           bool busy = true;
           bool full = true;
           bool reserved = false;
-          for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
+          for (OutputSet::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
           {
             if (iset->output_port == output)
             {
@@ -1297,11 +1406,11 @@ void IQRouter::_SWAllocEvaluate()
 
           if (busy)
           {
-            iter->second.second = STALL_BUFFER_BUSY;
+            req.output = STALL_BUFFER_BUSY;
           }
           else if (full)
           {
-            iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+            req.output = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
           }
         }
       }
@@ -1310,7 +1419,7 @@ void IQRouter::_SWAllocEvaluate()
         long long int const match_vc = cur_buf->GetOutputVC(vc);
         if (dest_buf->IsFullFor(match_vc))
         {
-          iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+          req.output = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         }
       }
     }
@@ -1321,17 +1430,17 @@ void IQRouter::_SWAllocUpdate()
 {
   while (!_sw_alloc_vcs.empty())
   {
-    pair<long long int, pair<pair<long long int, long long int>, long long int>> const &item = _sw_alloc_vcs.front();
-    long long int const time = item.first;
+    sVCRequest const item = _sw_alloc_vcs.front();
+    long long int const time = item.time;
     if ((time < 0) || (GetSimTime() < time))
     {
       break;
     }
-    long long int const input = item.second.first.first;
-    long long int const vc = item.second.first.second;
+    long long int const input = item.input;
+    long long int const vc = item.vc;
     Buffer *const cur_buf = _buf[input];
     Flit *const f = cur_buf->FrontFlit(vc);
-    long long int const expanded_output = item.second.second;
+    long long int const expanded_output = item.output;
     if (expanded_output >= 0)
     {
       long long int const expanded_input = input * _input_speedup + vc % _input_speedup;
@@ -1345,8 +1454,8 @@ void IQRouter::_SWAllocUpdate()
         match_vc = -1;
         long long int match_prio = numeric_limits<long long int>::min();
         const OutputSet *route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
-        for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
+        OutputSet const &setlist = route_set->GetSet();
+        for (OutputSet::const_iterator iset = setlist.begin(); iset != setlist.end(); ++iset)
         {
           if (iset->output_port == output)
           {
@@ -1394,8 +1503,11 @@ void IQRouter::_SWAllocUpdate()
 
       // MoRi
       /* added by [a.mazloumi and modarressi] */
-      SIM_buf_power_data_read(&(_orion_router_info.in_buf_info), &(_orion_router_power.in_buf), 0xffff0000);
-      _number_of_calls_of_power_functions++;
+      if (_orion_power)
+      {
+        _orion_activity.buf_reads++;
+        _number_of_calls_of_power_functions++;
+      }
       /* end [a.mazloumi and modarressi]@ */
 
       _bufferMonitor->read(input, f);
@@ -1415,29 +1527,32 @@ void IQRouter::_SWAllocUpdate()
             _noq_next_vc_start[input][vc] = -1;
             long long int next_vc_end = _noq_next_vc_end[input][vc];
             _noq_next_vc_end[input][vc] = -1;
-            f->la_route_set.Clear();
-            f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+            f->LaRouteSet().Clear();
+            f->LaRouteSet().AddRange(next_output_port, next_vc_start, next_vc_end);
           }
           else
           {
             long long int in_channel = channel->GetSinkPort();
-            _rf(router, f, in_channel, &f->la_route_set, false);
+            router->Route(_rf, f, in_channel, &f->LaRouteSet());
           }
         }
         else
         {
-          f->la_route_set.Clear();
+          f->ClearLaRouteSet();
         }
       }
       dest_buf->SendingFlit(f);
 
       // MoRi
       /* added by [a.mazloumi and modarressi] */
-      SIM_crossbar_record(&(_orion_router_power.crossbar), 1, 0xffffffff, 0x0000ffff, 0, 0); //sending to crossbar
-      _number_of_calls_of_power_functions++;
+      if (_orion_power)
+      {
+        _orion_activity.xbar_inputs++; //sending to crossbar
+        _number_of_calls_of_power_functions++;
+      }
       /* end [a.mazloumi and modarressi]codes */
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back({-1, f, expanded_input, expanded_output});
       if (_out_queue_credits.count(input) == 0)
       {
         _out_queue_credits.insert(make_pair(input, Credit::New()));
@@ -1458,19 +1573,19 @@ void IQRouter::_SWAllocUpdate()
           if (_routing_delay)
           {
             cur_buf->SetState(vc, VC::routing);
-            _route_vcs.push_back(make_pair(-1, item.second.first));
+            _route_vcs.push_back({-1, item.input, item.vc, -1});
           }
           else
           {
-            cur_buf->SetRouteSet(vc, &nf->la_route_set);
+            cur_buf->SetRouteSet(vc, &nf->LaRouteSet());
             cur_buf->SetState(vc, VC::vc_alloc);
             if (_speculative)
             {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+              _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
             }
             if (_vc_allocator)
             {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+              _vc_alloc_vcs.push_back({-1, item.input, item.vc, -1});
             }
             if (_noq)
             {
@@ -1485,18 +1600,18 @@ void IQRouter::_SWAllocUpdate()
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+            _sw_hold_vcs.push_back({-1, item.input, item.vc, -1});
           }
           else
           {
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+            _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
           }
         }
       }
     }
     else
     {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.push_back({-1, item.input, item.vc, -1});
     }
     _sw_alloc_vcs.pop_front();
     //    printf("\nTime:,%lld,%lld,[%lld][%lld],SWAllocUpdate,%lld\n", GetSimTime(), this->GetID(), f->id, f->pid, f->vc); //Sneha
@@ -1509,18 +1624,19 @@ void IQRouter::_SWAllocUpdate()
 
 void IQRouter::_SwitchEvaluate()
 {
-  for (deque<pair<long long int, pair<Flit *, pair<long long int, long long int>>>>::iterator iter = _crossbar_flits.begin(); iter != _crossbar_flits.end(); ++iter)
+  for (size_t i = 0; i < _crossbar_flits.size(); ++i)
   {
-    long long int const time = iter->first;
+    sCrossbarRequest &req = _crossbar_flits[i];
+    long long int const time = req.time;
     if (time >= 0)
     {
       break;
     }
-    iter->first = GetSimTime() + asyncConfig->getStFinalDelay(_id) - 1;
-    //Flit const *const f = iter->second.first;
+    req.time = GetSimTime() + asyncConfig->getStFinalDelay(_id) - 1;
+    //Flit const *const f = req.f;
     //    printf("\nTime:,%lld,%lld,[%lld][%lld],SWEvaluate,%lld\n", GetSimTime(), this->GetID(), f->id, f->pid, f->vc); //Sneha
-    //long long int const expanded_input = iter->second.second.first;
-    //long long int const expanded_output = iter->second.second.second;
+    //long long int const expanded_input = req.expanded_input;
+    //long long int const expanded_output = req.expanded_output;
   }
 }
 
@@ -1528,24 +1644,28 @@ void IQRouter::_SwitchUpdate()
 {
   while (!_crossbar_flits.empty())
   {
-    pair<long long int, pair<Flit *, pair<long long int, long long int>>> const &item = _crossbar_flits.front();
-    long long int const time = item.first;
+    sCrossbarRequest const &item = _crossbar_flits.front();
+    long long int const time = item.time;
     if ((time < 0) || (GetSimTime() < time))
     {
       break;
     }
-    Flit *const f = item.second.first;
-    long long int const expanded_input = item.second.second.first;
+    Flit *const f = item.f;
+    long long int const expanded_input = item.expanded_input;
     long long int const input = expanded_input / _input_speedup;
-    long long int const expanded_output = item.second.second.second;
+    long long int const expanded_output = item.expanded_output;
     long long int const output = expanded_output / _output_speedup;
     //    printf("\nTime:,%lld,%lld,[%lld][%lld],SWUpdate,%lld\n", GetSimTime(), this->GetID(), f->id, f->pid, f->vc); //Sneha
     _switchMonitor->traversal(input, output, f);
     // MoRi
     /* added by [a.mazloumi and modarressi]@*/
-    SIM_crossbar_record(&(_orion_router_power.crossbar), 0, 0xffffffff, 0x0000ffff, expanded_input, _orion_crosbar_last_match[expanded_output]);
-    _number_of_calls_of_power_functions++;
-    _orion_crosbar_last_match[expanded_output] = expanded_input;
+    if (_orion_power)
+    {
+      _orion_activity.xbar_outputs++;
+      _orion_activity.xbar_port_changes += (expanded_input != _orion_crosbar_last_match[expanded_output]);
+      _number_of_calls_of_power_functions++;
+      _orion_crosbar_last_match[expanded_output] = expanded_input;
+    }
     /* end [a.mazloumi and modarressi]@ codes */
     _output_buffer[output].push(f);
     //the output buffer size isn't precise due to flits in flight but there is a maximum bound based on output speed up and ST traversal
@@ -1671,17 +1791,15 @@ vector<long long int> IQRouter::MaxCredits() const
 
 void IQRouter::_UpdateNOQ(long long int input, long long int vc, Flit const *f)
 {
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
-  long long int out_port = sl.begin()->output_port;
+  long long int out_port = f->LaRouteSet().GetSet().begin()->output_port;
   const FlitChannel *channel = _output_channels[out_port];
   const Router *router = channel->GetSink();
   if (router)
   {
     long long int in_channel = channel->GetSinkPort();
     OutputSet nos;
-    _rf(router, f, in_channel, &nos, false);
-    sl = nos.GetSet();
-    OutputSet::sSetElement const &se = *sl.begin();
+    router->Route(_rf, f, in_channel, &nos);
+    OutputSet::sSetElement const &se = *nos.GetSet().begin();
     long long int next_output_port = se.output_port;
     _noq_next_output_port[input][vc] = next_output_port;
     long long int next_vc_count = (se.vc_end - se.vc_start + 1) / router->NumOutputs();
@@ -36,6 +36,8 @@
 
 #include "router.hpp"
 #include "routefunc.hpp"
+#include "stage_queue.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -64,20 +66,73 @@ class IQRouter : public Router
 
   bool _active;
 
+  // internal steps taken, counting those skipped by the event kernels, and
+  // the step the current idle window started at, or -1 while active
+  long long int _internal_time;
+  long long int _idle_since;
+
   long long int _routing_delay;
   long long int _vc_alloc_delay;
   long long int _sw_alloc_delay;
 
   map<long long int, Flit *> _in_queue_flits;
 
-  deque<pair<long long int, pair<Credit *, long long int>>> _proc_credits;
-
-  deque<pair<long long int, pair<long long int, long long int>>> _route_vcs;
-  deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>> _vc_alloc_vcs;
-  deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>> _sw_hold_vcs;
-  deque<pair<long long int, pair<pair<long long int, long long int>, long long int>>> _sw_alloc_vcs;
-
-  deque<pair<long long int, pair<Flit *, pair<long long int, long long int>>>> _crossbar_flits;
+  // pipeline stage requests; time is the cycle a request leaves its stage,
+  // or -1 until the stage has evaluated it
+  struct sCreditRequest
+  {
+    long long int time;
+    Credit *c;
+    long long int output;
+
+    void Serialize(Checkpoint &cp)
+    {
+      cp.Io(time);
+      cp.Io(c);
+      cp.Io(output);
+    }
+  };
+
+  struct sVCRequest
+  {
+    long long int time;
+    long long int input;
+    long long int vc;
+    long long int output; // assigned output or stall reason
+
+    void Serialize(Checkpoint &cp)
+    {
+      cp.Io(time);
+      cp.Io(input);
+      cp.Io(vc);
+      cp.Io(output);
+    }
+  };
+
+  struct sCrossbarRequest
+  {
+    long long int time;
+    Flit *f;
+    long long int expanded_input;
+    long long int expanded_output;
+
+    void Serialize(Checkpoint &cp)
+    {
+      cp.Io(time);
+      cp.Io(f);
+      cp.Io(expanded_input);
+      cp.Io(expanded_output);
+    }
+  };
+
+  StageQueue<sCreditRequest> _proc_credits;
+
+  StageQueue<sVCRequest> _route_vcs;
+  StageQueue<sVCRequest> _vc_alloc_vcs;
+  StageQueue<sVCRequest> _sw_hold_vcs;
+  StageQueue<sVCRequest> _sw_alloc_vcs;
+
+  StageQueue<sCrossbarRequest> _crossbar_flits;
 
   map<long long int, Credit *> _out_queue_credits;
 
@@ -117,6 +172,9 @@ class IQRouter : public Router
 
   virtual void _InternalStep();
 
+  long long int _GatedTicks(long long int idle) const;
+  void _EndIdleWindow(long long int idle);
+
   bool _SWAllocAddReq(unsigned int *_orion_current_sw_requset, long long int input, long long int vc, long long int output);
 
   void _InputQueuing();
@@ -161,6 +219,11 @@ public:
   virtual void ReadInputs();
   virtual void WriteOutputs();
 
+  virtual long long int NextEventTime() const;
+  virtual void Idle(long long int cycles);
+
+  virtual void Serialize(Checkpoint &cp);
+
   void Display(ostream &os = cout) const;
 
   virtual long long int GetUsedCredit(long long int o) const;
@@ -175,6 +238,10 @@ public:
   virtual vector<long long int> FreeCredits() const;
   virtual vector<long long int> MaxCredits() const;
 
+  // ticks of the idle window in progress and how many of them are gated
+  inline long long int GetIdleTicks() const { return (_idle_since < 0) ? 0 : (_internal_time - _idle_since); }
+  inline long long int GetGatedTicks() const { return _GatedTicks(GetIdleTicks()); }
+
   SwitchMonitor const *const GetSwitchMonitor() const { return _switchMonitor; }
   BufferMonitor const *const GetBufferMonitor() const { return _bufferMonitor; }
 };
@@ -14,7 +14,11 @@
 #include "booksim.hpp"
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include "router.hpp"
+#include "checkpoint.hpp"
+#include "routetable.hpp"
+#include "random_utils.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
@@ -31,7 +35,8 @@ long long int const Router::STALL_CROSSBAR_CONFLICT = -6;
 Router::Router(const Configuration &config,
                Module *parent, const string &name, long long int id,
                long long int inputs, long long int outputs) : TimedModule(parent, name), _id(id), _inputs(inputs), _outputs(outputs),
-                                                              _partial_internal_cycles(0.0)
+                                                              _partial_internal_cycles(0.0), _routing_table(NULL),
+                                                              _random_stream(NULL)
 {
 
   _crossbar_delay = asyncConfig->getStFinalDelay(id);
@@ -86,6 +91,9 @@ Router::Router(const Configuration &config,
   _number_of_crossed_flits = 0;
   _number_of_crossed_headerFlits = 0;
 
+  _orion_power = (config.GetLongInt("orion_power") > 0);
+  memset(&_orion_activity, 0, sizeof(_orion_activity));
+
   /*
 //XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX  Orion XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXxx
 NOTE: Orion 3 just provides power relations. 
@@ -94,6 +102,10 @@ we added these relations to Record and Report functions of Orion 2
 */
   //cout << "\n-- Orion 3 just provides power relations.\n";
   Flexus_Orion_init(config);
+  // SIM_router_init leaves the fields of unused buffers alone, and a router
+  // built after others were freed (as in a sweep) must not find stale flags
+  memset(&_orion_router_info, 0, sizeof(_orion_router_info));
+  memset(&_orion_router_power, 0, sizeof(_orion_router_power));
   SIM_router_init(&_orion_router_info, &_orion_router_power, NULL);
   //cout << "\n--power initilized in router<< -------------------------\n";
 
@@ -130,6 +142,7 @@ we added these relations to Record and Report functions of Orion 2
 // Orion Power Support
 Router::~Router()
 {
+  delete _random_stream;
   delete[] _orion_crosbar_last_match;
   delete[] _orion_last_sw_request;
   delete[] _orion_last_sw_grant;
@@ -139,6 +152,74 @@ Router::~Router()
   delete[] _orion_link_output_counters;
 }
 
+void Router::_Serialize(Checkpoint &cp, long long int vcs)
+{
+  cp.Io(_partial_internal_cycles);
+  cp.IoArray(_orion_link_output_counters, _outputs - 1);
+  cp.IoArray(_orion_last_sw_request, _inputs * _input_speedup);
+  cp.IoArray(_orion_last_sw_grant, _inputs * _input_speedup);
+  cp.IoArray(_orion_last_vc_reguest, _inputs * vcs);
+  cp.IoArray(_orion_last_vc_grant, _inputs * vcs);
+  cp.IoArray(_orion_crosbar_last_match, _outputs * _output_speedup);
+  cp.Io(_number_of_crossed_flits);
+  cp.Io(_number_of_crossed_headerFlits);
+  cp.Io(_number_of_calls_of_power_functions);
+  // the Orion models only hold counters and energies
+  cp.Raw(&_orion_router_power, sizeof(_orion_router_power));
+  cp.Raw(&_orion_activity, sizeof(_orion_activity));
+  if (_random_stream)
+  {
+    _random_stream->Serialize(cp);
+  }
+}
+
+void Router::Serialize(Checkpoint &cp)
+{
+  Error("Checkpointing is not supported by this router type.");
+}
+
+// Each kind of buffer and crossbar access always records the same activity,
+// so recording the counted accesses in bulk gives the same totals as
+// recording them as they happened.
+void Router::FlushOrionActivity()
+{
+  if (_orion_activity.buf_writes > 0)
+  {
+    u_char x[8] = "abcdefg";
+    u_char y[8] = "pqrstuv";
+    u_char z[8] = "abcdtuv";
+    SIM_buf_power_data_write_n(&(_orion_router_info.in_buf_info), &(_orion_router_power.in_buf), x, y, z,
+                               _orion_activity.buf_writes);
+  }
+  if (_orion_activity.buf_reads > 0)
+  {
+    SIM_buf_power_data_read_n(&(_orion_router_info.in_buf_info), &(_orion_router_power.in_buf), 0xffff0000,
+                              _orion_activity.buf_reads);
+  }
+  if (_orion_activity.xbar_inputs > 0)
+  {
+    SIM_crossbar_record_n(&(_orion_router_power.crossbar), 1, 0xffffffff, 0x0000ffff,
+                          _orion_activity.xbar_inputs, 0);
+  }
+  if (_orion_activity.xbar_outputs > 0)
+  {
+    // only whether the matched input changed matters to the model
+    SIM_crossbar_record_n(&(_orion_router_power.crossbar), 0, 0xffffffff, 0x0000ffff,
+                          _orion_activity.xbar_outputs, _orion_activity.xbar_port_changes);
+  }
+  if (_orion_activity.sw_arb.records > 0)
+  {
+    SIM_arbiter_record_n(&(_orion_router_power.sw_out_arb), _orion_activity.sw_arb.records,
+                         _orion_activity.sw_arb.chg_req, _orion_activity.sw_arb.chg_grant);
+  }
+  if (_orion_activity.vc_arb.records > 0)
+  {
+    SIM_arbiter_record_n(&(_orion_router_power.vc_out_arb), _orion_activity.vc_arb.records,
+                         _orion_activity.vc_arb.chg_req, _orion_activity.vc_arb.chg_grant);
+  }
+  memset(&_orion_activity, 0, sizeof(_orion_activity));
+}
+
 void Router::AddInputChannel(FlitChannel *channel, CreditChannel *backchannel)
 {
   _input_channels.push_back(channel);
@@ -154,8 +235,18 @@ void Router::AddOutputChannel(FlitChannel *channel, CreditChannel *backchannel)
   channel->SetSource(this, _output_channels.size() - 1);
 }
 
+void Router::SeedRandomStream(long long int seed, long long int id)
+{
+  if (!_random_stream)
+  {
+    _random_stream = new RandomStream;
+  }
+  _random_stream->Seed(seed, RANDOM_ROUTER, id);
+}
+
 void Router::Evaluate()
 {
+  RandomStreamScope random_scope(_random_stream);
   _partial_internal_cycles += _internal_speedup;
   while (_partial_internal_cycles >= 1.0)
   {
@@ -164,6 +255,18 @@ void Router::Evaluate()
   }
 }
 
+void Router::Route(tRoutingFunction rf, const Flit *f, long long int in_channel, OutputSet *outputs) const
+{
+  if (_routing_table && !f->watch)
+  {
+    _routing_table->Route(_id, f, outputs);
+  }
+  else
+  {
+    rf(this, f, in_channel, outputs, false);
+  }
+}
+
 void Router::OutChannelFault(long long int c, bool fault)
 {
   assert((c >= 0) && ((size_t)c < _channel_faults.size()));
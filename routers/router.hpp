@@ -41,9 +41,17 @@
 
 // Orion Power Support
 #include "SIM_router.h"
+#include "SIM_util.h"
 
 typedef Channel<Credit> CreditChannel;
 
+class Checkpoint;
+class Router;
+class RoutingTable;
+class RandomStream;
+
+typedef void (*tRoutingFunction)(const Router *, const Flit *, long long int in_channel, OutputSet *, bool);
+
 class Router : public TimedModule
 {
 
@@ -70,6 +78,14 @@ protected:
   long long int _crossbar_delay;
   long long int _credit_delay;
 
+  // precomputed routes, shared by all routers of the simulation; NULL unless
+  // routing_table is set
+  const RoutingTable *_routing_table;
+
+  // random draws made while the router is evaluated; NULL unless
+  // random_streams is set
+  RandomStream *_random_stream;
+
   vector<FlitChannel *> _input_channels;
   vector<CreditChannel *> _input_credits;
   vector<FlitChannel *> _output_channels;
@@ -94,6 +110,9 @@ protected:
 
   virtual void _InternalStep() = 0;
 
+  // state shared by all router types; vcs sizes the Orion VC arbiter state
+  void _Serialize(Checkpoint &cp, long long int vcs);
+
 public:
   // Orion Power Support
 
@@ -125,6 +144,47 @@ public:
   int _number_of_crossed_headerFlits;
   int _number_of_calls_of_power_functions;
 
+  // Orion activity is only tracked when orion_power is set. The pipeline
+  // counts events here, and FlushOrionActivity() feeds them to the Orion
+  // models before a report is taken.
+  bool _orion_power;
+
+  struct sOrionArbiterActivity
+  {
+    long long int records;
+    long long int chg_req;
+    long long int chg_grant;
+  };
+
+  struct sOrionActivity
+  {
+    long long int buf_writes;
+    long long int buf_reads;
+    long long int xbar_inputs;
+    long long int xbar_outputs;
+    long long int xbar_port_changes;
+    sOrionArbiterActivity sw_arb;
+    sOrionArbiterActivity vc_arb;
+  };
+  sOrionActivity _orion_activity;
+
+  static inline unsigned int OrionRequestBit(long long int index)
+  {
+    // requests beyond the width of the bit vector are dropped
+    return (index < 32) ? (1u << index) : 0u;
+  }
+
+  static inline void RecordOrionArbiter(sOrionArbiterActivity &activity, SIM_arbiter_t const &arb,
+                                        unsigned int new_req, unsigned int old_req,
+                                        int new_grant, int old_grant)
+  {
+    ++activity.records;
+    activity.chg_req += SIM_Hamming(new_req, old_req, arb.mask);
+    activity.chg_grant += (new_grant != old_grant);
+  }
+
+  void FlushOrionActivity();
+
   Router(const Configuration &config,
          Module *parent, const string &name, long long int id,
          long long int inputs, long long int outputs);
@@ -149,6 +209,10 @@ public:
     assert((output >= 0) && (output < _outputs));
     return _output_channels[output];
   }
+  inline vector<FlitChannel *> const &GetInputChannels() const { return _input_channels; }
+  inline vector<CreditChannel *> const &GetInputCredits() const { return _input_credits; }
+  inline vector<FlitChannel *> const &GetOutputChannels() const { return _output_channels; }
+  inline vector<CreditChannel *> const &GetOutputCredits() const { return _output_credits; }
 
   virtual void ReadInputs() = 0;
   virtual void Evaluate();
@@ -159,6 +223,14 @@ public:
 
   inline long long int GetID() const { return _id; }
 
+  inline void SetRoutingTable(const RoutingTable *table) { _routing_table = table; }
+
+  void SeedRandomStream(long long int seed, long long int id);
+
+  // routes f at this router, from the routing table when there is one;
+  // watched flits always take the routing function so that it can log
+  void Route(tRoutingFunction rf, const Flit *f, long long int in_channel, OutputSet *outputs) const;
+
   virtual long long int GetUsedCredit(long long int o) const = 0;
   virtual long long int GetBufferOccupancy(long long int i) const = 0;
 
@@ -203,6 +275,9 @@ public:
   }
 #endif
 
+  // saves or restores the router state for a checkpoint
+  virtual void Serialize(Checkpoint &cp);
+
   virtual vector<long long int> UsedCredits() const = 0;
   virtual vector<long long int> FreeCredits() const = 0;
   virtual vector<long long int> MaxCredits() const = 0;
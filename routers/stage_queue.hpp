@@ -0,0 +1,86 @@
+// $Id$
+
+#ifndef _STAGE_QUEUE_HPP_
+#define _STAGE_QUEUE_HPP_
+
+#include <vector>
+#include <cstddef>
+
+#include "checkpoint.hpp"
+
+using namespace std;
+
+// FIFO of pipeline stage requests kept in a ring buffer, so that requests
+// moving through a router stage reuse the same storage instead of allocating
+// and releasing deque chunks. Requests leave a stage in the order they
+// entered it; the ring only grows when a stage holds more requests than ever
+// before.
+template <typename T>
+class StageQueue
+{
+  vector<T> _ring;
+  size_t _head;
+  size_t _count;
+  size_t _mask;
+
+  void _Grow()
+  {
+    vector<T> ring(_ring.empty() ? 16 : 2 * _ring.size());
+    for (size_t i = 0; i < _count; ++i)
+    {
+      ring[i] = (*this)[i];
+    }
+    _ring.swap(ring);
+    _head = 0;
+    _mask = _ring.size() - 1;
+  }
+
+public:
+  StageQueue() : _head(0), _count(0), _mask(0) {}
+
+  inline bool empty() const { return _count == 0; }
+  inline size_t size() const { return _count; }
+
+  inline T &operator[](size_t i) { return _ring[(_head + i) & _mask]; }
+  inline T const &operator[](size_t i) const { return _ring[(_head + i) & _mask]; }
+
+  inline T &front() { return _ring[_head]; }
+  inline T const &front() const { return _ring[_head]; }
+
+  void push_back(T item)
+  {
+    if (_count == _ring.size())
+    {
+      _Grow();
+    }
+    _ring[(_head + _count) & _mask] = item;
+    ++_count;
+  }
+
+  void pop_front()
+  {
+    _head = (_head + 1) & _mask;
+    --_count;
+  }
+
+  void Serialize(Checkpoint &cp)
+  {
+    size_t count = _count;
+    cp.Io(count);
+    if (cp.Restoring())
+    {
+      _head = 0;
+      _count = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+        push_back(T());
+      }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+      cp.Io((*this)[i]);
+    }
+  }
+};
+
+#endif
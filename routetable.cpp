@@ -0,0 +1,65 @@
+// $Id$
+
+#include <iostream>
+#include <cstdlib>
+
+#include "booksim.hpp"
+#include "routetable.hpp"
+#include "globals.hpp"
+
+RoutingTable::RoutingTable(tRoutingFunction rf, const vector<Router *> &routers,
+                           long long int nodes, long long int classes)
+    : _nodes(nodes), _classes(classes)
+{
+  long long int ids = 0;
+  for (size_t i = 0; i < routers.size(); ++i)
+  {
+    ids = max(ids, routers[i]->GetID() + 1);
+  }
+  _route.resize(ids * _nodes * _classes);
+  _inject.resize(_nodes * _classes);
+
+  // a single probe flit carries each destination and class through the
+  // routing function; it is never injected
+  Flit *const f = Flit::New();
+  --g_number_of_injected_flits;
+
+  for (long long int dest = 0; dest < _nodes; ++dest)
+  {
+    f->dest = dest;
+    for (long long int cl = 0; cl < _classes; ++cl)
+    {
+      f->cl = cl;
+      f->vc = gBeginVCs[cl];
+      for (size_t i = 0; i < routers.size(); ++i)
+      {
+        Router const *const r = routers[i];
+        _route[(r->GetID() * _nodes + dest) * _classes + cl] = _Probe(rf, r, f, false);
+      }
+      f->vc = -1;
+      _inject[dest * _classes + cl] = _Probe(rf, NULL, f, true);
+    }
+  }
+
+  f->Free();
+}
+
+RoutingTable::sEntry RoutingTable::_Probe(tRoutingFunction rf, const Router *r, Flit *f, bool inject)
+{
+  OutputSet route_set;
+  rf(r, f, inject ? -1 : 0, &route_set, inject);
+  OutputSet const &os = route_set.GetSet();
+  if (os.size() != 1)
+  {
+    cerr << "Routing table: the routing function returned " << os.size()
+         << " routes for destination " << f->dest << " at "
+         << (r ? r->FullName() : "injection") << "." << endl;
+    exit(-1);
+  }
+  sEntry e;
+  e.output_port = os.begin()->output_port;
+  e.vc_start = os.begin()->vc_start;
+  e.vc_end = os.begin()->vc_end;
+  e.pri = os.begin()->pri;
+  return e;
+}
@@ -0,0 +1,58 @@
+// $Id$
+
+#ifndef _ROUTETABLE_HPP_
+#define _ROUTETABLE_HPP_
+
+#include <vector>
+
+#include "routefunc.hpp"
+
+// Routes of a deterministic routing function, computed once for every
+// (router, destination, class) and for injection. Only functions whose
+// result depends on nothing else can be tabulated; they are listed in
+// gTableRoutingFunctions.
+class RoutingTable
+{
+public:
+  struct sEntry
+  {
+    long long int output_port;
+    long long int vc_start;
+    long long int vc_end;
+    long long int pri;
+  };
+
+private:
+  long long int _nodes;
+  long long int _classes;
+
+  // [router][dest][class]
+  vector<sEntry> _route;
+  // [dest][class], for the VC range of injected flits
+  vector<sEntry> _inject;
+
+  static sEntry _Probe(tRoutingFunction rf, const Router *r, Flit *f, bool inject);
+
+public:
+  RoutingTable(tRoutingFunction rf, const vector<Router *> &routers,
+               long long int nodes, long long int classes);
+
+  inline sEntry const &Lookup(long long int router, long long int dest, long long int cl) const
+  {
+    return _route[(router * _nodes + dest) * _classes + cl];
+  }
+
+  inline sEntry const &LookupInject(long long int dest, long long int cl) const
+  {
+    return _inject[dest * _classes + cl];
+  }
+
+  inline void Route(long long int router, const Flit *f, OutputSet *outputs) const
+  {
+    sEntry const &e = Lookup(router, f->dest, f->cl);
+    outputs->Clear();
+    outputs->AddRange(e.output_port, e.vc_start, e.vc_end, e.pri);
+  }
+};
+
+#endif
@@ -0,0 +1,280 @@
+// $Id$
+
+#include <sstream>
+#include <algorithm>
+#include <limits>
+
+#include "saturationtrafficmanager.hpp"
+
+SaturationTrafficManager::SaturationTrafficManager(const Configuration &config, const vector<Network *> &net)
+    : SteadyStateTrafficManager(config, net), _config(config)
+{
+  // every probe is a latency simulation
+  _measure_latency = true;
+
+  _base_rate = config.GetFloatArray("injection_rate");
+  if (_base_rate.empty())
+  {
+    _base_rate.push_back(config.GetFloat("injection_rate"));
+  }
+  _base_rate.resize(_classes, _base_rate.back());
+
+  _latency_factor = config.GetFloat("sat_latency_factor");
+  if (_latency_factor <= 1.0)
+  {
+    Error("sat_latency_factor must be greater than 1");
+  }
+  _precision = config.GetFloat("sat_precision");
+  _max_probes = config.GetLongInt("sat_max_probes");
+
+  _sat_low = 0.0;
+  _sat_high = -1.0;
+}
+
+double SaturationTrafficManager::_Rate(double scale, long long int c) const
+{
+  return scale * _base_rate[c];
+}
+
+SaturationTrafficManager::sProbe const &SaturationTrafficManager::_Probe(double scale)
+{
+  cout << "Saturation probe " << _probes.size() << " at injection rate";
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    cout << " " << _Rate(scale, c);
+    delete _injection_process[c];
+    _injection_process[c] = InjectionProcess::New(_injection[c], _nodes, scale * _load[c], &_config);
+
+    // packets the previous probe still owed its sources are dropped
+    _qtime[c].assign(_nodes, _time);
+    _qdrained[c].assign(_nodes, false);
+  }
+  _ScheduleInjections();
+  cout << endl;
+
+  _ClearStats();
+
+  sProbe probe;
+  probe.scale = scale;
+  probe.stable = _SingleSim();
+  probe.latency.resize(_classes, numeric_limits<double>::quiet_NaN());
+  probe.accepted.resize(_classes, numeric_limits<double>::quiet_NaN());
+  if (probe.stable)
+  {
+    double const time_delta = (double)(_drain_time - _reset_time);
+    for (long long int c = 0; c < _classes; ++c)
+    {
+      long long int accepted_count;
+      _ComputeStats(_accepted_flits[c], &accepted_count);
+      probe.latency[c] = _plat_stats[c]->Average();
+      probe.accepted[c] = (double)accepted_count / time_delta / (double)_nodes;
+    }
+  }
+  else
+  {
+    // an unstable network is no use as the starting point of the next probe
+    _DrainNetwork();
+  }
+
+  _probes.push_back(probe);
+  return _probes.back();
+}
+
+bool SaturationTrafficManager::_Saturated(sProbe const &probe) const
+{
+  if (!probe.stable)
+  {
+    return true;
+  }
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    if (_measure_stats[c] &&
+        (probe.latency[c] > _latency_factor * _zero_load_latency[c]))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// latency of the class closest to saturation, relative to its threshold
+static double SaturationLevel(vector<double> const &latency, vector<double> const &zero_load,
+                              vector<long long int> const &measure, double factor)
+{
+  double level = 0.0;
+  for (size_t c = 0; c < latency.size(); ++c)
+  {
+    if (measure[c])
+    {
+      level = max(level, latency[c] / (factor * zero_load[c]));
+    }
+  }
+  return level;
+}
+
+static bool ProbeBefore(SaturationTrafficManager::sProbe const &a,
+                        SaturationTrafficManager::sProbe const &b)
+{
+  return a.scale < b.scale;
+}
+
+bool SaturationTrafficManager::Run()
+{
+  _ResetSim();
+  _ClearStats();
+
+  if (!_Probe(1.0).stable)
+  {
+    cout << "Simulation unstable at the initial injection rate, ending ..." << endl;
+    return false;
+  }
+  _zero_load_latency = _probes[0].latency;
+
+  double max_scale = numeric_limits<double>::max();
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    if (_load[c] > 0.0)
+    {
+      max_scale = min(max_scale, 1.0 / _load[c]);
+    }
+  }
+
+  // the highest unsaturated and the lowest saturated probe seen so far
+  sProbe low = _probes[0];
+  sProbe high;
+  high.scale = -1.0;
+  high.stable = false;
+
+  // saturation levels of the bracket ends as used by the secant step, and
+  // which end the last probe left in place (-1 low, 1 high, 0 none yet)
+  double low_level = SaturationLevel(low.latency, _zero_load_latency, _measure_stats, _latency_factor);
+  double high_level = 0.0;
+  long long int kept = 0;
+
+  while ((long long int)_probes.size() < _max_probes)
+  {
+    double scale;
+    if (high.scale < 0.0)
+    {
+      if (low.scale >= max_scale)
+      {
+        break;
+      }
+      scale = min(2.0 * low.scale, max_scale);
+    }
+    else
+    {
+      double const width = high.scale - low.scale;
+      if (width <= _precision * high.scale)
+      {
+        break;
+      }
+      scale = low.scale + width / 2.0;
+      if (high.stable && (high_level > low_level))
+      {
+        // secant step towards the threshold, kept off the bracket ends
+        scale = low.scale + width * (1.0 - low_level) / (high_level - low_level);
+        scale = max(scale, low.scale + 0.1 * width);
+        scale = min(scale, high.scale - 0.1 * width);
+      }
+    }
+
+    sProbe const probe = _Probe(scale);
+    double const level = SaturationLevel(probe.latency, _zero_load_latency, _measure_stats, _latency_factor);
+    if (_Saturated(probe))
+    {
+      high = probe;
+      high_level = level;
+      // Illinois step: an end kept twice in a row pulls half as hard, so a
+      // convex latency curve does not leave the secant creeping up to it
+      if (kept < 0)
+      {
+        low_level = 1.0 - (1.0 - low_level) / 2.0;
+      }
+      kept = -1;
+    }
+    else
+    {
+      low = probe;
+      low_level = level;
+      if ((kept > 0) && high.stable)
+      {
+        high_level = 1.0 + (high_level - 1.0) / 2.0;
+      }
+      kept = 1;
+    }
+  }
+
+  _sat_low = low.scale;
+  _sat_high = high.scale;
+
+  vector<sProbe> curve = _probes;
+  sort(curve.begin(), curve.end(), ProbeBefore);
+
+  cout << "====== Saturation search ======" << endl;
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    if (_measure_stats[c] == 0)
+    {
+      continue;
+    }
+    cout << "Class " << c << ":" << endl;
+    cout << "Zero-load packet latency = " << _zero_load_latency[c] << endl;
+    for (size_t p = 0; p < curve.size(); ++p)
+    {
+      cout << "Injection rate = " << _Rate(curve[p].scale, c);
+      if (curve[p].stable)
+      {
+        cout << ", packet latency = " << curve[p].latency[c]
+             << ", accepted flit rate = " << curve[p].accepted[c] << endl;
+      }
+      else
+      {
+        cout << ", unstable" << endl;
+      }
+    }
+    if (_sat_high < 0.0)
+    {
+      cout << "No saturation up to injection rate " << _Rate(_sat_low, c) << endl;
+    }
+    else
+    {
+      cout << "Saturation injection rate = " << _Rate((_sat_low + _sat_high) / 2.0, c)
+           << " (between " << _Rate(_sat_low, c) << " and " << _Rate(_sat_high, c) << ")" << endl;
+    }
+  }
+
+  if (_print_csv_results)
+  {
+    DisplayOverallStatsCSV();
+  }
+
+  // Orion Power Support
+  if (_orion_power)
+  {
+    _ComputeOrionPower();
+  }
+  return true;
+}
+
+string SaturationTrafficManager::_OverallStatsHeaderCSV() const
+{
+  ostringstream os;
+  os << "traffic"
+     << ',' << "zero_load_plat"
+     << ',' << "sat_rate_low"
+     << ',' << "sat_rate_high"
+     << ',' << "probes";
+  return os.str();
+}
+
+string SaturationTrafficManager::_OverallClassStatsCSV(long long int c) const
+{
+  ostringstream os;
+  os << _traffic[c]
+     << ',' << _zero_load_latency[c]
+     << ',' << _Rate(_sat_low, c)
+     << ',' << ((_sat_high < 0.0) ? -1.0 : _Rate(_sat_high, c))
+     << ',' << _probes.size();
+  return os.str();
+}
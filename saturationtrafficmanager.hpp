@@ -0,0 +1,59 @@
+// $Id$
+
+#ifndef _SATURATIONTRAFFICMANAGER_HPP_
+#define _SATURATIONTRAFFICMANAGER_HPP_
+
+#include <vector>
+
+#include "steadystatetrafficmanager.hpp"
+
+// Searches for the saturation injection rate in a single process. Every
+// probe is a steady-state latency simulation at a multiple of the configured
+// injection rates, run on the same network; a stable probe hands its warm
+// network to the next one, an unstable one is drained first. The first probe
+// runs at the configured rates and sets the zero-load latency. A probe is
+// saturated when it is unstable or its latency exceeds sat_latency_factor
+// times the zero-load latency. The rate is doubled until a probe saturates,
+// and the bracket is then narrowed by secant steps on the latency curve,
+// falling back to bisection.
+class SaturationTrafficManager : public SteadyStateTrafficManager
+{
+
+public:
+  // outcome of one probe; latency and accepted rate per class
+  struct sProbe
+  {
+    double scale;
+    bool stable;
+    vector<double> latency;
+    vector<double> accepted;
+  };
+
+protected:
+  // injection processes are rebuilt for every probe from the configuration
+  Configuration _config;
+  vector<double> _base_rate;
+
+  double _latency_factor;
+  double _precision;
+  long long int _max_probes;
+
+  vector<sProbe> _probes;
+  vector<double> _zero_load_latency;
+  double _sat_low;
+  double _sat_high;
+
+  sProbe const &_Probe(double scale);
+  bool _Saturated(sProbe const &probe) const;
+  double _Rate(double scale, long long int c) const;
+
+  virtual string _OverallStatsHeaderCSV() const;
+  virtual string _OverallClassStatsCSV(long long int c) const;
+
+public:
+  SaturationTrafficManager(const Configuration &config, const vector<Network *> &net);
+
+  virtual bool Run();
+};
+
+#endif
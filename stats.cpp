@@ -16,6 +16,7 @@
 #include <cstdio>
 
 #include "stats.hpp"
+#include "checkpoint.hpp"
 
 Stats::Stats(Module *parent, const string &name,
              double bin_size, long long int num_bins) : Module(parent, name), _num_bins(num_bins), _bin_size(bin_size)
@@ -88,6 +89,16 @@ void Stats::AddSample(double val)
   _hist[b]++;
 }
 
+void Stats::Serialize(Checkpoint &cp)
+{
+  cp.Io(_num_samples);
+  cp.Io(_sample_sum);
+  cp.Io(_sample_squared_sum);
+  cp.Io(_min);
+  cp.Io(_max);
+  cp.Io(_hist);
+}
+
 void Stats::Display(ostream &os) const
 {
   os << *this << endl;
@@ -5,6 +5,8 @@
 
 #include "module.hpp"
 
+class Checkpoint;
+
 class Stats : public Module
 {
   long long int _num_samples;
@@ -44,6 +46,8 @@ public:
 
   void Display(ostream &os = cout) const;
 
+  void Serialize(Checkpoint &cp);
+
   friend ostream &operator<<(ostream &os, const Stats &s);
 };
 
@@ -2,8 +2,65 @@
 
 #include <cmath>
 #include <sstream>
+#include <algorithm>
+#include <limits>
 
 #include "steadystatetrafficmanager.hpp"
+#include "checkpoint.hpp"
+
+// quantile of the standard normal distribution (Acklam's approximation,
+// relative error below 1.2e-9)
+static double NormalQuantile(double p)
+{
+  static double const a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                             -2.759285104469687e+02, 1.383577518672690e+02,
+                             -3.066479806614716e+01, 2.506628277459239e+00};
+  static double const b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                             -1.556989798598866e+02, 6.680131188771972e+01,
+                             -1.328068155288572e+01};
+  static double const c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                             -2.400758277161838e+00, -2.549732539343734e+00,
+                             4.374664141464968e+00, 2.938163982698783e+00};
+  static double const d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                             2.445134137142996e+00, 3.754408661907416e+00};
+
+  assert((p > 0.0) && (p < 1.0));
+  if (p < 0.02425)
+  {
+    double const q = sqrt(-2.0 * log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+  }
+  if (p > 1.0 - 0.02425)
+  {
+    return -NormalQuantile(1.0 - p);
+  }
+  double const q = p - 0.5;
+  double const r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// quantile of Student's t distribution; exact for one and two degrees of
+// freedom, a Cornish-Fisher expansion around the normal quantile above
+static double StudentQuantile(double p, long long int dof)
+{
+  assert(dof > 0);
+  if (dof == 1)
+  {
+    return tan(M_PI * (p - 0.5));
+  }
+  if (dof == 2)
+  {
+    return (2.0 * p - 1.0) / sqrt(2.0 * p * (1.0 - p));
+  }
+  double const z = NormalQuantile(p);
+  double const z2 = z * z;
+  double const v = (double)dof;
+  return z + z * (z2 + 1.0) / (4.0 * v) +
+         z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * v * v) +
+         z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) / (384.0 * v * v * v);
+}
 
 SteadyStateTrafficManager::SteadyStateTrafficManager(const Configuration &config, const vector<Network *> &net)
     : SyntheticTrafficManager(config, net)
@@ -32,6 +89,15 @@ SteadyStateTrafficManager::SteadyStateTrafficManager(const Configuration &config
     _injection_process[c] = InjectionProcess::New(_injection[c], _nodes, _load[c], &config);
   }
 
+  if (_random_streams)
+  {
+    _injection_random.resize(_classes * _nodes);
+    for (long long int i = 0; i < _classes * _nodes; ++i)
+    {
+      _injection_random[i].Seed(_seed, RANDOM_INJECTION, i);
+    }
+  }
+
   _measure_latency = (config.GetStr("sim_type") == "latency");
 
   _sample_period = config.GetLongInt("sample_period");
@@ -72,6 +138,53 @@ SteadyStateTrafficManager::SteadyStateTrafficManager(const Configuration &config
     _acc_stopping_threshold.push_back(config.GetFloat("acc_stopping_thres"));
   }
   _acc_stopping_threshold.resize(_classes, _acc_stopping_threshold.back());
+
+  string const stopping_rule = config.GetStr("stopping_rule");
+  if (stopping_rule == "batch_means")
+  {
+    _batch_means = true;
+  }
+  else if (stopping_rule == "change")
+  {
+    _batch_means = false;
+  }
+  else
+  {
+    Error("Unknown stopping rule: " + stopping_rule);
+  }
+
+  _batch_period = config.GetLongInt("batch_period");
+  if (_batch_period <= 0)
+  {
+    _batch_period = _sample_period;
+  }
+  _min_batches = config.GetLongInt("min_batches");
+  if (_min_batches < 2)
+  {
+    Error("min_batches must be at least 2");
+  }
+  _max_batches = config.GetLongInt("max_batches");
+  _batch_confidence = config.GetFloat("batch_confidence");
+  if ((_batch_confidence <= 0.0) || (_batch_confidence >= 1.0))
+  {
+    Error("batch_confidence must lie between 0 and 1");
+  }
+
+  _batch_precision = config.GetFloatArray("batch_precision");
+  if (_batch_precision.empty())
+  {
+    _batch_precision.push_back(config.GetFloat("batch_precision"));
+  }
+  _batch_precision.resize(_classes, _batch_precision.back());
+
+  _acc_batch_precision = config.GetFloatArray("acc_batch_precision");
+  if (_acc_batch_precision.empty())
+  {
+    _acc_batch_precision.push_back(config.GetFloat("acc_batch_precision"));
+  }
+  _acc_batch_precision.resize(_classes, _acc_batch_precision.back());
+
+  _skip_ahead = (config.GetLongInt("skip_ahead_injection") > 0);
 }
 
 SteadyStateTrafficManager::~SteadyStateTrafficManager()
@@ -82,18 +195,128 @@ SteadyStateTrafficManager::~SteadyStateTrafficManager()
   }
 }
 
+long long int SteadyStateTrafficManager::_CreatePacket(long long int source, long long int cl)
+{
+  RandomStreamScope random_scope(_TrafficStream(cl, source));
+  long long int dest = _traffic_pattern[cl]->dest(source);
+  long long int size = _GetNextPacketSize(cl);
+  long long int time = ((_include_queuing == 1) ? _qtime[cl][source] : _time);
+  return _GeneratePacket(source, dest, size, cl, time);
+}
+
 long long int SteadyStateTrafficManager::_IssuePacket(long long int source, long long int cl)
 {
-  if (_injection_process[cl]->test(source))
+  bool issue;
+  {
+    RandomStreamScope random_scope(_InjectionStream(cl, source));
+    issue = _injection_process[cl]->test(source);
+  }
+  if (issue)
   {
-    long long int dest = _traffic_pattern[cl]->dest(source);
-    long long int size = _GetNextPacketSize(cl);
-    long long int time = ((_include_queuing == 1) ? _qtime[cl][source] : _time);
-    return _GeneratePacket(source, dest, size, cl, time);
+    return _CreatePacket(source, cl);
   }
   return -1;
 }
 
+void SteadyStateTrafficManager::_ScheduleNext(long long int source, long long int cl)
+{
+  long long int gap;
+  {
+    RandomStreamScope random_scope(_InjectionStream(cl, source));
+    gap = _injection_process[cl]->next(source);
+  }
+  if (gap < 0)
+  {
+    _next_inject[cl][source] = numeric_limits<long long int>::max();
+    return;
+  }
+  _next_inject[cl][source] = _qtime[cl][source] + gap;
+  _inject_schedule.push(make_pair(_next_inject[cl][source], cl * _nodes + source));
+}
+
+void SteadyStateTrafficManager::_ScheduleInjections()
+{
+  if (!_skip_ahead)
+  {
+    return;
+  }
+  _inject_schedule = priority_queue<pair<long long int, long long int>,
+                                    vector<pair<long long int, long long int>>,
+                                    greater<pair<long long int, long long int>>>();
+  _next_inject.assign(_classes, vector<long long int>(_nodes, numeric_limits<long long int>::max()));
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    if (_request_class[c] < 0)
+    {
+      for (long long int source = 0; source < _nodes; ++source)
+      {
+        _ScheduleNext(source, c);
+      }
+    }
+  }
+}
+
+void SteadyStateTrafficManager::_Inject()
+{
+  if (!_skip_ahead)
+  {
+    SyntheticTrafficManager::_Inject();
+    return;
+  }
+
+  // a packet issued at _next_inject is the one the per-cycle loop would have
+  // found by testing up to cycle _next_inject - 1
+  _due.clear();
+  while (!_inject_schedule.empty() && (_inject_schedule.top().first <= _time + 1))
+  {
+    _due.push_back(_inject_schedule.top().second);
+    _inject_schedule.pop();
+  }
+  // same order as the per-cycle loop
+  sort(_due.begin(), _due.end());
+
+  for (size_t i = 0; i < _due.size(); ++i)
+  {
+    long long int const c = _due[i] / _nodes;
+    long long int const source = _due[i] % _nodes;
+    if (!_partial_packets[c][source].empty())
+    {
+      // still busy with its last packet; the new one queues behind it
+      _inject_schedule.push(make_pair(_next_inject[c][source], _due[i]));
+      continue;
+    }
+    _qtime[c][source] = _next_inject[c][source];
+    _CreatePacket(source, c);
+    _requests_outstanding[c][source]++;
+    _packet_seq_no[c][source]++;
+    if ((_sim_state == draining) && (_qtime[c][source] > _drain_time))
+    {
+      _qdrained[c][source] = true;
+    }
+    _ScheduleNext(source, c);
+  }
+
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    if ((_request_class[c] < 0) && (_sim_state != draining))
+    {
+      continue;
+    }
+    for (long long int source = 0; source < _nodes; ++source)
+    {
+      if (_partial_packets[c][source].empty())
+      {
+        // an idle source has tested every cycle up to now in vain
+        _qtime[c][source] = (_request_class[c] >= 0) ? _time : (_time + 1);
+        if ((_sim_state == draining) && (_qtime[c][source] > _drain_time))
+        {
+          _qdrained[c][source] = true;
+        }
+      }
+    }
+  }
+}
+
 void SteadyStateTrafficManager::_ResetSim()
 {
   SyntheticTrafficManager::_ResetSim();
@@ -102,6 +325,38 @@ void SteadyStateTrafficManager::_ResetSim()
   {
     _injection_process[c]->reset();
   }
+  _ScheduleInjections();
+}
+
+void SteadyStateTrafficManager::_Serialize(Checkpoint &cp)
+{
+  SyntheticTrafficManager::_Serialize(cp);
+  for (long long int c = 0; c < _classes; ++c)
+  {
+    _injection_process[c]->Serialize(cp);
+  }
+  cp.Io(_injection_random);
+  cp.Check(_skip_ahead, "skip_ahead_injection");
+  if (_skip_ahead)
+  {
+    cp.Io(_next_inject);
+    if (cp.Restoring())
+    {
+      _inject_schedule = priority_queue<pair<long long int, long long int>,
+                                        vector<pair<long long int, long long int>>,
+                                        greater<pair<long long int, long long int>>>();
+      for (long long int c = 0; c < _classes; ++c)
+      {
+        for (long long int source = 0; source < _nodes; ++source)
+        {
+          if (_next_inject[c][source] < numeric_limits<long long int>::max())
+          {
+            _inject_schedule.push(make_pair(_next_inject[c][source], c * _nodes + source));
+          }
+        }
+      }
+    }
+  }
 }
 
 bool SteadyStateTrafficManager::_SingleSim()
@@ -127,10 +382,29 @@ bool SteadyStateTrafficManager::_SingleSim()
   vector<double> prev_accepted(_classes, 0.0);
   bool clear_last = false;
   long long int total_phases = 0;
+
+  if (!_checkpoint_in.empty())
+  {
+    Checkpoint cp(_checkpoint_in, Checkpoint::restore);
+    _Serialize(cp);
+    cp.Io(prev_latency);
+    cp.Io(prev_accepted);
+    cp.Io(clear_last);
+    cp.Io(total_phases);
+    cout << "Restored checkpoint " << _checkpoint_in << " at " << _time << " cycles" << endl;
+    _checkpoint_in.clear();
+    _checkpoint_out.clear();
+  }
+
   while ((total_phases < _max_samples) &&
          ((_sim_state != running) ||
           (converged < 3)))
   {
+    // once warmed up, batch means take over from the sample periods
+    if (_batch_means && (_sim_state == running))
+    {
+      break;
+    }
 
     if (clear_last || (((_sim_state == warming_up) && ((total_phases % 2) == 0))))
     {
@@ -178,12 +452,11 @@ bool SteadyStateTrafficManager::_SingleSim()
       double latency = (double)_plat_stats[c]->Sum();
       double count = (double)_plat_stats[c]->NumSamples();
 
-      map<long long int, Flit *>::const_iterator iter;
-      for (iter = _total_in_flight_flits[c].begin();
+      for (FlitRegistry::const_iterator iter = _total_in_flight_flits[c].begin();
            iter != _total_in_flight_flits[c].end();
-           iter++)
+           ++iter)
       {
-        latency += (double)(_time - iter->second->ctime);
+        latency += (double)(_time - (*iter)->ctime);
         count++;
       }
 
@@ -249,6 +522,20 @@ bool SteadyStateTrafficManager::_SingleSim()
 
         clear_last = true;
         _sim_state = running;
+
+        if (!_checkpoint_out.empty())
+        {
+          // a restored simulation resumes with the next phase
+          long long int next_phase = total_phases + 1;
+          Checkpoint cp(_checkpoint_out, Checkpoint::save);
+          _Serialize(cp);
+          cp.Io(prev_latency);
+          cp.Io(prev_accepted);
+          cp.Io(clear_last);
+          cp.Io(next_phase);
+          cout << "Saved checkpoint " << _checkpoint_out << endl;
+          _checkpoint_out.clear();
+        }
       }
     }
     else if (_sim_state == running)
@@ -266,6 +553,11 @@ bool SteadyStateTrafficManager::_SingleSim()
     ++total_phases;
   }
 
+  if (_batch_means && (_sim_state == running) && !_RunBatches(clear_last))
+  {
+    converged = 0;
+  }
+
   if (_sim_state == running)
   {
     ++converged;
@@ -301,12 +593,11 @@ bool SteadyStateTrafficManager::_SingleSim()
             double acc_latency = _plat_stats[c]->Sum();
             double acc_count = (double)_plat_stats[c]->NumSamples();
 
-            map<long long int, Flit *>::const_iterator iter;
-            for (iter = _total_in_flight_flits[c].begin();
+            for (FlitRegistry::const_iterator iter = _total_in_flight_flits[c].begin();
                  iter != _total_in_flight_flits[c].end();
-                 iter++)
+                 ++iter)
             {
-              acc_latency += (double)(_time - iter->second->ctime);
+              acc_latency += (double)(_time - (*iter)->ctime);
               acc_count++;
             }
 
@@ -338,6 +629,271 @@ bool SteadyStateTrafficManager::_SingleSim()
   return (converged > 0);
 }
 
+// Batch means: the measurement is cut into batches of equal length, and the
+// means of the batches serve as independent samples of the mean latency and
+// throughput. At most 2 * min_batches batches are kept; once that many are
+// complete, neighbours are merged, so batches double in length as the run
+// goes on and their correlation fades. The measurement ends once the
+// confidence intervals of every measured class are narrow enough, or after
+// max_batches batch periods with whatever precision was reached; either way
+// true is returned and the simulation is left running to be drained. A run
+// that turns out unstable returns false and is left draining.
+bool SteadyStateTrafficManager::_RunBatches(bool clear_stats)
+{
+  if (clear_stats)
+  {
+    _ClearStats();
+  }
+
+  double const p = 1.0 - (1.0 - _batch_confidence) / 2.0;
+
+  long long int batch_length = _batch_period;
+  long long int partial_length = 0;
+
+  // per class sums of the complete batches and of the one being filled
+  vector<vector<double>> latency_sum(_classes);
+  vector<vector<double>> latency_count(_classes);
+  vector<vector<double>> accepted(_classes);
+  vector<double> partial_sum(_classes, 0.0);
+  vector<double> partial_count(_classes, 0.0);
+  vector<double> partial_accepted(_classes, 0.0);
+  vector<double> last_sum(_classes, 0.0);
+  vector<double> last_count(_classes, 0.0);
+  vector<double> last_accepted(_classes, 0.0);
+
+  // average lag of the sources behind the injection process at the end of
+  // every batch_period, for spotting saturation
+  vector<vector<double>> backlog(_classes);
+
+  // the confidence intervals of the last complete batch
+  ostringstream intervals;
+
+  for (long long int period = 0; period < _max_batches; ++period)
+  {
+    for (long long int iter = 0; iter < _batch_period; ++iter)
+    {
+      if ((_time % 1000000) == 0)
+      {
+        cout << "\nTick: " << _time / (long long int)1000000 << "M" << endl;
+      }
+      _Step();
+    }
+    partial_length += _batch_period;
+
+    UpdateStats();
+
+    for (long long int c = 0; c < _classes; ++c)
+    {
+      if (_measure_stats[c] == 0)
+      {
+        continue;
+      }
+
+      double const sum = _plat_stats[c]->Sum();
+      double const count = (double)_plat_stats[c]->NumSamples();
+      long long int accepted_count;
+      _ComputeStats(_accepted_flits[c], &accepted_count);
+      partial_sum[c] += sum - last_sum[c];
+      partial_count[c] += count - last_count[c];
+      partial_accepted[c] += (double)accepted_count - last_accepted[c];
+      last_sum[c] = sum;
+      last_count[c] = count;
+      last_accepted[c] = (double)accepted_count;
+
+      double latency = sum;
+      double latency_samples = count;
+      for (FlitRegistry::const_iterator iter = _total_in_flight_flits[c].begin();
+           iter != _total_in_flight_flits[c].end();
+           ++iter)
+      {
+        latency += (double)(_time - (*iter)->ctime);
+        latency_samples++;
+      }
+      if (_measure_latency &&
+          (_latency_thres[c] >= 0.0) &&
+          ((latency / latency_samples) > _latency_thres[c]))
+      {
+        cout << "Average latency for class " << c << " exceeded " << _latency_thres[c] << " cycles. Aborting simulation." << endl;
+        _sim_state = draining;
+        _drain_time = _time;
+        return false;
+      }
+
+      // saturated once the sources fall behind significantly over the whole
+      // measurement, by more than a batch period and twice the initial lag
+      double lag = 0.0;
+      for (long long int source = 0; source < _nodes; ++source)
+      {
+        // an idle source has caught up with its injection process
+        if (!_partial_packets[c][source].empty())
+        {
+          lag += (double)max(_time - _qtime[c][source], 0LL);
+        }
+      }
+      vector<double> &b = backlog[c];
+      b.push_back(lag / (double)_nodes);
+      long long int const n = b.size();
+      if (n >= max(_min_batches, 3LL))
+      {
+        double const x_mean = (double)(n - 1) / 2.0;
+        double y_mean = 0.0;
+        for (long long int i = 0; i < n; ++i)
+        {
+          y_mean += b[i];
+        }
+        y_mean /= (double)n;
+        double sxx = 0.0, sxy = 0.0, syy = 0.0;
+        for (long long int i = 0; i < n; ++i)
+        {
+          sxx += ((double)i - x_mean) * ((double)i - x_mean);
+          sxy += ((double)i - x_mean) * (b[i] - y_mean);
+          syy += (b[i] - y_mean) * (b[i] - y_mean);
+        }
+        double const slope = sxy / sxx;
+        double const residual = max(0.0, (syy - slope * sxy) / (double)(n - 2));
+        double const error = sqrt(residual / sxx);
+        bool const growing = (error > 0.0) ? (slope / error > StudentQuantile(p, n - 2)) : (slope > 0.0);
+        if (growing && (b.back() > 2.0 * b.front() + (double)_batch_period))
+        {
+          cout << "Sources of class " << c << " fall behind by " << slope / (double)_batch_period
+               << " cycles per cycle. Aborting simulation." << endl;
+          _sim_state = draining;
+          _drain_time = _time;
+          return false;
+        }
+      }
+    }
+
+    if (partial_length < batch_length)
+    {
+      continue;
+    }
+
+    bool merge = false;
+    for (long long int c = 0; c < _classes; ++c)
+    {
+      if (_measure_stats[c] == 0)
+      {
+        continue;
+      }
+      latency_sum[c].push_back(partial_sum[c]);
+      latency_count[c].push_back(partial_count[c]);
+      accepted[c].push_back(partial_accepted[c]);
+      partial_sum[c] = 0.0;
+      partial_count[c] = 0.0;
+      partial_accepted[c] = 0.0;
+      merge = ((long long int)latency_sum[c].size() >= 2 * _min_batches);
+    }
+    partial_length = 0;
+
+    if (merge)
+    {
+      for (long long int c = 0; c < _classes; ++c)
+      {
+        for (size_t i = 0; i < latency_sum[c].size() / 2; ++i)
+        {
+          latency_sum[c][i] = latency_sum[c][2 * i] + latency_sum[c][2 * i + 1];
+          latency_count[c][i] = latency_count[c][2 * i] + latency_count[c][2 * i + 1];
+          accepted[c][i] = accepted[c][2 * i] + accepted[c][2 * i + 1];
+        }
+        latency_sum[c].resize(latency_sum[c].size() / 2);
+        latency_count[c].resize(latency_count[c].size() / 2);
+        accepted[c].resize(accepted[c].size() / 2);
+      }
+      batch_length *= 2;
+    }
+
+    bool precise = true;
+    intervals.str("");
+    for (long long int c = 0; c < _classes; ++c)
+    {
+      if (_measure_stats[c] == 0)
+      {
+        continue;
+      }
+      long long int const batches = latency_sum[c].size();
+      if (batches < _min_batches)
+      {
+        precise = false;
+      }
+      if (batches < 2)
+      {
+        intervals << "class " << c << " has no confidence interval from " << batches
+                  << ((batches == 1) ? " batch" : " batches") << endl;
+        continue;
+      }
+      double const t = StudentQuantile(p, batches - 1);
+
+      // ratio estimator, since batches hold different numbers of packets
+      double total_sum = 0.0, total_count = 0.0;
+      for (long long int i = 0; i < batches; ++i)
+      {
+        total_sum += latency_sum[c][i];
+        total_count += latency_count[c][i];
+      }
+      double latency = total_sum / total_count;
+      double residuals = 0.0;
+      for (long long int i = 0; i < batches; ++i)
+      {
+        double const r = latency_sum[c][i] - latency * latency_count[c][i];
+        residuals += r * r;
+      }
+      double const mean_count = total_count / (double)batches;
+      double const latency_error = t * sqrt(residuals / (double)(batches * (batches - 1))) / mean_count;
+
+      double const scale = 1.0 / ((double)batch_length * (double)_nodes);
+      double rate = 0.0;
+      for (long long int i = 0; i < batches; ++i)
+      {
+        rate += accepted[c][i] * scale;
+      }
+      rate /= (double)batches;
+      double deviations = 0.0;
+      for (long long int i = 0; i < batches; ++i)
+      {
+        double const d = accepted[c][i] * scale - rate;
+        deviations += d * d;
+      }
+      double const rate_error = t * sqrt(deviations / (double)(batches * (batches - 1)));
+
+      intervals << "class " << c << " latency = " << latency << " +/- " << latency_error
+                << ", accepted flit rate = " << rate << " +/- " << rate_error
+                << " (" << batches << " batches of " << batch_length << " cycles)" << endl;
+
+      if (_measure_latency &&
+          (_batch_precision[c] >= 0.0) &&
+          !(latency_error <= _batch_precision[c] * latency))
+      {
+        precise = false;
+      }
+      if ((_acc_batch_precision[c] >= 0.0) &&
+          !(rate_error <= _acc_batch_precision[c] * rate))
+      {
+        precise = false;
+      }
+    }
+
+    cout << intervals.str();
+
+    if (precise)
+    {
+      cout << "Confidence intervals within the requested precision after " << _time - _reset_time << " cycles" << endl;
+      DisplayStats();
+      return true;
+    }
+  }
+
+  // not an unstable run, so the results stand with the precision reached
+  cout << "Precision not reached: confidence intervals after " << _max_batches << " batch periods are" << endl;
+  if (intervals.str().empty())
+  {
+    cout << "none, no batch completed" << endl;
+  }
+  cout << intervals.str();
+  DisplayStats();
+  return true;
+}
+
 string SteadyStateTrafficManager::_OverallStatsHeaderCSV() const
 {
   ostringstream os;
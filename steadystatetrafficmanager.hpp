@@ -4,6 +4,7 @@
 #define _STEADYSTATETRAFFICMANAGER_HPP_
 
 #include <vector>
+#include <queue>
 
 #include "synthetictrafficmanager.hpp"
 #include "injection.hpp"
@@ -17,6 +18,14 @@ protected:
   vector<string> _injection;
   vector<InjectionProcess *> _injection_process;
 
+  // injection process draws, per class and source
+  vector<RandomStream> _injection_random;
+
+  inline RandomStream *_InjectionStream(long long int c, long long int n)
+  {
+    return _random_streams ? &_injection_random[c * _nodes + n] : NULL;
+  }
+
   bool _measure_latency;
 
   long long int _sample_period;
@@ -31,10 +40,38 @@ protected:
   vector<double> _warmup_threshold;
   vector<double> _acc_warmup_threshold;
 
+  bool _batch_means;
+  long long int _batch_period;
+  long long int _min_batches;
+  long long int _max_batches;
+  double _batch_confidence;
+  vector<double> _batch_precision;
+  vector<double> _acc_batch_precision;
+
+  bool _RunBatches(bool clear_stats);
+
+  // skip-ahead injection: every source draws the time of its next packet up
+  // front and waits in a schedule, so a cycle only visits the due sources
+  bool _skip_ahead;
+  vector<vector<long long int>> _next_inject;
+  priority_queue<pair<long long int, long long int>,
+                 vector<pair<long long int, long long int>>,
+                 greater<pair<long long int, long long int>>>
+      _inject_schedule;
+  vector<long long int> _due;
+
+  void _ScheduleInjections();
+  void _ScheduleNext(long long int source, long long int cl);
+
+  long long int _CreatePacket(long long int source, long long int cl);
   virtual long long int _IssuePacket(long long int source, long long int cl);
 
+  virtual void _Inject();
+
   virtual void _ResetSim();
 
+  virtual void _Serialize(Checkpoint &cp);
+
   virtual bool _SingleSim();
 
   virtual string _OverallStatsHeaderCSV() const;
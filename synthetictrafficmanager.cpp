@@ -4,6 +4,7 @@
 
 #include "synthetictrafficmanager.hpp"
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 SyntheticTrafficManager::SyntheticTrafficManager(const Configuration &config, const vector<Network *> &net)
     : TrafficManager(config, net)
@@ -96,6 +97,15 @@ SyntheticTrafficManager::SyntheticTrafficManager(const Configuration &config, co
     _qtime[c].resize(_nodes);
     _qdrained[c].resize(_nodes);
   }
+
+  if (_random_streams)
+  {
+    _traffic_random.resize(_classes * _nodes);
+    for (long long int i = 0; i < _classes * _nodes; ++i)
+    {
+      _traffic_random[i].Seed(_seed, RANDOM_TRAFFIC, i);
+    }
+  }
 }
 
 SyntheticTrafficManager::~SyntheticTrafficManager()
@@ -134,6 +144,7 @@ void SyntheticTrafficManager::_RetirePacket(Flit *head, Flit *tail)
   else
   {
     _packet_seq_no[head->cl][head->dest]++;
+    RandomStreamScope random_scope(_TrafficStream(reply_class, head->dest));
     long long int size = _GetNextPacketSize(reply_class);
     _GeneratePacket(head->dest, head->src, size, reply_class, tail->atime + 1);
   }
@@ -212,6 +223,14 @@ void SyntheticTrafficManager::_ResetSim()
   }
 }
 
+void SyntheticTrafficManager::_Serialize(Checkpoint &cp)
+{
+  TrafficManager::_Serialize(cp);
+  cp.Io(_qtime);
+  cp.Io(_qdrained);
+  cp.Io(_traffic_random);
+}
+
 string SyntheticTrafficManager::_OverallStatsHeaderCSV() const
 {
   ostringstream os;
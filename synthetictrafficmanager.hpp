@@ -27,6 +27,14 @@ protected:
   vector<vector<long long int>> _qtime;
   vector<vector<bool>> _qdrained;
 
+  // destinations and packet sizes, per class and source
+  vector<RandomStream> _traffic_random;
+
+  inline RandomStream *_TrafficStream(long long int c, long long int n)
+  {
+    return _random_streams ? &_traffic_random[c * _nodes + n] : NULL;
+  }
+
   vector<Stats *> _tlat_stats;
   vector<double> _overall_min_tlat;
   vector<double> _overall_avg_tlat;
@@ -44,6 +52,8 @@ protected:
 
   virtual void _ResetSim();
 
+  virtual void _Serialize(Checkpoint &cp);
+
   virtual string _OverallStatsHeaderCSV() const;
   virtual string _OverallClassStatsCSV(long long int c) const;
 
@@ -4,6 +4,7 @@
 #define _TIMED_MODULE_HPP_
 
 #include "module.hpp"
+#include "globals.hpp"
 
 class TimedModule : public Module
 {
@@ -15,6 +16,14 @@ public:
   virtual void ReadInputs() = 0;
   virtual void Evaluate() = 0;
   virtual void WriteOutputs() = 0;
+
+  // earliest cycle after the current one on which the module needs to be
+  // stepped; queried after WriteOutputs, defaults to the next cycle
+  virtual long long int NextEventTime() const { return GetSimTime() + 1; }
+  // account for cycles on which the module was not stepped
+  virtual void Idle(long long int cycles) {}
+  // whether the module presents data to be read on the next cycle
+  virtual bool HasOutput() const { return false; }
 };
 
 #endif
@@ -3,16 +3,20 @@
 #include <sstream>
 #include <fstream>
 #include <limits>
+#include <numeric>
 #include <ctime>
 
 #include "booksim.hpp"
 #include "booksim_config.hpp"
 #include "trafficmanager.hpp"
 #include "steadystatetrafficmanager.hpp"
+#include "saturationtrafficmanager.hpp"
 #include "batchtrafficmanager.hpp"
 #include "workloadtrafficmanager.hpp"
 #include "random_utils.hpp"
+#include "checkpoint.hpp"
 #include "vc.hpp"
+#include "routetable.hpp"
 
 TrafficManager *TrafficManager::New(Configuration const &config, vector<Network *> const &net)
 {
@@ -22,6 +26,10 @@ TrafficManager *TrafficManager::New(Configuration const &config, vector<Network
   {
     result = new SteadyStateTrafficManager(config, net);
   }
+  else if (sim_type == "saturation")
+  {
+    result = new SaturationTrafficManager(config, net);
+  }
   else if (sim_type == "batch")
   {
     result = new BatchTrafficManager(config, net);
@@ -34,6 +42,12 @@ TrafficManager *TrafficManager::New(Configuration const &config, vector<Network
   {
     cerr << "Unknown simulation type: " << sim_type << endl;
   }
+  if (result && !dynamic_cast<SteadyStateTrafficManager *>(result) &&
+      ((config.GetStr("checkpoint_out") != "") || (config.GetStr("checkpoint_in") != "")))
+  {
+    cerr << "Checkpoints are only supported by latency and throughput simulations." << endl;
+    exit(-1);
+  }
   return result;
 }
 
@@ -180,6 +194,7 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
   _total_in_flight_flits.resize(_classes);
   _measured_in_flight_flits.resize(_classes);
   _retired_packets.resize(_classes);
+  _arrived_flits.resize(_subnets, vector<Flit *>(_nodes, NULL));
 
   _hold_switch_for_packet = config.GetLongInt("hold_switch_for_packet");
 
@@ -193,18 +208,52 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
     _router[i] = _net[i]->GetRouters();
   }
 
+  _routing_table = NULL;
+  if (config.GetLongInt("routing_table"))
+  {
+    if (!gTableRoutingFunctions.count(_rf))
+    {
+      Error("routing_table requires a deterministic routing function, not " + config.GetStr("routing_function"));
+    }
+    // all subnets share one topology
+    _routing_table = new RoutingTable(_rf, _router[0], _nodes, _classes);
+    for (long long int i = 0; i < _subnets; ++i)
+    {
+      for (size_t r = 0; r < _router[i].size(); ++r)
+      {
+        _router[i][r]->SetRoutingTable(_routing_table);
+      }
+    }
+  }
+
   //seed the network
-  long long int seed;
   if (config.GetStr("seed") == "time")
   {
-    seed = time(NULL);
-    cout << "SEED: seed=" << seed << endl;
+    _seed = time(NULL);
+    cout << "SEED: seed=" << _seed << endl;
   }
   else
   {
-    seed = config.GetLongInt("seed");
+    _seed = config.GetLongInt("seed");
+  }
+  RandomSeed(_seed);
+
+  _random_streams = (config.GetLongInt("random_streams") > 0);
+  if (_random_streams)
+  {
+    _source_random.resize(_nodes);
+    for (long long int n = 0; n < _nodes; ++n)
+    {
+      _source_random[n].Seed(_seed, RANDOM_SOURCE, n);
+    }
+    for (long long int i = 0; i < _subnets; ++i)
+    {
+      for (size_t r = 0; r < _router[i].size(); ++r)
+      {
+        _router[i][r]->SeedRandomStream(_seed, i * _routers + r);
+      }
+    }
   }
-  RandomSeed(seed);
 
   _measure_stats = config.GetIntArray("measure_stats");
   if (_measure_stats.empty())
@@ -213,12 +262,16 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
   }
   _measure_stats.resize(_classes, _measure_stats.back());
   _pair_stats = (config.GetLongInt("pair_stats") == 1);
+  _print_percentiles = (config.GetLongInt("print_percentiles") == 1);
 
   _include_queuing = config.GetLongInt("include_queuing");
 
   _print_csv_results = config.GetLongInt("print_csv_results");
   _deadlock_warn_timeout = config.GetLongInt("deadlock_warn_timeout");
 
+  _checkpoint_out = config.GetStr("checkpoint_out");
+  _checkpoint_in = config.GetStr("checkpoint_in");
+
   string watch_file = config.GetStr("watch_file");
   if ((watch_file != "") && (watch_file != "-"))
   {
@@ -226,12 +279,20 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
   }
 
   // Orion Power Support
+  _orion_power = (config.GetLongInt("orion_power") > 0);
   string orion_file = config.GetStr("orion_file");
   if ((orion_file != "") && (orion_file != "-"))
   {
     _orion_file = orion_file;
   }
 
+  _activity_trace = NULL;
+  string activity_trace = config.GetStr("activity_trace");
+  if ((activity_trace != "") && (activity_trace != "-"))
+  {
+    _activity_trace = new ActivityTrace(activity_trace, config.GetLongInt("activity_interval"), _net, config);
+  }
+
   vector<long long int> watch_flits = config.GetIntArray("watch_flits");
   for (size_t i = 0; i < watch_flits.size(); ++i)
   {
@@ -259,6 +320,21 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
     config.WriteMatlabFile(_stats_out);
   }
 
+  string hist_dump_file = config.GetStr("hist_dump");
+  if (hist_dump_file == "")
+  {
+    _hist_dump = NULL;
+  }
+  else
+  {
+    _hist_dump = new ofstream(hist_dump_file.c_str(), ios::binary);
+    if (!*_hist_dump)
+    {
+      Error("Unable to open histogram dump file: " + hist_dump_file);
+    }
+    HdrStats::DumpHeader(*_hist_dump);
+  }
+
   // Orion Power Support
   string orion_out_file = config.GetStr("orion_out");
   if (orion_out_file == "")
@@ -297,11 +373,26 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
   _overall_avg_frag.resize(_classes, 0.0);
   _overall_max_frag.resize(_classes, 0.0);
 
+  long long int const hist_precision = config.GetLongInt("hist_precision");
+  _plat_pct = new HdrStats(_classes, hist_precision);
+  _nlat_pct = new HdrStats(_classes, hist_precision);
+  _flat_pct = new HdrStats(_classes, hist_precision);
+  _overall_plat_pct = new HdrStats(_classes, hist_precision);
+  _overall_nlat_pct = new HdrStats(_classes, hist_precision);
+  _overall_flat_pct = new HdrStats(_classes, hist_precision);
+
   if (_pair_stats)
   {
-    _pair_plat.resize(_classes);
-    _pair_nlat.resize(_classes);
-    _pair_flat.resize(_classes);
+    long long int const pair_precision = config.GetLongInt("pair_hist_precision");
+    _pair_plat = new HdrStats(_classes * _nodes * _nodes, pair_precision);
+    _pair_nlat = new HdrStats(_classes * _nodes * _nodes, pair_precision);
+    _pair_flat = new HdrStats(_classes * _nodes * _nodes, pair_precision);
+  }
+  else
+  {
+    _pair_plat = NULL;
+    _pair_nlat = NULL;
+    _pair_flat = NULL;
   }
 
   _hop_stats.resize(_classes);
@@ -360,41 +451,10 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
     _stats[tmp_name.str()] = _hop_stats[c];
     tmp_name.str("");
 
-    if (_pair_stats)
-    {
-      _pair_plat[c].resize(_nodes * _nodes);
-      _pair_nlat[c].resize(_nodes * _nodes);
-      _pair_flat[c].resize(_nodes * _nodes);
-    }
-
     _sent_packets[c].resize(_nodes, 0);
     _accepted_packets[c].resize(_nodes, 0);
     _sent_flits[c].resize(_nodes, 0);
     _accepted_flits[c].resize(_nodes, 0);
-
-    if (_pair_stats)
-    {
-      for (long long int i = 0; i < _nodes; ++i)
-      {
-        for (long long int j = 0; j < _nodes; ++j)
-        {
-          tmp_name << "pair_plat_stat_" << c << "_" << i << "_" << j;
-          _pair_plat[c][i * _nodes + j] = new Stats(this, tmp_name.str(), 1.0, 250);
-          _stats[tmp_name.str()] = _pair_plat[c][i * _nodes + j];
-          tmp_name.str("");
-
-          tmp_name << "pair_nlat_stat_" << c << "_" << i << "_" << j;
-          _pair_nlat[c][i * _nodes + j] = new Stats(this, tmp_name.str(), 1.0, 250);
-          _stats[tmp_name.str()] = _pair_nlat[c][i * _nodes + j];
-          tmp_name.str("");
-
-          tmp_name << "pair_flat_stat_" << c << "_" << i << "_" << j;
-          _pair_flat[c][i * _nodes + j] = new Stats(this, tmp_name.str(), 1.0, 250);
-          _stats[tmp_name.str()] = _pair_flat[c][i * _nodes + j];
-          tmp_name.str("");
-        }
-      }
-    }
   }
 
   _slowest_flit.resize(_classes, -1);
@@ -404,6 +464,8 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
 TrafficManager::~TrafficManager()
 {
 
+  delete _routing_table;
+
   for (long long int source = 0; source < _nodes; ++source)
   {
     for (long long int subnet = 0; subnet < _subnets; ++subnet)
@@ -419,25 +481,24 @@ TrafficManager::~TrafficManager()
     delete _flat_stats[c];
     delete _frag_stats[c];
     delete _hop_stats[c];
-
-    if (_pair_stats)
-    {
-      for (long long int i = 0; i < _nodes; ++i)
-      {
-        for (long long int j = 0; j < _nodes; ++j)
-        {
-          delete _pair_plat[c][i * _nodes + j];
-          delete _pair_nlat[c][i * _nodes + j];
-          delete _pair_flat[c][i * _nodes + j];
-        }
-      }
-    }
   }
 
+  delete _plat_pct;
+  delete _nlat_pct;
+  delete _flat_pct;
+  delete _overall_plat_pct;
+  delete _overall_nlat_pct;
+  delete _overall_flat_pct;
+  delete _pair_plat;
+  delete _pair_nlat;
+  delete _pair_flat;
+
   if (gWatchOut && (gWatchOut != &cout))
     delete gWatchOut;
   if (_stats_out && (_stats_out != &cout))
     delete _stats_out;
+  delete _hist_dump;
+  delete _activity_trace;
   // Orion Power Support
   if (_orion_out && (_orion_out != &cout))
     delete _orion_out;
@@ -451,13 +512,13 @@ void TrafficManager::_RetireFlit(Flit *f, long long int dest)
   _deadlock_timer = 0;
   //  printf("\nTime:,%lld,%lld,[%lld][%lld],RetFlit,%lld\n", GetSimTime(), f->dest, f->id, f->pid, f->vc); //Sneha
   //  printf("\nTime:,%lld,%lld,[%lld][%lld],RetFlit,%lld, Time taken = %llds\n", GetSimTime(), f->dest, f->id, f->pid, f->vc,((long long int)GetSimTime() - (long long int)f->starttime)); //*Sneha
-  _total_in_flight_flits[f->cl].erase(f->id);
+  _total_in_flight_flits[f->cl].Erase(f->id);
 
   _overall_flits_received[f->cl]++; //Sneha
 
   if (f->record)
   {
-    _measured_in_flight_flits[f->cl].erase(f->id);
+    _measured_in_flight_flits[f->cl].Erase(f->id);
   }
 
   if (f->head && (f->dest != dest))
@@ -471,9 +532,10 @@ void TrafficManager::_RetireFlit(Flit *f, long long int dest)
       (_flat_stats[f->cl]->Max() < (f->atime - f->itime)))
     _slowest_flit[f->cl] = f->id;
   _flat_stats[f->cl]->AddSample(f->atime - f->itime);
+  _flat_pct->AddSample(f->cl, f->atime - f->itime);
   if (_pair_stats)
   {
-    _pair_flat[f->cl][f->src * _nodes + dest]->AddSample(f->atime - f->itime);
+    _pair_flat->AddSample(_PairSeries(f->cl, f->src, dest), f->atime - f->itime);
   }
 
   if (f->tail)
@@ -485,9 +547,8 @@ void TrafficManager::_RetireFlit(Flit *f, long long int dest)
     }
     else
     {
-      map<long long int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
-      head = iter->second;
-      _retired_packets[f->cl].erase(iter);
+      head = _retired_packets[f->cl].Find(f->pid);
+      _retired_packets[f->cl].Erase(f->pid);
     }
     _overall_packets_received[f->cl]++; //Sneha
 
@@ -503,10 +564,13 @@ void TrafficManager::_RetireFlit(Flit *f, long long int dest)
       _plat_stats[f->cl]->AddSample(f->atime - head->ctime);
       _nlat_stats[f->cl]->AddSample(f->atime - head->itime);
       _frag_stats[f->cl]->AddSample((f->atime - head->atime) - (f->id - head->id));
+      _plat_pct->AddSample(f->cl, f->atime - head->ctime);
+      _nlat_pct->AddSample(f->cl, f->atime - head->itime);
       if (_pair_stats)
       {
-        _pair_plat[f->cl][f->src * _nodes + dest]->AddSample(f->atime - head->ctime);
-        _pair_nlat[f->cl][f->src * _nodes + dest]->AddSample(f->atime - head->itime);
+        long long int const pair = _PairSeries(f->cl, f->src, dest);
+        _pair_plat->AddSample(pair, f->atime - head->ctime);
+        _pair_nlat->AddSample(pair, f->atime - head->itime);
       }
     }
 
@@ -518,7 +582,7 @@ void TrafficManager::_RetireFlit(Flit *f, long long int dest)
 
   if (f->head && !f->tail)
   {
-    _retired_packets[f->cl].insert(make_pair(f->pid, f));
+    _retired_packets[f->cl].Insert(f->pid, f);
   }
   else
   {
@@ -568,7 +632,6 @@ long long int TrafficManager::_GeneratePacket(long long int source, long long in
     f->tail = (i == (size - 1));
     f->vc = -1;
     Generated_flits++;                            //Sneha
-    f->starttime = (long long int)(GetSimTime()); //Sarab
                                                   //    printf("\nTime:,%lld,%lld,[%lld][%lld],GenFlit,%lld\n", GetSimTime(), f->src, f->id, f->pid, f->vc); //Sneha
 
     switch (_pri_type)
@@ -587,10 +650,10 @@ long long int TrafficManager::_GeneratePacket(long long int source, long long in
       f->pri = 0;
     }
 
-    _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+    _total_in_flight_flits[f->cl].Insert(f->id, f);
     if (record)
     {
-      _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+      _measured_in_flight_flits[f->cl].Insert(f->id, f);
     }
 
     if (gTrace)
@@ -616,7 +679,6 @@ void TrafficManager::_Step()
     cout << "WARNING: Possible network deadlock." << endl;
   }
 
-  vector<map<long long int, Flit *>> flits(_subnets);
   for (long long int subnet = 0; subnet < _subnets; ++subnet)
   {
     for (long long int n = 0; n < _nodes; ++n)
@@ -624,7 +686,7 @@ void TrafficManager::_Step()
       Flit *const f = _net[subnet]->ReadFlit(n);
       if (f)
       {
-        flits[subnet].insert(make_pair(n, f));
+        _arrived_flits[subnet][n] = f;
         if ((_sim_state == warming_up) || (_sim_state == running))
         {
           ++_accepted_flits[f->cl][n];
@@ -655,6 +717,7 @@ void TrafficManager::_Step()
 
     for (long long int n = 0; n < _nodes; ++n)
     {
+      RandomStreamScope random_scope(_SourceStream(n));
       Flit *f = NULL;
       BufferState *const dest_buf = _buf_states[n][subnet];
       long long int const last_class = _last_class[n][subnet];
@@ -692,12 +755,22 @@ void TrafficManager::_Step()
 
         if (cf->head && cf->vc == -1)
         { // Find first available VC
-          OutputSet route_set;
-          _rf(NULL, cf, -1, &route_set, true);
-          set<OutputSet::sSetElement> const &os = route_set.GetSet();
-          OutputSet::sSetElement const &se = *os.begin();
-          long long int vcBegin = se.vc_start;
-          long long int vcEnd = se.vc_end;
+          long long int vcBegin;
+          long long int vcEnd;
+          if (_routing_table)
+          {
+            RoutingTable::sEntry const &e = _routing_table->LookupInject(cf->dest, cf->cl);
+            vcBegin = e.vc_start;
+            vcEnd = e.vc_end;
+          }
+          else
+          {
+            OutputSet route_set;
+            _rf(NULL, cf, -1, &route_set, true);
+            OutputSet::sSetElement const &se = *route_set.GetSet().begin();
+            vcBegin = se.vc_start;
+            vcEnd = se.vc_end;
+          }
           long long int vc_count = vcEnd - vcBegin + 1;
           if (_noq)
           {
@@ -705,11 +778,10 @@ void TrafficManager::_Step()
             const Router *router = inject->GetSink();
             long long int in_channel = inject->GetSinkPort();
             cf->vc = vcBegin;
-            _rf(router, cf, in_channel, &cf->la_route_set, false);
+            router->Route(_rf, cf, in_channel, &cf->LaRouteSet());
             cf->vc = -1;
 
-            set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
-            long long int next_output = sl.begin()->output_port;
+            long long int next_output = cf->LaRouteSet().GetSet().begin()->output_port;
             vc_count /= router->NumOutputs();
             vcBegin += next_output * vc_count;
             vcEnd = vcBegin + vc_count - 1;
@@ -763,7 +835,7 @@ void TrafficManager::_Step()
               const FlitChannel *inject = _net[subnet]->GetInject(n);
               const Router *router = inject->GetSink();
               long long int in_channel = inject->GetSinkPort();
-              _rf(router, f, in_channel, &f->la_route_set, false);
+              router->Route(_rf, f, in_channel, &f->LaRouteSet());
             }
             else if (f->watch)
             {
@@ -775,7 +847,7 @@ void TrafficManager::_Step()
           }
           else
           {
-            f->la_route_set.Clear();
+            f->ClearLaRouteSet();
           }
 
           dest_buf->TakeBuffer(f->vc);
@@ -813,10 +885,10 @@ void TrafficManager::_Step()
   {
     for (long long int n = 0; n < _nodes; ++n)
     {
-      map<long long int, Flit *>::const_iterator iter = flits[subnet].find(n);
-      if (iter != flits[subnet].end())
+      Flit *const f = _arrived_flits[subnet][n];
+      if (f)
       {
-        Flit *const f = iter->second;
+        _arrived_flits[subnet][n] = NULL;
 
         f->atime = _time;
         Credit *const c = Credit::New();
@@ -830,13 +902,16 @@ void TrafficManager::_Step()
         _RetireFlit(f, n);
       }
     }
-    flits[subnet].clear();
     _net[subnet]->Evaluate();
     _net[subnet]->WriteOutputs();
   }
 
   ++_time;
   assert(_time);
+  if (_activity_trace)
+  {
+    _activity_trace->Tick();
+  }
   if (gTrace)
   {
     cout << "TIME " << _time << endl;
@@ -892,24 +967,133 @@ void TrafficManager::_ClearStats()
     _buffer_reserved_stalls[c].assign(_subnets * _routers, 0);
     _crossbar_conflict_stalls[c].assign(_subnets * _routers, 0);
 #endif
-    if (_pair_stats)
-    {
-      for (long long int i = 0; i < _nodes; ++i)
-      {
-        for (long long int j = 0; j < _nodes; ++j)
-        {
-          _pair_plat[c][i * _nodes + j]->Clear();
-          _pair_nlat[c][i * _nodes + j]->Clear();
-          _pair_flat[c][i * _nodes + j]->Clear();
-        }
-      }
-    }
     _hop_stats[c]->Clear();
   }
 
+  _plat_pct->Clear();
+  _nlat_pct->Clear();
+  _flat_pct->Clear();
+  if (_pair_stats)
+  {
+    _pair_plat->Clear();
+    _pair_nlat->Clear();
+    _pair_flat->Clear();
+  }
+
   _reset_time = _time;
 }
 
+void TrafficManager::_Serialize(Checkpoint &cp)
+{
+  cp.Check(_nodes, "nodes");
+  cp.Check(_subnets, "subnets");
+  cp.Check(_classes, "classes");
+  cp.Check(_vcs, "vcs");
+  cp.Check(_random_streams, "random_streams");
+
+  cp.Io(_time);
+  cp.Io(_reset_time);
+  cp.Io(_drain_time);
+  cp.Io(_sim_state);
+  cp.Io(_cur_id);
+  cp.Io(_cur_pid);
+  cp.Io(_deadlock_timer);
+
+  for (long long int s = 0; s < _subnets; ++s)
+  {
+    _net[s]->Serialize(cp);
+  }
+  asyncConfig->Serialize(cp);
+
+  for (long long int n = 0; n < _nodes; ++n)
+  {
+    for (long long int s = 0; s < _subnets; ++s)
+    {
+      _buf_states[n][s]->Serialize(cp);
+    }
+  }
+  cp.Io(_last_vc);
+  cp.Io(_last_class);
+  cp.Io(_partial_packets);
+  cp.Io(_total_in_flight_flits);
+  cp.Io(_measured_in_flight_flits);
+  cp.Io(_retired_packets);
+  cp.Io(_packet_seq_no);
+  cp.Io(_requests_outstanding);
+  cp.Io(_source_random);
+#ifdef TRACK_FLOWS
+  cp.Io(_outstanding_credits);
+  cp.Io(_outstanding_classes);
+  cp.Io(_injected_flits);
+  cp.Io(_ejected_flits);
+#endif
+
+  for (map<string, Stats *>::iterator iter = _stats.begin(); iter != _stats.end(); ++iter)
+  {
+    iter->second->Serialize(cp);
+  }
+  _plat_pct->Serialize(cp);
+  _nlat_pct->Serialize(cp);
+  _flat_pct->Serialize(cp);
+  cp.Check(_pair_stats, "pair_stats");
+  if (_pair_stats)
+  {
+    _pair_plat->Serialize(cp);
+    _pair_nlat->Serialize(cp);
+    _pair_flat->Serialize(cp);
+  }
+  cp.Io(_sent_packets);
+  cp.Io(_accepted_packets);
+  cp.Io(_sent_flits);
+  cp.Io(_accepted_flits);
+  cp.Io(_slowest_packet);
+  cp.Io(_slowest_flit);
+  cp.Io(_overall_flits_received);
+  cp.Io(_overall_packets_received);
+#ifdef TRACK_STALLS
+  cp.Io(_buffer_busy_stalls);
+  cp.Io(_buffer_conflict_stalls);
+  cp.Io(_buffer_full_stalls);
+  cp.Io(_buffer_reserved_stalls);
+  cp.Io(_crossbar_conflict_stalls);
+#endif
+  cp.Io(Generated_flits);
+  cp.Io(Changed_flits);
+  cp.IoArray(Packet_Size_Histogram, 20);
+
+  vector<long> ran_state;
+  vector<double> ranf_state;
+  if (cp.Saving())
+  {
+    SaveRandomStream(ran_state, ranf_state);
+  }
+  cp.Io(ran_state);
+  cp.Io(ranf_state);
+  if (cp.Restoring())
+  {
+    RestoreRandomStream(ran_state, ranf_state);
+  }
+
+  // the restored counts are not activity of this run
+  if (cp.Restoring() && _activity_trace)
+  {
+    _activity_trace->Rebase();
+  }
+
+  // last, since recreating the saved flits counts them as injected
+  cp.Io(g_number_of_injected_flits);
+  cp.Io(g_number_of_retired_flits);
+  cp.Io(g_total_cs_register_writes);
+}
+
+void TrafficManager::FlushActivityTrace()
+{
+  if (_activity_trace)
+  {
+    _activity_trace->Sample();
+  }
+}
+
 void TrafficManager::_ComputeStats(const vector<long long int> &stats, long long int *sum, long long int *min, long long int *max, long long int *min_pos, long long int *max_pos) const
 {
   long long int const count = stats.size();
@@ -963,17 +1147,17 @@ void TrafficManager::_DisplayRemaining(ostream &os) const
   for (long long int c = 0; c < _classes; ++c)
   {
 
-    map<long long int, Flit *>::const_iterator iter;
+    FlitRegistry::const_iterator iter = _total_in_flight_flits[c].begin();
     long long int i;
 
     os << "Class " << c << ":" << endl;
 
     os << "Remaining flits: ";
-    for (iter = _total_in_flight_flits[c].begin(), i = 0;
+    for (i = 0;
          (iter != _total_in_flight_flits[c].end()) && (i < 10);
-         iter++, i++)
+         ++iter, i++)
     {
-      os << iter->first << " ";
+      os << iter.Id() << " ";
     }
     if (_total_in_flight_flits[c].size() > 10)
       os << "[...] ";
@@ -983,9 +1167,9 @@ void TrafficManager::_DisplayRemaining(ostream &os) const
     os << "Measured flits: ";
     for (iter = _measured_in_flight_flits[c].begin(), i = 0;
          (iter != _measured_in_flight_flits[c].end()) && (i < 10);
-         iter++, i++)
+         ++iter, i++)
     {
-      os << iter->first << " ";
+      os << iter.Id() << " ";
     }
     if (_measured_in_flight_flits[c].size() > 10)
       os << "[...] ";
@@ -994,55 +1178,61 @@ void TrafficManager::_DisplayRemaining(ostream &os) const
   }
 }
 
-bool TrafficManager::Run()
+// steps without injecting until no flits or credits are left in flight
+void TrafficManager::_DrainNetwork()
 {
-  for (long long int sim = 0; sim < _total_sims; ++sim)
+  _empty_network = true;
+  long long int empty_steps = 0;
+
+  bool packets_left = false;
+  for (long long int c = 0; c < _classes; ++c)
   {
+    packets_left |= !_total_in_flight_flits[c].empty();
+  }
 
-    _ResetSim();
+  while (packets_left)
+  {
+    _Step();
 
-    _ClearStats();
+    ++empty_steps;
 
-    if (!_SingleSim())
+    if (empty_steps % 1000 == 0)
     {
-      cout << "Simulation unstable, ending ..." << endl;
-      return false;
+      _DisplayRemaining();
     }
 
-    // Empty any remaining packets
-    cout << "Draining remaining packets ..." << endl;
-    _empty_network = true;
-    long long int empty_steps = 0;
-
-    bool packets_left = false;
+    packets_left = false;
     for (long long int c = 0; c < _classes; ++c)
     {
       packets_left |= !_total_in_flight_flits[c].empty();
     }
+  }
+  //wait until all the credits are drained as well
+  while (Credit::OutStanding() != 0)
+  {
+    _Step();
+  }
+  _empty_network = false;
+}
 
-    while (packets_left)
-    {
-      _Step();
+bool TrafficManager::Run()
+{
+  for (long long int sim = 0; sim < _total_sims; ++sim)
+  {
 
-      ++empty_steps;
+    _ResetSim();
 
-      if (empty_steps % 1000 == 0)
-      {
-        _DisplayRemaining();
-      }
+    _ClearStats();
 
-      packets_left = false;
-      for (long long int c = 0; c < _classes; ++c)
-      {
-        packets_left |= !_total_in_flight_flits[c].empty();
-      }
-    }
-    //wait until all the credits are drained as well
-    while (Credit::OutStanding() != 0)
+    if (!_SingleSim())
     {
-      _Step();
+      cout << "Simulation unstable, ending ..." << endl;
+      return false;
     }
-    _empty_network = false;
+
+    // Empty any remaining packets
+    cout << "Draining remaining packets ..." << endl;
+    _DrainNetwork();
 
     //for the love of god don't ever say "Time taken" anywhere else the power script depend on it
     cout << "Time taken is " << _time << " cycles" << endl;
@@ -1061,7 +1251,10 @@ bool TrafficManager::Run()
   }
 
   // Orion Power Support
-  _ComputeOrionPower();
+  if (_orion_power)
+  {
+    _ComputeOrionPower();
+  }
   return true;
 }
 
@@ -1091,6 +1284,14 @@ void TrafficManager::DisplayOverallStatsCSV(ostream &os) const
 
 void TrafficManager::_UpdateOverallStats()
 {
+  _overall_plat_pct->Merge(*_plat_pct);
+  _overall_nlat_pct->Merge(*_nlat_pct);
+  _overall_flat_pct->Merge(*_flat_pct);
+
+  if (_hist_dump)
+  {
+    _DumpHistograms();
+  }
 
   for (long long int c = 0; c < _classes; ++c)
   {
@@ -1158,6 +1359,21 @@ void TrafficManager::_UpdateOverallStats()
   }
 }
 
+// appends this simulation's histograms to the dump file
+void TrafficManager::_DumpHistograms()
+{
+  _plat_pct->Dump(*_hist_dump, "plat");
+  _nlat_pct->Dump(*_hist_dump, "nlat");
+  _flat_pct->Dump(*_hist_dump, "flat");
+  if (_pair_stats)
+  {
+    _pair_plat->Dump(*_hist_dump, "pair_plat");
+    _pair_nlat->Dump(*_hist_dump, "pair_nlat");
+    _pair_flat->Dump(*_hist_dump, "pair_flat");
+  }
+  _hist_dump->flush();
+}
+
 void TrafficManager::UpdateStats()
 {
 }
@@ -1182,13 +1398,28 @@ void TrafficManager::_DisplayClassStats(long long int c, ostream &os) const
   os << "Minimum packet latency = " << _plat_stats[c]->Min() << endl;
   os << "Average packet latency = " << _plat_stats[c]->Average() << endl;
   os << "Maximum packet latency = " << _plat_stats[c]->Max() << endl;
+  if (_print_percentiles)
+  {
+    os << "50th/99th/99.9th percentile packet latency = " << _plat_pct->Percentile(c, 0.5)
+       << " / " << _plat_pct->Percentile(c, 0.99) << " / " << _plat_pct->Percentile(c, 0.999) << endl;
+  }
   os << "Minimum network latency = " << _nlat_stats[c]->Min() << endl;
   os << "Average network latency = " << _nlat_stats[c]->Average() << endl;
   os << "Maximum network latency = " << _nlat_stats[c]->Max() << endl;
+  if (_print_percentiles)
+  {
+    os << "50th/99th/99.9th percentile network latency = " << _nlat_pct->Percentile(c, 0.5)
+       << " / " << _nlat_pct->Percentile(c, 0.99) << " / " << _nlat_pct->Percentile(c, 0.999) << endl;
+  }
   os << "Slowest packet = " << _slowest_packet[c] << endl;
   os << "Minimum flit latency = " << _flat_stats[c]->Min() << endl;
   os << "Average flit latency = " << _flat_stats[c]->Average() << endl;
   os << "Maximum flit latency = " << _flat_stats[c]->Max() << endl;
+  if (_print_percentiles)
+  {
+    os << "50th/99th/99.9th percentile flit latency = " << _flat_pct->Percentile(c, 0.5)
+       << " / " << _flat_pct->Percentile(c, 0.99) << " / " << _flat_pct->Percentile(c, 0.999) << endl;
+  }
   os << "Slowest flit = " << _slowest_flit[c] << endl;
   os << "Minimum fragmentation = " << _frag_stats[c]->Min() << endl;
   os << "Average fragmentation = " << _frag_stats[c]->Average() << endl;
@@ -1270,6 +1501,23 @@ void TrafficManager::WriteStats(ostream &os) const
   }
 }
 
+// closes the previous row and writes one value per (source, destination)
+// pair: the average for a negative q, otherwise the q-th percentile
+void TrafficManager::_WritePairStats(string const &name, long long int c, ostream &os,
+                                     HdrStats const *stats, double q) const
+{
+  os << "];" << endl
+     << name << "(" << c + 1 << ",:) = [ ";
+  for (long long int i = 0; i < _nodes; ++i)
+  {
+    for (long long int j = 0; j < _nodes; ++j)
+    {
+      long long int const pair = _PairSeries(c, i, j);
+      os << ((q < 0.0) ? stats->Average(pair) : stats->Percentile(pair, q)) << " ";
+    }
+  }
+}
+
 void TrafficManager::_WriteClassStats(long long int c, ostream &os) const
 {
 
@@ -1288,35 +1536,23 @@ void TrafficManager::_WriteClassStats(long long int c, ostream &os) const
     {
       for (long long int j = 0; j < _nodes; ++j)
       {
-        os << _pair_plat[c][i * _nodes + j]->NumSamples() << " ";
+        os << _pair_plat->NumSamples(_PairSeries(c, i, j)) << " ";
       }
     }
-    os << "];" << endl
-       << "pair_plat(" << c + 1 << ",:) = [ ";
-    for (long long int i = 0; i < _nodes; ++i)
+    _WritePairStats("pair_plat", c, os, _pair_plat, -1.0);
+    _WritePairStats("pair_nlat", c, os, _pair_nlat, -1.0);
+    _WritePairStats("pair_flat", c, os, _pair_flat, -1.0);
+    if (_print_percentiles)
     {
-      for (long long int j = 0; j < _nodes; ++j)
-      {
-        os << _pair_plat[c][i * _nodes + j]->Average() << " ";
-      }
-    }
-    os << "];" << endl
-       << "pair_nlat(" << c + 1 << ",:) = [ ";
-    for (long long int i = 0; i < _nodes; ++i)
-    {
-      for (long long int j = 0; j < _nodes; ++j)
-      {
-        os << _pair_nlat[c][i * _nodes + j]->Average() << " ";
-      }
-    }
-    os << "];" << endl
-       << "pair_flat(" << c + 1 << ",:) = [ ";
-    for (long long int i = 0; i < _nodes; ++i)
-    {
-      for (long long int j = 0; j < _nodes; ++j)
-      {
-        os << _pair_flat[c][i * _nodes + j]->Average() << " ";
-      }
+      _WritePairStats("pair_plat_p50", c, os, _pair_plat, 0.5);
+      _WritePairStats("pair_plat_p99", c, os, _pair_plat, 0.99);
+      _WritePairStats("pair_plat_p999", c, os, _pair_plat, 0.999);
+      _WritePairStats("pair_nlat_p50", c, os, _pair_nlat, 0.5);
+      _WritePairStats("pair_nlat_p99", c, os, _pair_nlat, 0.99);
+      _WritePairStats("pair_nlat_p999", c, os, _pair_nlat, 0.999);
+      _WritePairStats("pair_flat_p50", c, os, _pair_flat, 0.5);
+      _WritePairStats("pair_flat_p99", c, os, _pair_flat, 0.99);
+      _WritePairStats("pair_flat_p999", c, os, _pair_flat, 0.999);
     }
   }
 
@@ -1365,9 +1601,14 @@ void TrafficManager::_DisplayOverallClassStats(long long int c, ostream &os) con
 {
 
   
-  printf("\nTotal number of flits generated = %lld, changed lanes = %lld\n", Generated_flits, Changed_flits);
-
-  cout<<"FlitTimeBreakup,IQ,RC,VC,SA,ST,"<<asyncConfig->queueTicks/Generated_flits <<","<<asyncConfig->routeTicks/Generated_flits <<","<<asyncConfig->vcaTicks/Generated_flits <<","<<asyncConfig->swaTicks/Generated_flits <<","<<asyncConfig->crossbarTicks/Generated_flits <<endl;
+  cout << "\nTotal number of flits generated = " << Generated_flits << ", changed lanes = " << Changed_flits << endl;
+
+  long long int const queueTicks = accumulate(asyncConfig->queueTicks.begin(), asyncConfig->queueTicks.end(), 0LL);
+  long long int const routeTicks = accumulate(asyncConfig->routeTicks.begin(), asyncConfig->routeTicks.end(), 0LL);
+  long long int const vcaTicks = accumulate(asyncConfig->vcaTicks.begin(), asyncConfig->vcaTicks.end(), 0LL);
+  long long int const swaTicks = accumulate(asyncConfig->swaTicks.begin(), asyncConfig->swaTicks.end(), 0LL);
+  long long int const crossbarTicks = accumulate(asyncConfig->crossbarTicks.begin(), asyncConfig->crossbarTicks.end(), 0LL);
+  cout<<"FlitTimeBreakup,IQ,RC,VC,SA,ST,"<<queueTicks/Generated_flits <<","<<routeTicks/Generated_flits <<","<<vcaTicks/Generated_flits <<","<<swaTicks/Generated_flits <<","<<crossbarTicks/Generated_flits <<endl;
   //  printf("\nHistogram of the packet sizes is as follows\n");
   //  for(long long int histo = 0; histo <20; histo++)
   //  	printf("\nNumber of packets with packet size %lld = %lld", histo, Packet_Size_Histogram[histo]);
@@ -1378,6 +1619,12 @@ void TrafficManager::_DisplayOverallClassStats(long long int c, ostream &os) con
      << " (" << _total_sims << " samples)" << endl
      << "Overall maximum packet latency = " << _overall_max_plat[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
+  if (_print_percentiles)
+  {
+    os << "Overall 50th/99th/99.9th percentile packet latency = " << _overall_plat_pct->Percentile(c, 0.5)
+       << " / " << _overall_plat_pct->Percentile(c, 0.99) << " / " << _overall_plat_pct->Percentile(c, 0.999)
+       << " (" << _total_sims << " samples)" << endl;
+  }
 
   os << "Overall minimum network latency = " << _overall_min_nlat[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
@@ -1385,6 +1632,12 @@ void TrafficManager::_DisplayOverallClassStats(long long int c, ostream &os) con
      << " (" << _total_sims << " samples)" << endl;
   os << "Overall maximum network latency = " << _overall_max_nlat[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
+  if (_print_percentiles)
+  {
+    os << "Overall 50th/99th/99.9th percentile network latency = " << _overall_nlat_pct->Percentile(c, 0.5)
+       << " / " << _overall_nlat_pct->Percentile(c, 0.99) << " / " << _overall_nlat_pct->Percentile(c, 0.999)
+       << " (" << _total_sims << " samples)" << endl;
+  }
 
   os << "Overall minimum flit latency = " << _overall_min_flat[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
@@ -1392,6 +1645,12 @@ void TrafficManager::_DisplayOverallClassStats(long long int c, ostream &os) con
      << " (" << _total_sims << " samples)" << endl;
   os << "Overall maximum flit latency = " << _overall_max_flat[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
+  if (_print_percentiles)
+  {
+    os << "Overall 50th/99th/99.9th percentile flit latency = " << _overall_flat_pct->Percentile(c, 0.5)
+       << " / " << _overall_flat_pct->Percentile(c, 0.99) << " / " << _overall_flat_pct->Percentile(c, 0.999)
+       << " (" << _total_sims << " samples)" << endl;
+  }
 
   os << "Overall minimum fragmentation = " << _overall_min_frag[c] / (double)_total_sims
      << " (" << _total_sims << " samples)" << endl;
@@ -1479,6 +1738,18 @@ string TrafficManager::_OverallStatsHeaderCSV() const
      << ',' << "avg_sent_packet_size"
      << ',' << "avg_accepted_packet_size"
      << ',' << "hops";
+  if (_print_percentiles)
+  {
+    os << ',' << "p50_plat"
+       << ',' << "p99_plat"
+       << ',' << "p999_plat"
+       << ',' << "p50_nlat"
+       << ',' << "p99_nlat"
+       << ',' << "p999_nlat"
+       << ',' << "p50_flat"
+       << ',' << "p99_flat"
+       << ',' << "p999_flat";
+  }
 #ifdef TRACK_STALLS
   os << ',' << "buffer_busy"
      << ',' << "buffer_conflict"
@@ -1519,6 +1790,18 @@ string TrafficManager::_OverallClassStatsCSV(long long int c) const
      << ',' << _overall_avg_sent[c] / _overall_avg_sent_packets[c]
      << ',' << _overall_avg_accepted[c] / _overall_avg_accepted_packets[c]
      << ',' << _overall_hop_stats[c] / (double)_total_sims;
+  if (_print_percentiles)
+  {
+    os << ',' << _overall_plat_pct->Percentile(c, 0.5)
+       << ',' << _overall_plat_pct->Percentile(c, 0.99)
+       << ',' << _overall_plat_pct->Percentile(c, 0.999)
+       << ',' << _overall_nlat_pct->Percentile(c, 0.5)
+       << ',' << _overall_nlat_pct->Percentile(c, 0.99)
+       << ',' << _overall_nlat_pct->Percentile(c, 0.999)
+       << ',' << _overall_flat_pct->Percentile(c, 0.5)
+       << ',' << _overall_flat_pct->Percentile(c, 0.99)
+       << ',' << _overall_flat_pct->Percentile(c, 0.999);
+  }
   return os.str();
 }
 
@@ -11,10 +11,16 @@
 #include "config_utils.hpp"
 #include "network.hpp"
 #include "flit.hpp"
+#include "flit_registry.hpp"
 #include "buffer_state.hpp"
 #include "stats.hpp"
+#include "hdr_stats.hpp"
 #include "routefunc.hpp"
 #include "outputset.hpp"
+#include "random_utils.hpp"
+#include "activity_trace.hpp"
+
+class RoutingTable;
 
 class TrafficManager : public Module
 {
@@ -70,16 +76,33 @@ protected:
   // ============ Routing ============
 
   tRoutingFunction _rf;
+  RoutingTable *_routing_table;
   bool _lookahead_routing;
   bool _noq;
 
+  // ============ Random streams ============
+
+  // with random_streams set, every source, router and injection process
+  // draws from its own counter-based stream instead of the shared generator
+  bool _random_streams;
+  long long int _seed;
+  vector<RandomStream> _source_random;
+
+  inline RandomStream *_SourceStream(long long int n)
+  {
+    return _random_streams ? &_source_random[n] : NULL;
+  }
+
   // ============ Injection queues ============
 
   vector<vector<list<Flit *>>> _partial_packets;
 
-  vector<map<long long int, Flit *>> _total_in_flight_flits;
-  vector<map<long long int, Flit *>> _measured_in_flight_flits;
-  vector<map<long long int, Flit *>> _retired_packets;
+  vector<FlitRegistry> _total_in_flight_flits;
+  vector<FlitRegistry> _measured_in_flight_flits;
+  vector<FlitRegistry> _retired_packets;
+
+  // flits read from each node's ejection channel in the current cycle
+  vector<vector<Flit *>> _arrived_flits;
 
   bool _empty_network;
 
@@ -117,9 +140,20 @@ protected:
   vector<double> _overall_avg_frag;
   vector<double> _overall_max_frag;
 
-  vector<vector<Stats *>> _pair_plat;
-  vector<vector<Stats *>> _pair_nlat;
-  vector<vector<Stats *>> _pair_flat;
+  // latency percentiles, one series per class
+  HdrStats *_plat_pct;
+  HdrStats *_nlat_pct;
+  HdrStats *_flat_pct;
+  HdrStats *_overall_plat_pct;
+  HdrStats *_overall_nlat_pct;
+  HdrStats *_overall_flat_pct;
+
+  // one series per (class, source, destination), see _PairSeries
+  HdrStats *_pair_plat;
+  HdrStats *_pair_nlat;
+  HdrStats *_pair_flat;
+
+  ostream *_hist_dump;
 
   vector<Stats *> _hop_stats;
   vector<double> _overall_hop_stats;
@@ -184,6 +218,7 @@ protected:
 
   vector<long long int> _measure_stats;
   bool _pair_stats;
+  bool _print_percentiles;
 
   long long int _cur_id;
   long long int _cur_pid;
@@ -194,12 +229,21 @@ protected:
 
   bool _print_csv_results;
 
+  // ============ Checkpointing ============
+
+  string _checkpoint_out;
+  string _checkpoint_in;
+
   //flits to watch
   ostream *_stats_out;
 
+  // per-interval router activity, NULL unless activity_trace is set
+  ActivityTrace *_activity_trace;
+
   // Orion Power Support
   ostream *_orion_out;
   string _orion_file;
+  bool _orion_power;
 
   //Sneha
   long long int Generated_flits;
@@ -245,8 +289,14 @@ protected:
 
   virtual bool _SingleSim() = 0;
 
+  // saves or restores the state of the simulation in progress, between two
+  // cycles of its first run
+  virtual void _Serialize(Checkpoint &cp);
+
   void _DisplayRemaining(ostream &os = cout) const;
 
+  void _DrainNetwork();
+
   void _LoadWatchList(const string &filename);
 
   virtual void _UpdateOverallStats();
@@ -254,6 +304,14 @@ protected:
   virtual string _OverallStatsHeaderCSV() const;
   virtual string _OverallClassStatsCSV(long long int c) const;
 
+  inline long long int _PairSeries(long long int c, long long int src, long long int dest) const
+  {
+    return (c * _nodes + src) * _nodes + dest;
+  }
+  void _WritePairStats(string const &name, long long int c, ostream &os,
+                       HdrStats const *stats, double q) const;
+  void _DumpHistograms();
+
   virtual void _DisplayClassStats(long long int c, ostream &os) const;
   virtual void _WriteClassStats(long long int c, ostream &os) const;
   virtual void _DisplayOverallClassStats(long long int c, ostream &os) const;
@@ -269,7 +327,11 @@ public:
   static TrafficManager *New(Configuration const &config,
                              vector<Network *> const &net);
 
-  bool Run();
+  virtual bool Run();
+
+  // writes out the last, partial interval of the activity trace; the trace
+  // reads the routers, so this has to happen before the networks go away
+  void FlushActivityTrace();
 
   void UpdateStats();
   void DisplayStats(ostream &os = cout) const;
@@ -0,0 +1,179 @@
+// $Id$
+
+/*activity2power.cpp
+ *
+ *Turns an activity trace (see activity_trace.hpp) into the power of every
+ *router per interval, printed as CSV with one row per interval and router.
+ *Event rates are scaled by the router's Power_Module coefficients as in the
+ *end-of-run report; leakage and clock power are only counted for the ticks
+ *a router was not power gated.
+ *
+ *  activity2power <activity trace> [router]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// field order of ActivityTrace::eField
+enum
+{
+  buffer_writes,
+  buffer_reads,
+  traversals,
+  vc_arbitrations,
+  sw_arbitrations,
+  idle_ticks,
+  gated_ticks
+};
+
+static bool GetU32(istream &is, unsigned int &v)
+{
+  unsigned char p[4];
+  if (!is.read((char *)p, 4))
+  {
+    return false;
+  }
+  v = 0;
+  for (int i = 3; i >= 0; --i)
+  {
+    v = (v << 8) | p[i];
+  }
+  return true;
+}
+
+static bool GetU64(istream &is, unsigned long long int &v)
+{
+  unsigned char p[8];
+  if (!is.read((char *)p, 8))
+  {
+    return false;
+  }
+  v = 0;
+  for (int i = 7; i >= 0; --i)
+  {
+    v = (v << 8) | p[i];
+  }
+  return true;
+}
+
+static bool GetF64(istream &is, double &v)
+{
+  unsigned long long int u;
+  if (!GetU64(is, u))
+  {
+    return false;
+  }
+  memcpy(&v, &u, sizeof(v));
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  if ((argc < 2) || (argc > 3))
+  {
+    cerr << "Usage: " << argv[0] << " <activity trace> [router]" << endl;
+    return -1;
+  }
+
+  ifstream in(argv[1], ios::binary);
+  if (!in.is_open())
+  {
+    cerr << "Unable to open activity trace: " << argv[1] << endl;
+    return -1;
+  }
+
+  char magic[8];
+  unsigned int version, routers, fields;
+  unsigned long long int interval;
+  if (!in.read(magic, 8) || memcmp(magic, "BKSMACT1", 8) ||
+      !GetU32(in, version) || !GetU32(in, routers) || !GetU32(in, fields) ||
+      !GetU64(in, interval))
+  {
+    cerr << argv[1] << " is not an activity trace" << endl;
+    return -1;
+  }
+  if ((version != 1) || (fields <= gated_ticks))
+  {
+    cerr << "Unsupported activity trace version " << version << endl;
+    return -1;
+  }
+
+  long long int const only = (argc > 2) ? atoll(argv[2]) : -1;
+  if (only >= (long long int)routers)
+  {
+    cerr << "Trace has only " << routers << " routers" << endl;
+    return -1;
+  }
+
+  // write, read, traversal, leakage, clock per router
+  vector<double> coef(5 * routers);
+  for (size_t i = 0; i < coef.size(); ++i)
+  {
+    if (!GetF64(in, coef[i]))
+    {
+      cerr << "Truncated activity trace header" << endl;
+      return -1;
+    }
+  }
+
+  cout << "time,router,ticks,buffer_power,switch_power,leakage_power,clock_power,total_power,gated_fraction" << endl;
+
+  vector<unsigned int> counts((size_t)fields * routers);
+  unsigned long long int time;
+  unsigned int ticks;
+  long long int records = 0;
+  while (GetU64(in, time))
+  {
+    if (!GetU32(in, ticks))
+    {
+      cerr << "Truncated record " << records << endl;
+      return -1;
+    }
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+      if (!GetU32(in, counts[i]))
+      {
+        cerr << "Truncated record " << records << endl;
+        return -1;
+      }
+    }
+    ++records;
+    if (ticks == 0)
+    {
+      continue;
+    }
+
+    for (unsigned int r = 0; r < routers; ++r)
+    {
+      if ((only >= 0) && (r != only))
+      {
+        continue;
+      }
+      double const *c = &coef[5 * r];
+      double const t = (double)ticks;
+      double const writes = counts[buffer_writes * routers + r];
+      double const reads = counts[buffer_reads * routers + r];
+      double const trav = counts[traversals * routers + r];
+      double gated = counts[gated_ticks * routers + r] / t;
+      if (gated > 1.0)
+      {
+        // counted in router ticks, which need not line up with the interval
+        gated = 1.0;
+      }
+
+      double const buffer = (writes * c[0] + reads * c[1]) / t;
+      double const xbar = trav * c[2] / t;
+      double const leakage = c[3] * (1.0 - gated);
+      double const clock = c[4] * (1.0 - gated);
+      cout << time << ',' << r << ',' << ticks
+           << ',' << buffer << ',' << xbar << ',' << leakage << ',' << clock
+           << ',' << (buffer + xbar + leakage + clock) << ',' << gated << endl;
+    }
+  }
+  return 0;
+}
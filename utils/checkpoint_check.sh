@@ -0,0 +1,33 @@
+#!/bin/sh
+# Runs a configuration straight through while saving a checkpoint after
+# warm-up, restarts it from that checkpoint, and diffs the two reports from
+# the checkpoint on. Wall-clock lines are left out.
+#
+#  utils/checkpoint_check.sh <configuration file> [overrides...]
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <configuration file> [overrides...]" >&2
+  exit 1
+fi
+
+booksim=${BOOKSIM:-./booksim}
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+report() {
+  sed -n "/$1 checkpoint/,\$p" | tail -n +2 |
+    grep -v "Total run time\|Time taken\|time elapsed"
+}
+
+"$booksim" "$@" checkpoint_out="$dir/warm.ckpt" 2>&1 | report Saved > "$dir/straight"
+"$booksim" "$@" checkpoint_in="$dir/warm.ckpt" 2>&1 | report Restored > "$dir/restored"
+
+if [ ! -s "$dir/straight" ]; then
+  echo "No checkpoint was saved" >&2
+  exit 1
+fi
+if ! diff "$dir/straight" "$dir/restored"; then
+  echo "Restored run differs from the straight run" >&2
+  exit 1
+fi
+echo "Restored run matches the straight run ($(wc -l < "$dir/straight") lines)"
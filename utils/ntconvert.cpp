@@ -0,0 +1,38 @@
+// $Id$
+
+/*ntconvert.cpp
+ *
+ *Rewrites a netrace trace (bzip2 compressed or plain) as a block compressed
+ *trace with a chunk index, so that the netrace workload can seek to a
+ *region without decompressing everything before it.
+ *
+ *  ntconvert <netrace trace> <indexed trace> [block size in bytes]
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+extern "C"
+{
+#include "netrace/netrace.h"
+#include "netrace/nt_stream.h"
+}
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+  if ((argc < 3) || (argc > 4))
+  {
+    cerr << "Usage: " << argv[0] << " <netrace trace> <indexed trace> [block size in bytes]" << endl;
+    return -1;
+  }
+  long long int const block_size = (argc > 3) ? atoll(argv[3]) : NT_BLOCK_SIZE;
+  if ((block_size <= 0) || (block_size > (1ll << 30)))
+  {
+    cerr << "Block size must be between 1 byte and 1 GB" << endl;
+    return -1;
+  }
+  nt_stream_convert(argv[1], argv[2], (unsigned int)block_size);
+  return 0;
+}
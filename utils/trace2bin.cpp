@@ -0,0 +1,58 @@
+// $Id$
+
+/*trace2bin.cpp
+ *
+ *Converts a text trace of "delay source dest type" tuples, as read by the
+ *trace workload, into the block-compressed binary trace format.
+ *
+ *  trace2bin <text trace> <binary trace> [records per block]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+#include "binary_trace.hpp"
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+  if ((argc < 3) || (argc > 4))
+  {
+    cerr << "Usage: " << argv[0] << " <text trace> <binary trace> [records per block]" << endl;
+    return -1;
+  }
+
+  ifstream in(argv[1]);
+  if (!in.is_open())
+  {
+    cerr << "Unable to open trace file: " << argv[1] << endl;
+    return -1;
+  }
+
+  long long int const block_records = (argc > 3) ? atoll(argv[3]) : 16384;
+  if (block_records <= 0)
+  {
+    cerr << "Records per block must be positive" << endl;
+    return -1;
+  }
+
+  BinaryTraceWriter out(argv[2], (unsigned int)block_records);
+  unsigned long long int count = 0;
+  TraceRecord r;
+  while (in >> r.delay >> r.source >> r.dest >> r.type)
+  {
+    out.Write(r);
+    ++count;
+  }
+  if (!in.eof())
+  {
+    cerr << "Malformed record " << count << " in " << argv[1] << endl;
+    return -1;
+  }
+  out.Close();
+
+  cout << "Converted " << count << " records" << endl;
+  return 0;
+}
@@ -14,6 +14,7 @@
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "vc.hpp"
+#include "checkpoint.hpp"
 
 const char *const VC::VCSTATE[] = {"idle",
                                    "routing",
@@ -189,11 +190,38 @@ void VC::UpdatePriority()
 
 void VC::Route(tRoutingFunction rf, const Router *router, const Flit *f, long long int in_channel)
 {
-  rf(router, f, in_channel, _route_set, false);
+  router->Route(rf, f, in_channel, _route_set);
   _out_port = -1;
   _out_vc = -1;
 }
 
+void VC::Serialize(Checkpoint &cp)
+{
+  cp.Io(_buffer);
+  cp.Io(_state);
+  if (_lookahead_routing)
+  {
+    // the route set is the lookahead route carried by the head flit, which
+    // waits at the front of the buffer while it is needed
+    bool head_route = !_buffer.empty() && (_route_set == &_buffer.front()->LaRouteSet());
+    cp.Io(head_route);
+    if (cp.Restoring())
+    {
+      _route_set = head_route ? &_buffer.front()->LaRouteSet() : NULL;
+    }
+  }
+  else
+  {
+    cp.Io(*_route_set);
+  }
+  cp.Io(_out_port);
+  cp.Io(_out_vc);
+  cp.Io(_pri);
+  cp.Io(_expected_pid);
+  cp.Io(_last_id);
+  cp.Io(_last_pid);
+}
+
 // ==== Debug functions ====
 
 void VC::SetWatch(bool watch)
@@ -10,6 +10,8 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class Checkpoint;
+
 class VC : public Module
 {
 public:
@@ -113,6 +115,8 @@ public:
     return (long long int)_buffer.size();
   }
 
+  void Serialize(Checkpoint &cp);
+
   // ==== Debug functions ====
 
   void SetWatch(bool watch = true);
@@ -328,6 +328,13 @@ TraceWorkload::TraceWorkload(long long int nodes, string const &filename,
       _packet_sizes(packet_sizes), _limit(limit), _scale(scale), _skip(skip)
 {
   _ready_packets.resize(nodes);
+  _trace = NULL;
+  _binary = NULL;
+  if (BinaryTraceReader::IsBinaryTrace(filename))
+  {
+    _binary = new BinaryTraceReader(filename);
+    return;
+  }
   _trace = new ifstream(filename.c_str());
   if (!_trace->is_open())
   {
@@ -346,26 +353,36 @@ TraceWorkload::~TraceWorkload()
     }
     delete _trace;
   }
+  delete _binary;
+}
+
+bool TraceWorkload::_read(TraceRecord &r)
+{
+  if (_binary)
+  {
+    return _binary->Next(r);
+  }
+  return bool(*_trace >> r.delay >> r.source >> r.dest >> r.type);
 }
 
 void TraceWorkload::_refill()
 {
   unsigned long long int time = _time;
-  while (((_limit < 0) || (_count < (unsigned long long int)_limit)) && !_trace->eof())
+  TraceRecord r;
+  while (((_limit < 0) || (_count < (unsigned long long int)_limit)) && _read(r))
   {
     ++_count;
-    long long int delay, source, dest, type;
-    *_trace >> delay >> source >> dest >> type;
-    //assert(delay >= 0);
-    //assert((source >= 0) && (source < _nodes));
-    //assert((dest >= 0) && (dest < _nodes));
-    time += (unsigned long long int)delay;
-    if (type >= 0)
+    //assert(r.delay >= 0);
+    //assert((r.source >= 0) && (r.source < _nodes));
+    //assert((r.dest >= 0) && (r.dest < _nodes));
+    time += (unsigned long long int)r.delay;
+    if (r.type >= 0)
     {
+      long long int const source = r.source;
       _next_source = source;
       _next_packet.time = time;
-      _next_packet.dest = dest;
-      _next_packet.type = type;
+      _next_packet.dest = r.dest;
+      _next_packet.type = r.type;
       //assert(time >= _time);
       if (time == _time)
       {
@@ -389,16 +406,21 @@ void TraceWorkload::reset()
 {
   Workload::reset();
   _time = 0;
-  _trace->seekg(0);
-  unsigned long long int count = 0;
-  while ((count < _skip) && !_trace->eof())
+  if (_binary)
   {
-    ++count;
-    long long int delay, source, dest, type;
-    *_trace >> delay >> source >> dest >> type;
-    //assert(delay >= 0);
-    //assert((source >= 0) && (source < _nodes));
-    //assert((dest >= 0) && (dest < _nodes));
+    // the block index takes the reader straight to the first record
+    _binary->Seek(_skip);
+  }
+  else
+  {
+    _trace->clear();
+    _trace->seekg(0);
+    unsigned long long int count = 0;
+    TraceRecord r;
+    while ((count < _skip) && _read(r))
+    {
+      ++count;
+    }
   }
   _count = 0;
   _next_source = -1;
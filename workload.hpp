@@ -12,6 +12,7 @@
 
 #include "injection.hpp"
 #include "traffic.hpp"
+#include "binary_trace.hpp"
 
 extern "C"
 {
@@ -107,6 +108,7 @@ protected:
   vector<queue<PacketInfo>> _ready_packets;
 
   ifstream *_trace;
+  BinaryTraceReader *_binary;
 
   unsigned long long int _count;
   long long int _limit;
@@ -114,6 +116,7 @@ protected:
   unsigned long long int _scale;
   unsigned long long int _skip;
 
+  bool _read(TraceRecord &r);
   void _refill();
 
 public: